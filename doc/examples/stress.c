@@ -0,0 +1,495 @@
+/**
+ * @file stress.c
+ * @brief Threaded stress and benchmark of the eViewItf devices
+ * @author LACROIX Impulse
+ *
+ * Usage: stress [nb_threads] [duration_s]
+ *
+ * Runs functional checks of the API, then opens, reads and closes the cameras from several threads and contexts while
+ * the attributes are refreshed, then measures the throughput of the camera reads, control requests, streamer writes
+ * and recordings for an increasing number of threads. Every frame read is checked word by word, against the pattern of
+ * the stub cameras or the frames written to the recording. Returns 0 if no call failed.
+ *
+ * Built and run on the fake MFIS device of stub-mfis.c by the check target of the makefile, the control requests then
+ * measure the library and system call overhead. They are compared to the same requests sent on an MFIS channel opened
+ * and closed around each of them, as done by the previous versions.
+ *
+ */
+
+#include <dirent.h>
+#include <eviewitf.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cam-ioctl.h"
+#include "mfis-communication.h"
+#include "mfis-ioctl.h"
+
+#define STRESS_MAX_THREADS 64
+#define STRESS_RECORDING_PATH "/tmp/evitf_stress.evr"
+#define STRESS_RECORDING_FRAMES 32
+#define STRESS_MFIS_LATENCY_US 100
+#define STRESS_RECORDING_TAG 0x100
+
+typedef struct {
+    int id;                                           /* Thread number */
+    uint32_t buffer_size;                             /* Size of the frames */
+    void (*run)(int id, uint32_t size, uint8_t *buf); /* Operation of the thread, done once per iteration */
+    uint64_t nb_ops;                                  /* Number of iterations */
+} stress_thread_t;
+
+static int stress_stop;
+static unsigned long stress_errors;
+static eviewitf_recording_t *stress_recording;
+static int stress_mfis_fd = -1;
+
+/* Controls of the fake MFIS device, only there when built with stub-mfis.c */
+extern int stub_mfis_unbound_requests __attribute__((weak));
+extern unsigned int stub_mfis_latency_us __attribute__((weak));
+
+static void stress_check(eviewitf_ret_t ret, const char *call) {
+    if (ret != EVIEWITF_OK) {
+        if (__atomic_fetch_add(&stress_errors, 1, __ATOMIC_RELAXED) < 10) {
+            fprintf(stderr, "%s failed: %d\n", call, ret);
+        }
+    }
+}
+
+static double stress_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double stress_cpu(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int stress_count_fds(void) {
+    DIR *dir = opendir("/proc/self/fd");
+    int nb_fds = 0;
+
+    if (dir != NULL) {
+        while (readdir(dir) != NULL) {
+            nb_fds++;
+        }
+        closedir(dir);
+    }
+
+    return nb_fds;
+}
+
+/* Word of a frame, holding its tag in its upper half and its index in its lower half, as the frames of stub-mfis.c */
+static uint64_t stress_frame_word(uint32_t tag, uint32_t index) { return ((uint64_t)tag << 32) | index; }
+
+static void stress_fill_frame(uint8_t *frame, uint32_t size, uint32_t tag) {
+    uint64_t *words = (uint64_t *)frame;
+
+    for (uint32_t i = 0; i < size / sizeof(uint64_t); i++) {
+        words[i] = stress_frame_word(tag, i);
+    }
+}
+
+/* Check every word of a frame */
+static void stress_check_frame(const uint8_t *frame, uint32_t size, uint32_t tag, const char *call) {
+    const uint64_t *words = (const uint64_t *)frame;
+
+    for (uint32_t i = 0; i < size / sizeof(uint64_t); i++) {
+        if (words[i] != stress_frame_word(tag, i)) {
+            stress_check(EVIEWITF_FAIL, call);
+            return;
+        }
+    }
+}
+
+/* Check a frame of a stub camera, tagged with the camera id plus one */
+static void stress_check_camera_frame(const uint8_t *frame, uint32_t size, int cam_id, const char *call) {
+    if (&stub_mfis_unbound_requests != NULL) {
+        stress_check_frame(frame, size, cam_id + 1, call);
+    }
+}
+
+/* Value read from the fake MFIS device for a camera, each byte being the camera id plus one */
+static uint32_t stress_stub_value(int cam_id) { return (cam_id + 1) * 0x01010101U; }
+
+/* Functional checks */
+
+/* The MFIS channel is reopened when the driver is found unbound, without leaking the previous one */
+static void check_mfis_reopen(void) {
+    uint32_t exposure_us = 0, gain_thou = 0;
+    int nb_fds = stress_count_fds();
+
+    if (&stub_mfis_unbound_requests == NULL) {
+        return;
+    }
+    __atomic_store_n(&stub_mfis_unbound_requests, 1, __ATOMIC_RELAXED);
+    stress_check(eviewitf_camera_get_exposure(1, &exposure_us, &gain_thou), "eviewitf_camera_get_exposure");
+    if ((exposure_us != stress_stub_value(1)) || (gain_thou != stress_stub_value(1))) {
+        stress_check(EVIEWITF_FAIL, "eviewitf_camera_get_exposure value after reopen");
+    }
+    if (stress_count_fds() != nb_fds) {
+        stress_check(EVIEWITF_FAIL, "MFIS channel reopen file descriptors");
+    }
+}
+
+/* A read command added through the generic entry point has no output, its value stays in its parameter */
+static void check_batch_add_read(void) {
+    eviewitf_batch_t batch;
+    eviewitf_ret_t result = EVIEWITF_FAIL;
+
+    eviewitf_batch_reset(&batch);
+    stress_check(eviewitf_batch_add(&batch, MFIS_DEV_CAM, 0, IOCGCAMRATE, NULL), "eviewitf_batch_add");
+    stress_check(eviewitf_batch_submit(&batch), "eviewitf_batch_submit");
+    stress_check(eviewitf_batch_get_result(&batch, 0, &result), "eviewitf_batch_get_result");
+    stress_check(result, "IOCGCAMRATE batch command");
+}
+
+static void check_async_callback(const eviewitf_async_completion_t *completion) {
+    stress_check(completion->result, "asynchronous request");
+    __atomic_store_n((int *)completion->user_ctx, 1, __ATOMIC_RELAXED);
+}
+
+/* De-initialization runs the pending asynchronous requests, then later requests fail without reopening the channel */
+static void check_deinit(void) {
+    eviewitf_batch_t batch;
+    uint16_t fps;
+    uint32_t exposure_us, gain_thou;
+    int completed = 0;
+    int nb_fds;
+
+    eviewitf_batch_reset(&batch);
+    stress_check(eviewitf_batch_camera_get_frame_rate(&batch, 0, &fps), "eviewitf_batch_camera_get_frame_rate");
+    stress_check(eviewitf_async_submit(&batch, check_async_callback, &completed, NULL), "eviewitf_async_submit");
+    stress_check(eviewitf_deinit(), "eviewitf_deinit");
+    if (!__atomic_load_n(&completed, __ATOMIC_RELAXED)) {
+        stress_check(EVIEWITF_FAIL, "asynchronous request completion before eviewitf_deinit returns");
+    }
+
+    nb_fds = stress_count_fds();
+    if (eviewitf_camera_get_exposure(0, &exposure_us, &gain_thou) == EVIEWITF_OK) {
+        stress_check(EVIEWITF_FAIL, "eviewitf_camera_get_exposure after eviewitf_deinit");
+    }
+    if (stress_count_fds() != nb_fds) {
+        stress_check(EVIEWITF_FAIL, "MFIS channel reopened after eviewitf_deinit");
+    }
+}
+
+/* Operations, done in a loop by each thread */
+
+static void run_ctx_cycle(int id, uint32_t size, uint8_t *buf) {
+    eviewitf_ctx_t *ctx;
+    int cam_id = id % EVIEWITF_MAX_CAMERA;
+
+    stress_check(eviewitf_ctx_create(&ctx), "eviewitf_ctx_create");
+    stress_check(eviewitf_ctx_camera_open(ctx, cam_id), "eviewitf_ctx_camera_open");
+    stress_check(eviewitf_ctx_camera_get_frame(ctx, cam_id, buf, size), "eviewitf_ctx_camera_get_frame");
+    stress_check_camera_frame(buf, size, cam_id, "eviewitf_ctx_camera_get_frame content");
+    stress_check(eviewitf_ctx_camera_close(ctx, cam_id), "eviewitf_ctx_camera_close");
+    stress_check(eviewitf_ctx_destroy(ctx), "eviewitf_ctx_destroy");
+}
+
+static void run_default_cycle(int id, uint32_t size, uint8_t *buf) {
+    uint8_t *frame = NULL;
+    uint32_t frame_size;
+
+    (void)id;
+    (void)size;
+    (void)buf;
+    stress_check(eviewitf_camera_open(0), "eviewitf_camera_open");
+    stress_check(eviewitf_camera_map_frame(0, &frame, &frame_size), "eviewitf_camera_map_frame");
+    if (frame != NULL) {
+        stress_check_camera_frame(frame, frame_size, 0, "eviewitf_camera_map_frame content");
+        stress_check(eviewitf_camera_release_frame(0, frame), "eviewitf_camera_release_frame");
+    }
+    stress_check(eviewitf_camera_close(0), "eviewitf_camera_close");
+}
+
+static void run_refresh(int id, uint32_t size, uint8_t *buf) {
+    (void)id;
+    (void)size;
+    (void)buf;
+    stress_check(eviewitf_refresh_attributes(NULL), "eviewitf_refresh_attributes");
+    usleep(1000);
+}
+
+static void run_get_frame(int id, uint32_t size, uint8_t *buf) {
+    int cam_id = id % EVIEWITF_MAX_CAMERA;
+
+    stress_check(eviewitf_camera_get_frame(cam_id, buf, size), "eviewitf_camera_get_frame");
+    stress_check_camera_frame(buf, size, cam_id, "eviewitf_camera_get_frame content");
+}
+
+static void run_map_frame(int id, uint32_t size, uint8_t *buf) {
+    uint8_t *frame;
+    uint32_t frame_size;
+    int cam_id = id % EVIEWITF_MAX_CAMERA;
+
+    eviewitf_ret_t ret;
+
+    (void)size;
+    (void)buf;
+    ret = eviewitf_camera_map_frame(cam_id, &frame, &frame_size);
+    stress_check(ret, "eviewitf_camera_map_frame");
+    if (ret == EVIEWITF_OK) {
+        stress_check_camera_frame(frame, frame_size, cam_id, "eviewitf_camera_map_frame content");
+        stress_check(eviewitf_camera_release_frame(cam_id, frame), "eviewitf_camera_release_frame");
+    }
+}
+
+static void run_control(int id, uint32_t size, uint8_t *buf) {
+    uint32_t exposure_us, gain_thou;
+    int cam_id = id % EVIEWITF_MAX_CAMERA;
+
+    (void)size;
+    (void)buf;
+    stress_check(eviewitf_camera_get_exposure(cam_id, &exposure_us, &gain_thou), "eviewitf_camera_get_exposure");
+    /* Answers of concurrent requests are not mixed up */
+    if ((&stub_mfis_unbound_requests != NULL) &&
+        ((exposure_us != stress_stub_value(cam_id)) || (gain_thou != stress_stub_value(cam_id)))) {
+        stress_check(EVIEWITF_FAIL, "eviewitf_camera_get_exposure value");
+    }
+}
+
+static void run_control_same(int id, uint32_t size, uint8_t *buf) {
+    uint32_t exposure_us, gain_thou;
+
+    (void)id;
+    (void)size;
+    (void)buf;
+    stress_check(eviewitf_camera_get_exposure(0, &exposure_us, &gain_thou), "eviewitf_camera_get_exposure");
+}
+
+/* Exposure request sent on an MFIS channel, without the library */
+static void stress_mfis_request(int fd, int cam_id) {
+    uint32_t msg[EVIEWITF_MFIS_MSG_SIZE] = {0};
+    mfis_ioctl_t *hdr = (mfis_ioctl_t *)msg;
+
+    hdr->funcid = EVIEWITF_MFIS_FCT_IOCTL;
+    hdr->devtype = MFIS_DEV_CAM;
+    hdr->devid = cam_id;
+    hdr->cmd = IOCGCAMEXP;
+    if ((ioctl(fd, EVIEWITF_MFIS_FCT, msg) < 0) || (hdr->result != EVIEWITF_MFIS_FCT_RETURN_OK)) {
+        stress_check(EVIEWITF_FAIL, "MFIS ioctl");
+    }
+}
+
+static void run_mfis_persistent(int id, uint32_t size, uint8_t *buf) {
+    (void)size;
+    (void)buf;
+    stress_mfis_request(stress_mfis_fd, id % EVIEWITF_MAX_CAMERA);
+}
+
+static void run_mfis_reopen(int id, uint32_t size, uint8_t *buf) {
+    int fd = open(MFIS_IOCTL_DEVICE_NAME, O_RDWR | O_CLOEXEC);
+
+    (void)size;
+    (void)buf;
+    if (fd < 0) {
+        stress_check(EVIEWITF_FAIL, "open " MFIS_IOCTL_DEVICE_NAME);
+        return;
+    }
+    stress_mfis_request(fd, id % EVIEWITF_MAX_CAMERA);
+    close(fd);
+}
+
+static void run_streamer_write(int id, uint32_t size, uint8_t *buf) {
+    buf[0] = id;
+    stress_check(eviewitf_streamer_write_frame(id % EVIEWITF_MAX_STREAMER, buf, size), "eviewitf_streamer_write_frame");
+}
+
+static void run_recording_read(int id, uint32_t size, uint8_t *buf) {
+    static __thread unsigned int seed;
+    uint32_t index;
+
+    seed = seed * 1103515245 + 12345 + id;
+    index = (seed >> 16) % STRESS_RECORDING_FRAMES;
+    stress_check(eviewitf_recording_read_frame(stress_recording, index, buf, size), "eviewitf_recording_read_frame");
+    stress_check_frame(buf, size, STRESS_RECORDING_TAG + index, "eviewitf_recording_read_frame content");
+}
+
+static void *stress_thread(void *arg) {
+    stress_thread_t *thread = arg;
+    uint8_t *buf = malloc(thread->buffer_size + 1);
+
+    if (buf == NULL) {
+        stress_check(EVIEWITF_FAIL, "malloc");
+        return NULL;
+    }
+    while (!__atomic_load_n(&stress_stop, __ATOMIC_RELAXED)) {
+        thread->run(thread->id, thread->buffer_size, buf);
+        thread->nb_ops++;
+    }
+    free(buf);
+
+    return NULL;
+}
+
+/* Run the operations of the threads for a duration, return the number of iterations per second of the first ones */
+static double stress_run(stress_thread_t *threads, int nb_threads, int nb_measured, double duration) {
+    pthread_t tids[STRESS_MAX_THREADS + 2];
+    uint64_t nb_ops = 0;
+    double start;
+
+    __atomic_store_n(&stress_stop, 0, __ATOMIC_RELAXED);
+    start = stress_now();
+    for (int i = 0; i < nb_threads; i++) {
+        threads[i].nb_ops = 0;
+        pthread_create(&tids[i], NULL, stress_thread, &threads[i]);
+    }
+    usleep(duration * 1e6);
+    __atomic_store_n(&stress_stop, 1, __ATOMIC_RELAXED);
+    for (int i = 0; i < nb_threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    for (int i = 0; i < nb_measured; i++) {
+        nb_ops += threads[i].nb_ops;
+    }
+
+    return nb_ops / (stress_now() - start);
+}
+
+static void stress_bench(const char *name, void (*run)(int, uint32_t, uint8_t *), uint32_t size, int max_threads,
+                         double duration) {
+    stress_thread_t threads[STRESS_MAX_THREADS];
+    double cpu, rate;
+
+    for (int nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+        for (int i = 0; i < nb_threads; i++) {
+            threads[i] = (stress_thread_t){.id = i, .buffer_size = size, .run = run};
+        }
+        cpu = stress_cpu();
+        rate = stress_run(threads, nb_threads, nb_threads, duration);
+        cpu = (stress_cpu() - cpu) / duration;
+        printf("%-24s %2d threads: %10.0f op/s %10.1f MB/s %6.0f%% CPU\n", name, nb_threads, rate, rate * size / 1e6,
+               cpu * 100);
+    }
+}
+
+int main(int argc, char **argv) {
+    stress_thread_t threads[STRESS_MAX_THREADS + 2];
+    eviewitf_device_attributes_t camera_attributes, streamer_attributes;
+    int nb_threads = (argc > 1) ? atoi(argv[1]) : 8;
+    double duration = (argc > 2) ? atof(argv[2]) : 1;
+    uint8_t *frame;
+    double start, elapsed, rate;
+
+    if ((nb_threads < 1) || (nb_threads > STRESS_MAX_THREADS) || (duration <= 0)) {
+        fprintf(stderr, "Usage: %s [nb_threads (1 to %d)] [duration_s]\n", argv[0], STRESS_MAX_THREADS);
+        return -1;
+    }
+
+    if (eviewitf_init() != EVIEWITF_OK) {
+        fprintf(stderr, "Failed to initialize eviewitf\n");
+        return -1;
+    }
+    if ((eviewitf_camera_get_attributes(0, &camera_attributes) != EVIEWITF_OK) ||
+        (eviewitf_streamer_get_attributes(0, &streamer_attributes) != EVIEWITF_OK)) {
+        fprintf(stderr, "Failed to get the attributes\n");
+        return -1;
+    }
+
+    check_batch_add_read();
+    check_mfis_reopen();
+
+    /* Open, read and close from contexts, the default context and while refreshing the attributes */
+    for (int i = 0; i < nb_threads; i++) {
+        threads[i] = (stress_thread_t){.id = i, .buffer_size = camera_attributes.buffer_size, .run = run_ctx_cycle};
+    }
+    threads[nb_threads] = (stress_thread_t){.id = 0, .buffer_size = 1, .run = run_default_cycle};
+    threads[nb_threads + 1] = (stress_thread_t){.id = 0, .buffer_size = 1, .run = run_refresh};
+    rate = stress_run(threads, nb_threads + 2, nb_threads, duration);
+    printf("%-24s %2d threads: %10.0f op/s, %lu errors\n", "open/get_frame/close", nb_threads, rate, stress_errors);
+
+    /* Camera reads */
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA; i++) {
+        stress_check(eviewitf_camera_open(i), "eviewitf_camera_open");
+    }
+    stress_bench("camera_get_frame", run_get_frame, camera_attributes.buffer_size, nb_threads, duration);
+    /* Each thread holds at most one frame, within the limit of the frames held per camera */
+    stress_bench("camera_map_frame", run_map_frame, camera_attributes.buffer_size,
+                 (nb_threads < EVIEWITF_MAX_CAMERA * EVIEWITF_MAX_CAMERA_FRAMES)
+                     ? nb_threads
+                     : EVIEWITF_MAX_CAMERA * EVIEWITF_MAX_CAMERA_FRAMES,
+                 duration);
+    stress_bench("camera_get_exposure", run_control, 0, nb_threads, duration);
+    /* The same request on the MFIS channel kept open, and opened and closed around each request */
+    stress_mfis_fd = open(MFIS_IOCTL_DEVICE_NAME, O_RDWR | O_CLOEXEC);
+    if (stress_mfis_fd >= 0) {
+        stress_bench("mfis_ioctl_persistent", run_mfis_persistent, 0, nb_threads, duration);
+        close(stress_mfis_fd);
+    } else {
+        stress_check(EVIEWITF_FAIL, "open " MFIS_IOCTL_DEVICE_NAME);
+    }
+    stress_bench("mfis_ioctl_open_close", run_mfis_reopen, 0, nb_threads, duration);
+    /* With the R7 round trip, requests of different cameras scale with the threads, the ones of a camera do not */
+    if (&stub_mfis_latency_us != NULL) {
+        __atomic_store_n(&stub_mfis_latency_us, STRESS_MFIS_LATENCY_US, __ATOMIC_RELAXED);
+        stress_bench("get_exposure_100us", run_control, 0, nb_threads, duration);
+        stress_bench("get_exposure_100us_cam0", run_control_same, 0, nb_threads, duration);
+        __atomic_store_n(&stub_mfis_latency_us, 0, __ATOMIC_RELAXED);
+    }
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA; i++) {
+        stress_check(eviewitf_camera_close(i), "eviewitf_camera_close");
+    }
+
+    /* Streamer writes */
+    for (int i = 0; i < EVIEWITF_MAX_STREAMER; i++) {
+        stress_check(eviewitf_streamer_open(i), "eviewitf_streamer_open");
+    }
+    stress_bench("streamer_write_frame", run_streamer_write, streamer_attributes.buffer_size, 1, duration);
+    for (int i = 0; i < EVIEWITF_MAX_STREAMER; i++) {
+        stress_check(eviewitf_streamer_close(i), "eviewitf_streamer_close");
+    }
+
+    /* Recording */
+    frame = malloc(camera_attributes.buffer_size);
+    if (frame == NULL) {
+        fprintf(stderr, "Failed to allocate the frame\n");
+        return -1;
+    }
+    stress_check(eviewitf_recording_create(&stress_recording, STRESS_RECORDING_PATH, &camera_attributes),
+                 "eviewitf_recording_create");
+    if (stress_recording != NULL) {
+        /* Each frame is tagged with its index, only the writes and the close are measured */
+        elapsed = 0;
+        for (int i = 0; i < STRESS_RECORDING_FRAMES; i++) {
+            stress_fill_frame(frame, camera_attributes.buffer_size, STRESS_RECORDING_TAG + i);
+            start = stress_now();
+            stress_check(eviewitf_recording_write_frame(stress_recording, frame, camera_attributes.buffer_size, NULL),
+                         "eviewitf_recording_write_frame");
+            elapsed += stress_now() - start;
+        }
+        start = stress_now();
+        stress_check(eviewitf_recording_close(stress_recording), "eviewitf_recording_close");
+        rate = STRESS_RECORDING_FRAMES / (elapsed + stress_now() - start);
+        printf("%-24s %2d threads: %10.0f op/s %10.1f MB/s\n", "recording_write_frame", 1, rate,
+               rate * camera_attributes.buffer_size / 1e6);
+        stress_recording = NULL;
+    }
+    free(frame);
+    stress_check(eviewitf_recording_open(&stress_recording, STRESS_RECORDING_PATH), "eviewitf_recording_open");
+    if (stress_recording != NULL) {
+        stress_bench("recording_read_frame", run_recording_read, camera_attributes.buffer_size, nb_threads, duration);
+        stress_check(eviewitf_recording_close(stress_recording), "eviewitf_recording_close");
+    }
+    unlink(STRESS_RECORDING_PATH);
+
+    check_deinit();
+
+    if (stress_errors) {
+        fprintf(stderr, "%lu errors\n", stress_errors);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file stub-mfis.c
+ * @brief Fake MFIS device, to run eViewItf without eView
+ * @author LACROIX Impulse
+ *
+ * The library is built with its MFIS communication, on devices that are regular files created under /tmp at the
+ * MFIS_IOCTL_DEVICE_NAME and DEVICE_CAMERA_NAME paths (see the check target of the makefile). The program is linked
+ * with -Wl,--wrap=ioctl: the MFIS requests are answered here, the other ioctls are issued as is.
+ *
+ * Each 64 bits word of the frame of camera i holds i + 1 in its upper half and the word index in its lower half.
+ *
+ * Every request succeeds. Requests reading values fill them with the device identifier plus one in each byte, so
+ * that the answers can be checked. Requests can be made to fail as if the driver had been unbound, or to take the time
+ * of a round trip to the R7.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "eviewitf-priv.h"
+#include "mfis-communication.h"
+#include "mfis-ioctl.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Buffer size of the stub cameras and streamers
+ */
+#define STUB_BUFFER_SIZE (1920 * 1080 * 2)
+
+/******************************************************************************************
+ * Variables
+ ******************************************************************************************/
+/**
+ * @brief Number of the next MFIS requests to fail with ENODEV, as if the driver had been unbound
+ */
+int stub_mfis_unbound_requests;
+
+/**
+ * @brief Time the function requests take to be answered, as the round trip to the R7 (in us)
+ */
+unsigned int stub_mfis_latency_us;
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+int __real_ioctl(int fd, unsigned long request, void *arg);
+
+/**
+ * @fn static int stub_create(const char *device_name, const uint8_t *frame)
+ * @brief Create the file of a stub device
+ *
+ * @param device_name: path of the device
+ * @param frame: frame of the device, NULL for a zeroed one
+ * @return 0 on success, -1 if the file cannot be created
+ */
+static int stub_create(const char *device_name, const uint8_t *frame) {
+    int fd = open(device_name, O_CREAT | O_RDWR, 0666);
+    int ret = 0;
+
+    if ((fd == -1) || (ftruncate(fd, STUB_BUFFER_SIZE) != 0) ||
+        ((frame != NULL) && (pwrite(fd, frame, STUB_BUFFER_SIZE, 0) != STUB_BUFFER_SIZE))) {
+        fprintf(stderr, "%s() cannot create %s\n", __FUNCTION__, device_name);
+        ret = -1;
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+
+    return ret;
+}
+
+/**
+ * @fn static void stub_create_devices(void)
+ * @brief Create the files of the MFIS device, cameras and streamers before the program starts
+ */
+__attribute__((constructor)) static void stub_create_devices(void) {
+    char device_name[DEVICE_CAMERA_MAX_LENGTH];
+    uint64_t *frame = malloc(STUB_BUFFER_SIZE);
+
+    stub_create(MFIS_IOCTL_DEVICE_NAME, NULL);
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA + EVIEWITF_MAX_STREAMER; i++) {
+        if ((frame != NULL) && (i < EVIEWITF_MAX_CAMERA)) {
+            for (uint32_t j = 0; j < STUB_BUFFER_SIZE / sizeof(uint64_t); j++) {
+                frame[j] = ((uint64_t)(i + 1) << 32) | j;
+            }
+        }
+        snprintf(device_name, DEVICE_CAMERA_MAX_LENGTH, DEVICE_CAMERA_NAME, i);
+        stub_create(device_name, (i < EVIEWITF_MAX_CAMERA) ? (const uint8_t *)frame : NULL);
+    }
+    free(frame);
+}
+
+/**
+ * @fn static void stub_function(int32_t *request)
+ * @brief Answer a function request
+ *
+ * @param request: request, answered as successful, ioctl requests read values filled with the device id plus one
+ */
+static void stub_function(int32_t *request) {
+    mfis_ioctl_t *hdr = (mfis_ioctl_t *)request;
+
+    if (hdr->funcid == EVIEWITF_MFIS_FCT_IOCTL) {
+        if (MFIS_IOCDIR(hdr->cmd) & MFIS_IOC_READ) {
+            memset(hdr->arg, hdr->devid + 1, MFIS_IOCSZ(hdr->cmd));
+        }
+        hdr->result = EVIEWITF_MFIS_FCT_RETURN_OK;
+    } else {
+        request[1] = EVIEWITF_MFIS_FCT_RETURN_OK;
+    }
+}
+
+/**
+ * @fn static void stub_camera_attributes(eviewitf_mfis_camera_attributes_t *cameras_attributes)
+ * @brief Get the attributes of the stub cameras and streamers
+ *
+ * @param cameras_attributes: attributes of the cameras followed by the ones of the streamers
+ */
+static void stub_camera_attributes(eviewitf_mfis_camera_attributes_t *cameras_attributes) {
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA + EVIEWITF_MAX_STREAMER; i++) {
+        memset(&cameras_attributes[i], 0, sizeof(eviewitf_mfis_camera_attributes_t));
+        cameras_attributes[i].buffer_size = STUB_BUFFER_SIZE;
+        cameras_attributes[i].width = 1920;
+        cameras_attributes[i].height = 1080;
+        cameras_attributes[i].cam_type =
+            (i < EVIEWITF_MAX_CAMERA) ? EVIEWITF_MFIS_CAM_TYPE_GENERIC : EVIEWITF_MFIS_CAM_TYPE_VIRTUAL;
+    }
+}
+
+/**
+ * @fn int __wrap_ioctl(int fd, unsigned long request, ...)
+ * @brief Answer the MFIS requests, issue the other ioctls
+ *
+ * @param fd: file descriptor
+ * @param request: ioctl request
+ * @return ioctl return value, negative on error
+ */
+int __wrap_ioctl(int fd, unsigned long request, ...) {
+    va_list args;
+    void *arg;
+    unsigned int latency_us;
+    int unbound;
+
+    va_start(args, request);
+    arg = va_arg(args, void *);
+    va_end(args);
+
+    if ((request != EVIEWITF_MFIS_FCT) && (request != EVIEWITF_MFIS_CAMERA_ATTRIBUTES) &&
+        (request != EVIEWITF_MFIS_BLENDING_ATTRIBUTES)) {
+        return __real_ioctl(fd, request, arg);
+    }
+
+    /* Requests on a closed file descriptor fail like on the driver */
+    if (fcntl(fd, F_GETFD) == -1) {
+        return -1;
+    }
+    unbound = __atomic_load_n(&stub_mfis_unbound_requests, __ATOMIC_RELAXED);
+    while ((unbound > 0) && !__atomic_compare_exchange_n(&stub_mfis_unbound_requests, &unbound, unbound - 1, 0,
+                                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    if (unbound > 0) {
+        errno = ENODEV;
+        return -1;
+    }
+
+    if (request == EVIEWITF_MFIS_FCT) {
+        latency_us = __atomic_load_n(&stub_mfis_latency_us, __ATOMIC_RELAXED);
+        if (latency_us != 0) {
+            usleep(latency_us);
+        }
+        stub_function(arg);
+    } else if (request == EVIEWITF_MFIS_CAMERA_ATTRIBUTES) {
+        stub_camera_attributes(arg);
+    } else {
+        memset(arg, 0, EVIEWITF_MAX_BLENDER * sizeof(eviewitf_mfis_blending_attributes_t));
+    }
+
+    return 0;
+}
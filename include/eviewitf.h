@@ -19,6 +19,15 @@
 #include "eviewitf/eviewitf-blender.h"
 #include "eviewitf/eviewitf-pipeline.h"
 #include "eviewitf/eviewitf-plot.h"
+#include "eviewitf/eviewitf-batch.h"
+#include "eviewitf/eviewitf-async.h"
+#include "eviewitf/eviewitf-stats.h"
+#include "eviewitf/eviewitf-waitset.h"
+#include "eviewitf/eviewitf-pool.h"
+#include "eviewitf/eviewitf-capture.h"
+#include "eviewitf/eviewitf-sync.h"
+#include "eviewitf/eviewitf-clock.h"
+#include "eviewitf/eviewitf-recording.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +39,16 @@ extern "C" {
  */
 #define EVIEWITF_MONITORING_INFO_SIZE 6
 
+/**
+ * @brief Initialization flags, see eviewitf_init_ex
+ * @{
+ */
+#define EVIEWITF_INIT_LAZY       (1 << 0) /*!< Get the attributes of a class of devices on the first use of one */
+#define EVIEWITF_INIT_NO_BLENDER (1 << 1) /*!< Blenders are not used, their attributes are never retrieved */
+#define EVIEWITF_INIT_NO_SEEK    (1 << 2) /*!< Seek cameras are not used, they are not registered */
+#define EVIEWITF_INIT_TRACE      (1 << 3) /*!< Print the duration of each initialization step on stderr */
+/** @} */
+
 /**
  * @fn eviewitf_init
  * @brief Initialize the eViewItf API
@@ -43,6 +62,51 @@ extern "C" {
  */
 eviewitf_ret_t eviewitf_init(void);
 
+/**
+ * @fn eviewitf_init_ex
+ * @brief Initialize the eViewItf API with options
+ * @ingroup eview
+ *
+ * @param[in] flags combination of EVIEWITF_INIT_* flags, 0 behaves as eviewitf_init
+ * @return Return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * With EVIEWITF_INIT_LAZY, only the communication with eView is opened. The attributes of the cameras and streamers,
+ * then of the blenders, are retrieved once, on the first use of a device of their class, and kept until
+ * eviewitf_deinit. Short lived processes, such as the eviewitf command line tool, then only pay for the devices they
+ * use.
+ */
+eviewitf_ret_t eviewitf_init_ex(uint32_t flags);
+
+/**
+ * @fn eviewitf_refresh_attributes(uint32_t* generation)
+ * @brief Retrieve again the devices attributes from eView
+ * @ingroup eview
+ *
+ * @param[out] generation attributes generation once refreshed, may be NULL
+ * @return Return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * To be called when the devices configuration changes, a camera resolution for instance, without closing the opened
+ * devices. It is called by eviewitf_pipeline_configure.
+ * The attributes generation is incremented if the attributes of any device have changed. The attributes are replaced
+ * at once, they are never seen partly refreshed, and are kept if they cannot all be retrieved.
+ * Captures started through eviewitf_capture_start or eviewitf_camera_subscribe allocate their frames buffers again,
+ * dropping the queued frames, and synchronization groups drop the frames waiting to be matched. The other buffers
+ * sized from the previous attributes, such as the pools created through eviewitf_camera_create_pool, must be allocated
+ * again by the customer application.
+ */
+eviewitf_ret_t eviewitf_refresh_attributes(uint32_t* generation);
+
+/**
+ * @fn eviewitf_get_attributes_generation(void)
+ * @brief Get the number of times the attributes of a device have changed
+ * @ingroup eview
+ *
+ * @return attributes generation
+ *
+ * A cheap way to check whether the attributes retrieved through the *_get_attributes functions are still current.
+ */
+uint32_t eviewitf_get_attributes_generation(void);
+
 /**
  * @fn eviewitf_deinit
  * @brief De-initialize the eViewItf API
@@ -54,6 +118,43 @@ eviewitf_ret_t eviewitf_init(void);
  */
 eviewitf_ret_t eviewitf_deinit(void);
 
+/**
+ * @fn eviewitf_ctx_create(eviewitf_ctx_t** ctx)
+ * @brief Create a library context
+ * @ingroup eview
+ *
+ * @param[out] ctx created context
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * A context owns the devices opened through it, with the eviewitf_ctx_* functions, so that independent parts of an
+ * application can each open and use their own devices without sharing any lock. The communication with eView and the
+ * devices attributes are common to all the contexts, eviewitf_init must still be called once.
+ * The functions without context use the default context, given by eviewitf_ctx_get_default.
+ * The state built on top of the devices is per process, not per context: the held camera frames, the capture engine
+ * and the regions of interest only use the devices of the default context, the camera frame periods and the statistics
+ * are shared by all the contexts.
+ */
+eviewitf_ret_t eviewitf_ctx_create(eviewitf_ctx_t** ctx);
+
+/**
+ * @fn eviewitf_ctx_destroy(eviewitf_ctx_t* ctx)
+ * @brief Destroy a library context, closing the devices still opened in it
+ * @ingroup eview
+ *
+ * @param[in] ctx context created through eviewitf_ctx_create, no longer used by any other thread
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_destroy(eviewitf_ctx_t* ctx);
+
+/**
+ * @fn eviewitf_ctx_get_default(void)
+ * @brief Get the default library context, used by the functions without context
+ * @ingroup eview
+ *
+ * @return default context, it cannot be destroyed
+ */
+eviewitf_ctx_t* eviewitf_ctx_get_default(void);
+
 /**
  * @fn eviewitf_set_R7_heartbeat_mode(uint32_t mode)
  * @brief Activate or deactivate eView heartbeat.
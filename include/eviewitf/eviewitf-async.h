@@ -0,0 +1,100 @@
+/**
+ * @file eviewitf-async.h
+ * @brief Header for eViewItf API regarding asynchronous requests
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup async
+ *
+ * Communication API between A53 and R7 CPUs to submit requests without waiting for eView answers
+ *
+ * @addtogroup async
+ * @{
+ */
+
+#ifndef EVIEWITF_ASYNC_H
+#define EVIEWITF_ASYNC_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+#include "eviewitf-batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_ASYNC_MAX_REQUESTS
+ * @brief Max number of asynchronous requests submitted and not yet completed or collected
+ */
+#define EVIEWITF_ASYNC_MAX_REQUESTS 32
+
+/**
+ * @def EVIEWITF_ASYNC_MAX_RETRIES
+ * @brief Max number of times a command answered EVIEWITF_BLOCKED is submitted again
+ */
+#define EVIEWITF_ASYNC_MAX_RETRIES 8
+
+/**
+ * @brief Completion of an asynchronous request
+ */
+typedef struct eviewitf_async_completion {
+    uint32_t request_id;     /*!< Identifier returned by eviewitf_async_submit */
+    eviewitf_batch_t* batch; /*!< Batch of the request, results of each command are available in it */
+    eviewitf_ret_t result;   /*!< Result of the first failed command, EVIEWITF_OK if none */
+    void* user_ctx;          /*!< User context given to eviewitf_async_submit */
+} eviewitf_async_completion_t;
+
+/**
+ * @brief Completion callback of an asynchronous request
+ *
+ * The callback is called from the eViewItf worker thread and must not block.
+ */
+typedef void (*eviewitf_async_callback_t)(const eviewitf_async_completion_t* completion);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_async_submit(eviewitf_batch_t* batch, eviewitf_async_callback_t callback,
+ *                                         void* user_ctx, uint32_t* request_id)
+ * @brief Submit a batch of commands without waiting for eView answers
+ *
+ * @param[inout] batch pointer on the batch, it must stay valid and unmodified until the request completes
+ * @param[in] callback function called once the request completes, can be NULL
+ * @param[in] user_ctx user context given back in the completion
+ * @param[out] request_id identifier of the request, can be NULL
+ * @return EVIEWITF_OK if the request is queued, EVIEWITF_BLOCKED if EVIEWITF_ASYNC_MAX_REQUESTS requests are pending.
+ *
+ * The batch is submitted by a worker thread, started on the first call. Commands answered EVIEWITF_BLOCKED by eView
+ * are submitted again up to EVIEWITF_ASYNC_MAX_RETRIES times.
+ * When callback is NULL, the completion is queued and must be collected with eviewitf_async_get_completion.
+ * Otherwise the callback is called instead.
+ */
+eviewitf_ret_t eviewitf_async_submit(eviewitf_batch_t* batch, eviewitf_async_callback_t callback, void* user_ctx,
+                                     uint32_t* request_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_async_get_fd(int* fd)
+ * @brief Get the file descriptor notifying asynchronous completions
+ *
+ * @param[out] fd file descriptor, readable (POLLIN) while completions are waiting to be collected
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The file descriptor can be polled along with other file descriptors. It must not be read nor closed by the
+ * customer application, it is cleared by eviewitf_async_get_completion.
+ */
+eviewitf_ret_t eviewitf_async_get_fd(int* fd);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_async_get_completion(eviewitf_async_completion_t* completion)
+ * @brief Collect the oldest completion of the asynchronous requests submitted without callback
+ *
+ * @param[out] completion completion of the request
+ * @return EVIEWITF_OK if a completion is returned, EVIEWITF_BLOCKED if no completion is waiting.
+ */
+eviewitf_ret_t eviewitf_async_get_completion(eviewitf_async_completion_t* completion);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_ASYNC_H */
+
+/*! \} */
@@ -0,0 +1,284 @@
+/**
+ * @file eviewitf-batch.h
+ * @brief Header for eViewItf API regarding batched requests
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup batch
+ *
+ * Communication API between A53 and R7 CPUs to submit several device requests at once
+ *
+ * @addtogroup batch
+ * @{
+ */
+
+#ifndef EVIEWITF_BATCH_H
+#define EVIEWITF_BATCH_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_BATCH_MAX_COMMANDS
+ * @brief Max number of commands in a batch
+ */
+#define EVIEWITF_BATCH_MAX_COMMANDS 64
+
+/**
+ * @def EVIEWITF_BATCH_PARAM_WORDS
+ * @brief Size of a command parameter (in 32 bits words)
+ */
+#define EVIEWITF_BATCH_PARAM_WORDS 16
+
+/**
+ * @def EVIEWITF_BATCH_MAX_OUTPUTS
+ * @brief Max number of output values of a command
+ */
+#define EVIEWITF_BATCH_MAX_OUTPUTS 4
+
+/**
+ * @brief Command of a batch
+ *
+ * The content of this structure is filled in by the eviewitf_batch_* functions and should not be modified by the
+ * customer application, except for reading the result once the batch is submitted.
+ */
+typedef struct eviewitf_batch_command {
+    uint8_t devtype;                            /*!< Device type */
+    uint8_t devid;                              /*!< Device identifier */
+    uint16_t cmd;                               /*!< I/O command */
+    uint32_t param[EVIEWITF_BATCH_PARAM_WORDS]; /*!< I/O parameter */
+    void *output[EVIEWITF_BATCH_MAX_OUTPUTS];   /*!< Where to store the values read by the command */
+    eviewitf_ret_t result;                      /*!< Result of the command once the batch is submitted */
+} eviewitf_batch_command_t;
+
+/**
+ * @brief Batch of commands
+ *
+ * A batch is allocated by the customer application (it can be on the stack) and must be reset with
+ * eviewitf_batch_reset before adding commands to it.
+ */
+typedef struct eviewitf_batch {
+    uint32_t nb_commands;                                           /*!< Number of commands in the batch */
+    eviewitf_batch_command_t commands[EVIEWITF_BATCH_MAX_COMMANDS]; /*!< Commands */
+} eviewitf_batch_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_reset(eviewitf_batch_t* batch)
+ * @brief Remove all the commands of a batch
+ *
+ * @param[out] batch pointer on the batch
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_reset(eviewitf_batch_t* batch);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_submit(eviewitf_batch_t* batch)
+ * @brief Submit all the commands of a batch
+ *
+ * @param[inout] batch pointer on the batch
+ * @return EVIEWITF_OK if all the commands succeeded, otherwise the result of the first failed command.
+ *
+ * The commands are executed in the order they were added. All the commands are executed, even if one of them fails.
+ * The result of each command can be retrieved through eviewitf_batch_get_result. The values read by the commands are
+ * stored where requested when the commands were added. A batch can be submitted several times.
+ */
+eviewitf_ret_t eviewitf_batch_submit(eviewitf_batch_t* batch);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_get_result(eviewitf_batch_t* batch, uint32_t index, eviewitf_ret_t* result)
+ * @brief Get the result of a command once the batch is submitted
+ *
+ * @param[in] batch pointer on the batch
+ * @param[in] index index of the command, commands are indexed from 0 in the order they were added
+ * @param[out] result result of the command
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_get_result(eviewitf_batch_t* batch, uint32_t index, eviewitf_ret_t* result);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_add(eviewitf_batch_t* batch, uint8_t devtype, uint8_t devid, uint16_t cmd,
+ *                                     const void* param)
+ * @brief Add a raw MFIS I/O command to a batch
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] devtype MFIS device type (camera, pipeline, serializer or video)
+ * @param[in] devid device identifier
+ * @param[in] cmd MFIS_IOW/MFIS_IOR encoded I/O command, giving the size of the parameter
+ * @param[in] param I/O parameter, can be NULL
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Meant for the commands without a typed eviewitf_batch_* function. The values read by the command are left in the
+ * param field of the command once the batch is submitted.
+ */
+eviewitf_ret_t eviewitf_batch_add(eviewitf_batch_t* batch, uint8_t devtype, uint8_t devid, uint16_t cmd,
+                                  const void* param);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_set_exposure(eviewitf_batch_t* batch, int cam_id, uint32_t exposure_us,
+ *                                                      uint32_t gain_thou)
+ * @brief Add a command setting a camera's exposure time and gain
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] exposure_us exposure time in micro seconds
+ * @param[in] gain_thou gain in 1/1000 of unit
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_set_exposure(eviewitf_batch_t* batch, int cam_id, uint32_t exposure_us,
+                                                  uint32_t gain_thou);
+
+/* clang-format off */
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_set_digital_gains(eviewitf_batch_t* batch, int cam_id, uint16_t dg_cf00, uint16_t dg_cf01, uint16_t dg_cf10, uint16_t dg_cf11)
+ * @brief Add a command setting a camera's CFA patterns digital gains
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] dg_cf00 CFA 00 digital gain
+ * @param[in] dg_cf01 CFA 01 digital gain
+ * @param[in] dg_cf10 CFA 10 digital gain
+ * @param[in] dg_cf11 CFA 11 digital gain
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_set_digital_gains(eviewitf_batch_t* batch, int cam_id, uint16_t dg_cf00, uint16_t dg_cf01, uint16_t dg_cf10, uint16_t dg_cf11);
+/* clang-format on */
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_set_frame_rate(eviewitf_batch_t* batch, int cam_id, uint16_t fps)
+ * @brief Add a command setting a camera's frame rate
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] fps camera frame rate
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_set_frame_rate(eviewitf_batch_t* batch, int cam_id, uint16_t fps);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_set_frame_offset(eviewitf_batch_t* batch, int cam_id, uint32_t x_offset,
+ *                                                          uint32_t y_offset)
+ * @brief Add a command setting a camera's frame offset relative to camera sensor
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] x_offset frame offset (width)
+ * @param[in] y_offset frame offset (height)
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_set_frame_offset(eviewitf_batch_t* batch, int cam_id, uint32_t x_offset,
+                                                      uint32_t y_offset);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_set_test_pattern(eviewitf_batch_t* batch, int cam_id, uint8_t pattern)
+ * @brief Add a command setting a camera's test pattern
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] pattern test pattern used
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_set_test_pattern(eviewitf_batch_t* batch, int cam_id, uint8_t pattern);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_get_exposure(eviewitf_batch_t* batch, int cam_id, uint32_t* exposure_us,
+ *                                                      uint32_t* gain_thou)
+ * @brief Add a command getting a camera's exposure time and gain
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] exposure_us pointer to the returned exposure time in micro seconds, filled in on submission
+ * @param[out] gain_thou pointer to the returned gain in 1/1000 of unit, filled in on submission
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_get_exposure(eviewitf_batch_t* batch, int cam_id, uint32_t* exposure_us,
+                                                  uint32_t* gain_thou);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_get_frame_rate(eviewitf_batch_t* batch, int cam_id, uint16_t* fps)
+ * @brief Add a command getting a camera's frame rate
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] fps pointer to the returned camera frame rate, filled in on submission
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_get_frame_rate(eviewitf_batch_t* batch, int cam_id, uint16_t* fps);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_camera_get_frame_offset(eviewitf_batch_t* batch, int cam_id, uint32_t* x_offset,
+ *                                                          uint32_t* y_offset)
+ * @brief Add a command getting a camera's frame offset relative to camera sensor
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] x_offset pointer to the returned frame offset (width), filled in on submission
+ * @param[out] y_offset pointer to the returned frame offset (height), filled in on submission
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_camera_get_frame_offset(eviewitf_batch_t* batch, int cam_id, uint32_t* x_offset,
+                                                      uint32_t* y_offset);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_video_resume(eviewitf_batch_t* batch, int cam_id)
+ * @brief Add a command resuming video display for a camera device
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_video_resume(eviewitf_batch_t* batch, int cam_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_video_suspend(eviewitf_batch_t* batch, int cam_id)
+ * @brief Add a command suspending video display for a camera device
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_video_suspend(eviewitf_batch_t* batch, int cam_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_pipeline_configure(eviewitf_batch_t* batch, uint8_t pipeline_id,
+ *                                                     uint32_t frame_width, uint32_t frame_height)
+ * @brief Add a command configuring a pipeline
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] pipeline_id id of the pipeline between 0 and EVIEWITF_MAX_PIPELINE
+ * @param[in] frame_width output frame width
+ * @param[in] frame_height output frame height
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_pipeline_configure(eviewitf_batch_t* batch, uint8_t pipeline_id, uint32_t frame_width,
+                                                 uint32_t frame_height);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_pipeline_start(eviewitf_batch_t* batch, uint8_t pipeline_id)
+ * @brief Add a command starting a pipeline
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] pipeline_id id of the pipeline between 0 and EVIEWITF_MAX_PIPELINE
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_pipeline_start(eviewitf_batch_t* batch, uint8_t pipeline_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_batch_pipeline_stop(eviewitf_batch_t* batch, uint8_t pipeline_id)
+ * @brief Add a command stopping a pipeline
+ *
+ * @param[inout] batch pointer on the batch
+ * @param[in] pipeline_id id of the pipeline between 0 and EVIEWITF_MAX_PIPELINE
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_batch_pipeline_stop(eviewitf_batch_t* batch, uint8_t pipeline_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_BATCH_H */
+
+/*! \} */
@@ -39,6 +39,18 @@ extern "C" {
  */
 eviewitf_ret_t eviewitf_blender_open(int blender_id);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_blender_open(eviewitf_ctx_t* ctx, int blender_id)
+ * @brief Open a blender device in a context
+ *
+ * @param[in] ctx context the blender is opened in
+ * @param[in] blender_id id of the blender between 0 and EVIEWITF_MAX_BLENDER
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Same as eviewitf_blender_open, the blender being only seen as opened by the functions given the same context.
+ */
+eviewitf_ret_t eviewitf_ctx_blender_open(eviewitf_ctx_t* ctx, int blender_id);
+
 /**
  * @fn eviewitf_ret_t eviewitf_blender_close(int blender_id)
  * @brief Close a blender device
@@ -50,6 +62,16 @@ eviewitf_ret_t eviewitf_blender_open(int blender_id);
  */
 eviewitf_ret_t eviewitf_blender_close(int blender_id);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_blender_close(eviewitf_ctx_t* ctx, int blender_id)
+ * @brief Close a blender device opened in a context
+ *
+ * @param[in] ctx context the blender is opened in
+ * @param[in] blender_id id of the blender between 0 and EVIEWITF_MAX_BLENDER
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_blender_close(eviewitf_ctx_t* ctx, int blender_id);
+
 /**
  * @fn eviewitf_ret_t eviewitf_blender_get_attributes(int blender_id, eviewitf_device_attributes_t* attributes)
  * @brief Get the attributes of a blender such as buffer size
@@ -77,6 +99,20 @@ eviewitf_ret_t eviewitf_blender_get_attributes(int blender_id, eviewitf_device_a
  */
 eviewitf_ret_t eviewitf_blender_write_frame(int blender_id, uint8_t* frame_buffer, uint32_t buffer_size);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_blender_write_frame(eviewitf_ctx_t* ctx, int blender_id, uint8_t* frame_buffer,
+ *                                                    uint32_t buffer_size)
+ * @brief Write a frame to a blender opened in a context
+ *
+ * @param[in] ctx context the blender is opened in
+ * @param[in] blender_id id of the blender between 0 and EVIEWITF_MAX_BLENDER
+ * @param[in] frame_buffer blender buffer
+ * @param[in] buffer_size size of the blender buffer
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_blender_write_frame(eviewitf_ctx_t* ctx, int blender_id, uint8_t* frame_buffer,
+                                                uint32_t buffer_size);
+
 #ifdef __cplusplus
 }
 #endif
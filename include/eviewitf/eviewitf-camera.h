@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include "eviewitf-structs.h"
+#include "eviewitf-pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +28,18 @@ extern "C" {
  */
 #define EVIEWITF_MAX_CAMERA 8
 
+/**
+ * @def EVIEWITF_MAX_CAMERA_FRAMES
+ * @brief Max number of frames of a camera held at the same time through eviewitf_camera_map_frame
+ */
+#define EVIEWITF_MAX_CAMERA_FRAMES 4
+
+/**
+ * @def EVIEWITF_MAX_CAMERA_ROI
+ * @brief Max number of regions of interest read at once through eviewitf_camera_get_frame_rois
+ */
+#define EVIEWITF_MAX_CAMERA_ROI 16
+
 /**
  * @brief Possible camera test patterns
  * @{
@@ -57,6 +70,21 @@ extern "C" {
  */
 eviewitf_ret_t eviewitf_camera_open(int cam_id);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_camera_open(eviewitf_ctx_t* ctx, int cam_id)
+ * @brief Open a camera device in a context
+ *
+ * @param[in] ctx context the camera is opened in
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Same as eviewitf_camera_open, the camera being only seen as opened by the functions given the same context.
+ * Only the file descriptor belongs to the context: the frames held through eviewitf_camera_map_frame, the capture
+ * engine, the regions of interest mapping and the frame period are kept per process, those functions using the camera
+ * opened in the default context.
+ */
+eviewitf_ret_t eviewitf_ctx_camera_open(eviewitf_ctx_t* ctx, int cam_id);
+
 /**
  * @fn eviewitf_ret_t eviewitf_camera_close(int cam_id)
  * @brief Close a camera device
@@ -68,6 +96,16 @@ eviewitf_ret_t eviewitf_camera_open(int cam_id);
  */
 eviewitf_ret_t eviewitf_camera_close(int cam_id);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_camera_close(eviewitf_ctx_t* ctx, int cam_id)
+ * @brief Close a camera device opened in a context
+ *
+ * @param[in] ctx context the camera is opened in
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_camera_close(eviewitf_ctx_t* ctx, int cam_id);
+
 /**
  * @fn eviewitf_ret_t eviewitf_camera_start(int cam_id)
  * @brief Request to start a camera
@@ -99,6 +137,21 @@ eviewitf_ret_t eviewitf_camera_stop(int cam_id);
  */
 eviewitf_ret_t eviewitf_camera_get_attributes(int cam_id, eviewitf_device_attributes_t* attributes);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_create_pool(int cam_id, int nb_buffers, uint32_t flags, eviewitf_pool_t** pool)
+ * @brief Create a pool of buffers sized to hold the frames of a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] nb_buffers number of buffers between 1 and EVIEWITF_POOL_MAX_BUFFERS
+ * @param[in] flags 0 or EVIEWITF_POOL_HUGE_PAGES
+ * @param[out] pool created pool
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The buffers are suitable for eviewitf_camera_get_frame, they are taken and given back through eviewitf_pool_acquire
+ * and eviewitf_pool_release. The pool must be destroyed through eviewitf_pool_destroy.
+ */
+eviewitf_ret_t eviewitf_camera_create_pool(int cam_id, int nb_buffers, uint32_t flags, eviewitf_pool_t** pool);
+
 /**
  * @fn eviewitf_ret_t eviewitf_camera_get_frame(int cam_id, uint8_t *frame_buffer, uint32_t buffer_size)
  * @brief Get a copy (from eView context memory) of the latest frame received from a camera.
@@ -114,6 +167,20 @@ eviewitf_ret_t eviewitf_camera_get_attributes(int cam_id, eviewitf_device_attrib
  */
 eviewitf_ret_t eviewitf_camera_get_frame(int cam_id, uint8_t* frame_buffer, uint32_t buffer_size);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_camera_get_frame(eviewitf_ctx_t* ctx, int cam_id, uint8_t* frame_buffer,
+ *                                                 uint32_t buffer_size)
+ * @brief Get a copy of the latest frame received from a camera opened in a context
+ *
+ * @param[in] ctx context the camera is opened in
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frame_buffer buffer to store the incoming frame
+ * @param[in] buffer_size buffer size for coherency check
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_camera_get_frame(eviewitf_ctx_t* ctx, int cam_id, uint8_t* frame_buffer,
+                                             uint32_t buffer_size);
+
 /**
  * @fn eviewitf_ret_t eviewitf_camera_get_frame_segment(int cam_id, uint8_t* buffer, uint32_t size, uint32_t offset)
  * @brief Get a copy (from eView context memory) of a segment of the latest frame received from a
@@ -131,6 +198,57 @@ eviewitf_ret_t eviewitf_camera_get_frame(int cam_id, uint8_t* frame_buffer, uint
  */
 eviewitf_ret_t eviewitf_camera_get_frame_segment(int cam_id, uint8_t* buffer, uint32_t size, uint32_t offset);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_camera_get_frame_segment(eviewitf_ctx_t* ctx, int cam_id, uint8_t* buffer,
+ *                                                         uint32_t size, uint32_t offset)
+ * @brief Get a copy of a segment of the latest frame received from a camera opened in a context
+ *
+ * @param[in] ctx context the camera is opened in
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] buffer buffer to store the incoming segment
+ * @param[in] size buffer size of the segment
+ * @param[in] offset offset of the segment from frame buffer start adress
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_camera_get_frame_segment(eviewitf_ctx_t* ctx, int cam_id, uint8_t* buffer, uint32_t size,
+                                                     uint32_t offset);
+
+/**
+ * @brief Rectangular region of interest of a frame
+ */
+typedef struct eviewitf_camera_roi {
+    uint32_t x;      /*!< Region upper left horizontal position (in pixels) */
+    uint32_t y;      /*!< Region upper left vertical position (in pixels) */
+    uint32_t width;  /*!< Region width (in pixels) */
+    uint32_t height; /*!< Region height (in pixels) */
+    uint8_t segment; /*!< Frame segment holding the region */
+    uint8_t* buffer; /*!< Buffer to store the region rows, packed, of width * height * bpp bytes */
+} eviewitf_camera_roi_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_get_frame_rois(int cam_id, const eviewitf_frame_metadata_info_t* frame_metadata,
+ *                                                  const eviewitf_camera_roi_t* rois, int nb_rois)
+ * @brief Get a copy of regions of interest of the latest frame received from a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] frame_metadata metadata giving the frame geometry, width, height, size and segments offsets
+ * @param[in] rois regions to copy
+ * @param[in] nb_rois number of regions, between 1 and EVIEWITF_MAX_CAMERA_ROI
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The segments give the planes of the frame, with the same geometry as eviewitf_camera_get_frame_view: a region lies
+ * within the width and rows of its plane, and is stored as width * plane bytes per pixel bytes per row.
+ * Only the rows of the regions are copied: straight from the camera frame buffer when it can be mapped, the mapping
+ * being kept until the camera is closed, otherwise with vectored reads, the rows close to each other being read in
+ * the same operation.
+ * The copy is not atomic: the regions, and even the rows of a region, may come from different frames when the camera
+ * writes a new frame meanwhile, as the buffer is then read through several operations or mapped live. Use
+ * eviewitf_camera_get_frame to get consistent regions.
+ * The geometry is typically taken once from eviewitf_camera_get_frame_metadata, as it does not change between frames.
+ */
+eviewitf_ret_t eviewitf_camera_get_frame_rois(int cam_id, const eviewitf_frame_metadata_info_t* frame_metadata,
+                                              const eviewitf_camera_roi_t* rois, int nb_rois);
+
 /**
  * @fn eviewitf_ret_t eviewitf_camera_get_frame_metadata(int cam_id, eviewitf_frame_metadata_info_t* frame_metadata)
  * @brief Read frame metadata (which is a frame segment)
@@ -144,6 +262,85 @@ eviewitf_ret_t eviewitf_camera_get_frame_segment(int cam_id, uint8_t* buffer, ui
  */
 eviewitf_ret_t eviewitf_camera_get_frame_metadata(int cam_id, eviewitf_frame_metadata_info_t* frame_metadata);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_camera_get_frame_metadata(eviewitf_ctx_t* ctx, int cam_id,
+ *                                                          eviewitf_frame_metadata_info_t* frame_metadata)
+ * @brief Read the frame metadata of a camera opened in a context
+ *
+ * @param[in] ctx context the camera is opened in
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frame_metadata pointer on metadata structure to be filled
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_camera_get_frame_metadata(eviewitf_ctx_t* ctx, int cam_id,
+                                                      eviewitf_frame_metadata_info_t* frame_metadata);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_get_frame_with_metadata(int cam_id, uint8_t* frame_buffer, uint32_t buffer_size,
+ *                                                           eviewitf_frame_metadata_info_t* frame_metadata)
+ * @brief Get a copy of the latest frame received from a camera along with its metadata, in a single read
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frame_buffer buffer to store the incoming frame
+ * @param[in] buffer_size size of frame_buffer
+ * @param[out] frame_metadata pointer on metadata structure to be filled
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * buffer_size must either be the camera buffer size, in which case the metadata are also left at the end of
+ * frame_buffer, or the camera buffer size minus the size of eviewitf_frame_metadata_info_t, in which case only the
+ * pixel data are stored in frame_buffer.
+ * If the frame has no valid metadata, the frame is still returned and frame_metadata is zeroed.
+ */
+eviewitf_ret_t eviewitf_camera_get_frame_with_metadata(int cam_id, uint8_t* frame_buffer, uint32_t buffer_size,
+                                                       eviewitf_frame_metadata_info_t* frame_metadata);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_camera_get_frame_with_metadata(eviewitf_ctx_t* ctx, int cam_id,
+ *                                                               uint8_t* frame_buffer, uint32_t buffer_size,
+ *                                                               eviewitf_frame_metadata_info_t* frame_metadata)
+ * @brief Get a copy of the latest frame received from a camera opened in a context, along with its metadata
+ *
+ * @param[in] ctx context the camera is opened in
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frame_buffer buffer to store the incoming frame
+ * @param[in] buffer_size size of frame_buffer, see eviewitf_camera_get_frame_with_metadata
+ * @param[out] frame_metadata pointer on metadata structure to be filled
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_camera_get_frame_with_metadata(eviewitf_ctx_t* ctx, int cam_id, uint8_t* frame_buffer,
+                                                           uint32_t buffer_size,
+                                                           eviewitf_frame_metadata_info_t* frame_metadata);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_map_frame(int cam_id, uint8_t** frame_buffer, uint32_t* buffer_size)
+ * @brief Get the latest frame received from a camera in a buffer held by the library
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frame_buffer pointer on the frame, read only
+ * @param[out] buffer_size size of the frame buffer
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frame is copied, as eviewitf_camera_get_frame does, into a buffer taken from a pool preallocated for the camera,
+ * so that the customer application does not have to allocate it. The frame belongs to the customer application until
+ * it is given back through a call to eviewitf_camera_release_frame, and does not change meanwhile.
+ * The camera device only exposes the buffer the driver keeps writing the incoming frames into: a mapping of it would
+ * change or tear while held, so it is not handed to the customer application.
+ * EVIEWITF_BLOCKED is returned if EVIEWITF_MAX_CAMERA_FRAMES frames of the camera are already held.
+ */
+eviewitf_ret_t eviewitf_camera_map_frame(int cam_id, uint8_t** frame_buffer, uint32_t* buffer_size);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_release_frame(int cam_id, uint8_t* frame_buffer)
+ * @brief Give back a frame obtained through eviewitf_camera_map_frame
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] frame_buffer pointer on the frame returned by eviewitf_camera_map_frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frame buffer must not be accessed anymore once released.
+ */
+eviewitf_ret_t eviewitf_camera_release_frame(int cam_id, uint8_t* frame_buffer);
+
 /**
  * @fn eviewitf_ret_t eviewitf_camera_extract_metadata(uint8_t *buf, uint32_t buffer_size,
                               eviewitf_frame_metadata_info_t *frame_metadata)
@@ -159,6 +356,37 @@ eviewitf_ret_t eviewitf_camera_get_frame_metadata(int cam_id, eviewitf_frame_met
  */
 eviewitf_ret_t eviewitf_camera_extract_metadata(uint8_t* buf, uint32_t buffer_size,
                                                 eviewitf_frame_metadata_info_t* frame_metadata);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_get_frame_view(const uint8_t* buf, uint32_t buffer_size,
+ *                                                  eviewitf_frame_view_t* view)
+ * @brief Describe the planes of a frame buffer from its metadata, without copying it
+ *
+ * @param[in] buf pointer on the buffer where the frame is stored, metadata included
+ * @param[in] buffer_size size of the buffer
+ * @param[out] view planes of the frame, pointing into buf
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Each metadata segment whose offset follows the previous one within the frame size gives a plane, ending where the
+ * next one starts. EVIEWITF_FAIL is returned if the frame has no valid metadata.
+ * The planes can be iterated with EVIEWITF_FRAME_VIEW_FOREACH_PLANE.
+ */
+eviewitf_ret_t eviewitf_camera_get_frame_view(const uint8_t* buf, uint32_t buffer_size, eviewitf_frame_view_t* view);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_find_plane(const eviewitf_frame_view_t* view, uint8_t dt,
+ *                                              const eviewitf_frame_plane_t** plane)
+ * @brief Find the first plane of a frame view with a given data type
+ *
+ * @param[in] view frame view obtained through eviewitf_camera_get_frame_view
+ * @param[in] dt data type of the plane
+ * @param[out] plane pointer on the plane, in view
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * EVIEWITF_FAIL is returned if the frame has no plane of this data type.
+ */
+eviewitf_ret_t eviewitf_camera_find_plane(const eviewitf_frame_view_t* view, uint8_t dt,
+                                          const eviewitf_frame_plane_t** plane);
 /**
  * @fn eviewitf_ret_t eviewitf_camera_poll(int* cam_id, int nb_cam, int ms_timeout, short* event_return)
  * @brief Poll on multiple cameras to check a new frame is available
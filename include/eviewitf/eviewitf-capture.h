@@ -0,0 +1,223 @@
+/**
+ * @file eviewitf-capture.h
+ * @brief Header for eViewItf API regarding background capture
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup capture
+ *
+ * Communication API between A53 and R7 CPUs to capture the frames of cameras in the background
+ *
+ * @addtogroup capture
+ * @{
+ */
+
+#ifndef EVIEWITF_CAPTURE_H
+#define EVIEWITF_CAPTURE_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_CAPTURE_MAX_FRAMES
+ * @brief Max number of captured frames queued per camera
+ */
+#define EVIEWITF_CAPTURE_MAX_FRAMES 16
+
+/**
+ * @def EVIEWITF_CAPTURE_MAX_HELD_FRAMES
+ * @brief Max number of captured frames of a camera held at the same time by the customer application
+ */
+#define EVIEWITF_CAPTURE_MAX_HELD_FRAMES 8
+
+/**
+ * @def EVIEWITF_SUBSCRIBE_INLINE
+ * @brief Subscription callback called by the capture thread of the camera
+ */
+#define EVIEWITF_SUBSCRIBE_INLINE (1 << 0)
+
+/**
+ * @def EVIEWITF_SUBSCRIBE_WORKER_POOL
+ * @brief Subscription callback called by worker threads shared by all the cameras
+ */
+#define EVIEWITF_SUBSCRIBE_WORKER_POOL (1 << 1)
+
+/**
+ * @def EVIEWITF_SUBSCRIBE_THREAD
+ * @brief Subscription callback called by a thread dedicated to the camera, the default
+ */
+#define EVIEWITF_SUBSCRIBE_THREAD (1 << 2)
+
+/**
+ * @def EVIEWITF_SUBSCRIBE_WORKERS
+ * @brief Number of worker threads of EVIEWITF_SUBSCRIBE_WORKER_POOL
+ */
+#define EVIEWITF_SUBSCRIBE_WORKERS 4
+
+/**
+ * @def EVIEWITF_SUBSCRIBE_QUEUED_FRAMES
+ * @brief Number of frames queued for a subscription of EVIEWITF_SUBSCRIBE_THREAD, the oldest one is dropped when full
+ */
+#define EVIEWITF_SUBSCRIBE_QUEUED_FRAMES 4
+
+/**
+ * @brief Behavior when a frame is captured while the queue is full
+ */
+typedef enum eviewitf_capture_policy {
+    EVIEWITF_CAPTURE_DROP_OLDEST, /*!< The oldest queued frame is dropped */
+    EVIEWITF_CAPTURE_DROP_NEWEST, /*!< The captured frame is dropped */
+} eviewitf_capture_policy_t;
+
+/**
+ * @brief Captured frame
+ */
+typedef struct eviewitf_capture_frame {
+    uint8_t* buffer;                         /*!< Frame buffer, metadata included */
+    uint32_t buffer_size;                    /*!< Frame buffer size */
+    uint64_t sequence;                       /*!< Capture sequence number, starting at 1 */
+    uint64_t capture_ns;                     /*!< CLOCK_MONOTONIC time the frame was read (ns) */
+    eviewitf_frame_metadata_info_t metadata; /*!< Frame metadata, zeroed if the frame has none */
+} eviewitf_capture_frame_t;
+
+/**
+ * @brief Capture counters of a camera
+ */
+typedef struct eviewitf_capture_stats {
+    uint64_t nb_captured; /*!< Number of frames read from the camera */
+    uint64_t nb_dropped;  /*!< Number of frames dropped because the queue was full or no buffer was free */
+    uint64_t nb_errors;   /*!< Number of failed reads */
+} eviewitf_capture_stats_t;
+
+/**
+ * @brief Subscription callback, the frame is only valid until the callback returns
+ */
+typedef void (*eviewitf_camera_callback_t)(int cam_id, const eviewitf_capture_frame_t* frame, void* user_ctx);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_capture_start(int cam_id, int nb_frames, eviewitf_capture_policy_t policy)
+ * @brief Start capturing the frames of a camera in a background thread
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] nb_frames number of queued frames between 1 and EVIEWITF_CAPTURE_MAX_FRAMES
+ * @param[in] policy behavior when the queue is full
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The camera must be opened, and must not be closed before the capture is stopped.
+ * Every new frame of the camera is read by the capture thread along with its metadata, and queued. The capture thread
+ * never waits for the customer application: frames are dropped according to policy, and counted, when the queue is
+ * full.
+ */
+eviewitf_ret_t eviewitf_capture_start(int cam_id, int nb_frames, eviewitf_capture_policy_t policy);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_capture_stop(int cam_id)
+ * @brief Stop capturing the frames of a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * EVIEWITF_BLOCKED is returned, and the capture goes on, if captured frames are still held by the customer
+ * application. Queued frames are dropped. Subscribed cameras are stopped through eviewitf_camera_unsubscribe.
+ */
+eviewitf_ret_t eviewitf_capture_stop(int cam_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_capture_get_frame(int cam_id, int64_t ns_timeout, eviewitf_capture_frame_t* frame)
+ * @brief Take the oldest queued frame of a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] ns_timeout delay the function should block waiting for a frame in ns, negative value means infinite
+ * @param[out] frame captured frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Each frame is given to a single caller, so that several threads can share the processing of all the frames.
+ * EVIEWITF_BLOCKED is returned on timeout, EVIEWITF_NOT_OPENED if the capture is not started.
+ * EVIEWITF_TOO_MANY_HELD is returned at once, without waiting, if EVIEWITF_CAPTURE_MAX_HELD_FRAMES frames of the camera
+ * are already held: a frame must be released before trying again.
+ * The frame must be given back through eviewitf_capture_release_frame.
+ */
+eviewitf_ret_t eviewitf_capture_get_frame(int cam_id, int64_t ns_timeout, eviewitf_capture_frame_t* frame);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_capture_get_latest_frame(int cam_id, eviewitf_capture_frame_t* frame)
+ * @brief Get the latest captured frame of a camera, without waiting nor dequeuing it
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frame captured frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The same frame can be given to several callers, the sequence number tells whether it is a new one.
+ * EVIEWITF_BLOCKED is returned if no frame has been captured yet, EVIEWITF_NOT_OPENED if the capture is not started,
+ * EVIEWITF_TOO_MANY_HELD if EVIEWITF_CAPTURE_MAX_HELD_FRAMES frames of the camera are already held.
+ * The frame must be given back through eviewitf_capture_release_frame.
+ */
+eviewitf_ret_t eviewitf_capture_get_latest_frame(int cam_id, eviewitf_capture_frame_t* frame);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_capture_release_frame(int cam_id, eviewitf_capture_frame_t* frame)
+ * @brief Give back a captured frame
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] frame frame obtained through eviewitf_capture_get_frame or eviewitf_capture_get_latest_frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frame buffer must not be accessed anymore once released.
+ */
+eviewitf_ret_t eviewitf_capture_release_frame(int cam_id, eviewitf_capture_frame_t* frame);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_capture_get_stats(int cam_id, eviewitf_capture_stats_t* stats)
+ * @brief Get the capture counters of a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] stats capture counters since the capture was started
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_capture_get_stats(int cam_id, eviewitf_capture_stats_t* stats);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_subscribe(int cam_id, eviewitf_camera_callback_t callback, void* user_ctx,
+ *                                             uint32_t flags)
+ * @brief Get every new frame of a camera through a callback
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[in] callback function called with each frame
+ * @param[in] user_ctx context given to the callback
+ * @param[in] flags executor of the callback, one of EVIEWITF_SUBSCRIBE_*, 0 for EVIEWITF_SUBSCRIBE_THREAD
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The background capture of the camera is started, frames are read by the capture thread and given to the callback by
+ * the executor:
+ * - EVIEWITF_SUBSCRIBE_INLINE: the capture thread itself, without any thread switch, the next frame is read once the
+ *   callback returns.
+ * - EVIEWITF_SUBSCRIBE_WORKER_POOL: EVIEWITF_SUBSCRIBE_WORKERS threads shared by all the subscribed cameras, several
+ *   frames of a camera can be processed at the same time, up to EVIEWITF_CAPTURE_MAX_HELD_FRAMES.
+ * - EVIEWITF_SUBSCRIBE_THREAD: a thread dedicated to the camera, the frames are processed in order.
+ *
+ * Frames are dropped, and counted in the capture counters, when the callbacks cannot keep up. The callback must not
+ * subscribe nor unsubscribe a camera. The capture must not be already started.
+ */
+eviewitf_ret_t eviewitf_camera_subscribe(int cam_id, eviewitf_camera_callback_t callback, void* user_ctx,
+                                         uint32_t flags);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_camera_unsubscribe(int cam_id)
+ * @brief Stop getting the frames of a camera through a callback
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The function returns once the callbacks in progress have returned, the background capture of the camera is stopped.
+ */
+eviewitf_ret_t eviewitf_camera_unsubscribe(int cam_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_CAPTURE_H */
+
+/*! \} */
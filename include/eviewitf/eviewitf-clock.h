@@ -0,0 +1,74 @@
+/**
+ * @file eviewitf-clock.h
+ * @brief Header for eViewItf API regarding the R7 clock
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup clock
+ *
+ * Communication API between A53 and R7 CPUs to convert the R7 frame timestamps to the Linux monotonic clock
+ *
+ * @addtogroup clock
+ * @{
+ */
+
+#ifndef EVIEWITF_CLOCK_H
+#define EVIEWITF_CLOCK_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_CLOCK_MAX_POINTS
+ * @brief Number of synchronization points the drift is estimated from, one per second of frames
+ */
+#define EVIEWITF_CLOCK_MAX_POINTS 32
+
+/**
+ * @brief State of the R7 clock estimation
+ */
+typedef struct eviewitf_clock_sync {
+    int nb_points;      /*!< Number of synchronization points the drift is estimated from */
+    int64_t offset_ns;  /*!< CLOCK_MONOTONIC time minus R7 timestamp at the latest point (ns) */
+    double drift_ppm;   /*!< Drift of the R7 clock against CLOCK_MONOTONIC (ppm), positive if the R7 clock is slower */
+    uint64_t update_ns; /*!< CLOCK_MONOTONIC time of the latest point (ns) */
+} eviewitf_clock_sync_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_timestamp_to_monotonic(uint64_t timestamp, uint64_t* monotonic_ns)
+ * @brief Convert an R7 frame timestamp to the CLOCK_MONOTONIC time base
+ *
+ * @param[in] timestamp R7 timestamp, made of frame_timestamp_msb and frame_timestamp_lsb from the frame metadata (ns)
+ * @param[out] monotonic_ns CLOCK_MONOTONIC time of the timestamp (ns)
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The R7 timestamps count nanoseconds of the R7 clock: the estimation starts from one R7 nanosecond per
+ * CLOCK_MONOTONIC nanosecond, the earliest arrivals are found by comparing both clocks directly, and drift_ppm is the
+ * deviation of the fitted rate from one. Timestamps in another unit would not be converted correctly.
+ * The R7 clock offset and drift are estimated from the arrival times of the frames read with their metadata, using the
+ * earliest arrival of each second as the closest to the capture time. The estimation is lock free and needs no system
+ * call, so that the function can be called for every frame.
+ * EVIEWITF_BLOCKED is returned until a frame with metadata has been read. The converted time includes the minimum
+ * transfer delay from the R7 CPU, which cannot be measured from Linux.
+ */
+eviewitf_ret_t eviewitf_timestamp_to_monotonic(uint64_t timestamp, uint64_t* monotonic_ns);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_clock_get_sync(eviewitf_clock_sync_t* sync)
+ * @brief Get the state of the R7 clock estimation
+ *
+ * @param[out] sync state of the estimation
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_clock_get_sync(eviewitf_clock_sync_t* sync);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_CLOCK_H */
+
+/*! \} */
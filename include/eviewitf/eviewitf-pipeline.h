@@ -56,6 +56,10 @@ eviewitf_ret_t eviewitf_pipeline_reboot(uint8_t pipeline_id);
  * @param[in] frame_width frame width between 0 to 4096
  * @param[in] frame_height frame height between 0 to 4096
  * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The devices attributes are then retrieved again, see eviewitf_refresh_attributes. The returned code only tells
+ * whether the pipeline has been configured: if the attributes cannot be retrieved, the previous ones are kept and
+ * eviewitf_refresh_attributes must be called again, its result telling whether it succeeded.
  */
 eviewitf_ret_t eviewitf_pipeline_configure(uint8_t pipeline_id, uint32_t frame_width, uint32_t frame_height);
 
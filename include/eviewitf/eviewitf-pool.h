@@ -0,0 +1,108 @@
+/**
+ * @file eviewitf-pool.h
+ * @brief Header for eViewItf API regarding frame buffer pools
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup pool
+ *
+ * Preallocated frame buffers, reused without any allocation once the pool is created
+ *
+ * @addtogroup pool
+ * @{
+ */
+
+#ifndef EVIEWITF_POOL_H
+#define EVIEWITF_POOL_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_POOL_MAX_BUFFERS
+ * @brief Max number of buffers in a pool
+ */
+#define EVIEWITF_POOL_MAX_BUFFERS 64
+
+/**
+ * @def EVIEWITF_POOL_HUGE_PAGES
+ * @brief Pool flag: back the buffers with huge pages when the system provides some, regular pages otherwise
+ */
+#define EVIEWITF_POOL_HUGE_PAGES (1 << 0)
+
+/**
+ * @brief Frame buffer pool, opaque to the customer application
+ */
+typedef struct eviewitf_pool eviewitf_pool_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_pool_create(eviewitf_pool_t** pool, uint32_t buffer_size, int nb_buffers,
+ *                                        uint32_t flags)
+ * @brief Create a pool of frame buffers
+ *
+ * @param[out] pool created pool
+ * @param[in] buffer_size size of each buffer, usually the buffer size of a device given by its attributes
+ * @param[in] nb_buffers number of buffers between 1 and EVIEWITF_POOL_MAX_BUFFERS
+ * @param[in] flags 0 or EVIEWITF_POOL_HUGE_PAGES
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * All the buffers are allocated and their memory is touched at creation. Each buffer starts on a page boundary, and
+ * thus on a cache line boundary.
+ */
+eviewitf_ret_t eviewitf_pool_create(eviewitf_pool_t** pool, uint32_t buffer_size, int nb_buffers, uint32_t flags);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_pool_destroy(eviewitf_pool_t* pool)
+ * @brief Destroy a pool of frame buffers
+ *
+ * @param[in] pool pool
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * EVIEWITF_BLOCKED is returned, and the pool is kept, if some buffers have not been released.
+ */
+eviewitf_ret_t eviewitf_pool_destroy(eviewitf_pool_t* pool);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_pool_acquire(eviewitf_pool_t* pool, uint8_t** buffer)
+ * @brief Take a free buffer from a pool
+ *
+ * @param[in] pool pool
+ * @param[out] buffer buffer, holding one reference
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * EVIEWITF_BLOCKED is returned if all the buffers are in use.
+ */
+eviewitf_ret_t eviewitf_pool_acquire(eviewitf_pool_t* pool, uint8_t** buffer);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_pool_ref(eviewitf_pool_t* pool, uint8_t* buffer)
+ * @brief Add a reference on a buffer in use, for instance to share it with another thread
+ *
+ * @param[in] pool pool
+ * @param[in] buffer buffer returned by eviewitf_pool_acquire
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_pool_ref(eviewitf_pool_t* pool, uint8_t* buffer);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_pool_release(eviewitf_pool_t* pool, uint8_t* buffer)
+ * @brief Drop a reference on a buffer
+ *
+ * @param[in] pool pool
+ * @param[in] buffer buffer returned by eviewitf_pool_acquire
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The buffer goes back to the pool once its last reference is dropped, it must not be accessed anymore.
+ */
+eviewitf_ret_t eviewitf_pool_release(eviewitf_pool_t* pool, uint8_t* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_POOL_H */
+
+/*! \} */
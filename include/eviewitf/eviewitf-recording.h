@@ -0,0 +1,155 @@
+/**
+ * @file eviewitf-recording.h
+ * @brief Header for eViewItf API regarding recording files
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup recording
+ *
+ * Single file container storing the frames of a camera along with an index to access them
+ *
+ * @addtogroup recording
+ * @{
+ */
+
+#ifndef EVIEWITF_RECORDING_H
+#define EVIEWITF_RECORDING_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_RECORDING_FILENAME
+ * @brief Name of the recording file in a recording directory
+ */
+#define EVIEWITF_RECORDING_FILENAME "recording.evr"
+
+/**
+ * @brief Recording file, opaque to the customer application
+ */
+typedef struct eviewitf_recording eviewitf_recording_t;
+
+/**
+ * @brief Index entry of a recorded frame, as stored in the file
+ */
+typedef struct eviewitf_recording_frame_info {
+    uint64_t offset;     /*!< Offset of the frame in the file (bytes) */
+    uint64_t timestamp;  /*!< R7 timestamp of the frame, 0 if the frame had no metadata */
+    uint32_t size;       /*!< Size of the frame (bytes) */
+    uint32_t frame_sync; /*!< frame_sync metadata of the frame, 0 if the frame had no metadata */
+} eviewitf_recording_frame_info_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_create(eviewitf_recording_t** recording, const char* path,
+ *                                             const eviewitf_device_attributes_t* attributes)
+ * @brief Create a recording file to write frames in
+ *
+ * @param[out] recording created recording
+ * @param[in] path path of the file, an existing file is overwritten
+ * @param[in] attributes attributes of the recorded device, stored in the file header
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frames are appended to the file, the index is written at its end when the recording is closed. Each frame is
+ * preceded by a record of its index entry, so that a recording that has not been closed, e.g. interrupted, can still
+ * be opened: its index is then rebuilt from the records, up to the last complete frame.
+ */
+eviewitf_ret_t eviewitf_recording_create(eviewitf_recording_t** recording, const char* path,
+                                         const eviewitf_device_attributes_t* attributes);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_write_frame(eviewitf_recording_t* recording, const uint8_t* frame,
+ *                                                  uint32_t size, const eviewitf_frame_metadata_info_t* metadata)
+ * @brief Append a frame to a recording
+ *
+ * @param[in] recording recording created through eviewitf_recording_create
+ * @param[in] frame frame
+ * @param[in] size size of the frame
+ * @param[in] metadata metadata of the frame, giving its timestamp and frame_sync, may be NULL
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_recording_write_frame(eviewitf_recording_t* recording, const uint8_t* frame, uint32_t size,
+                                              const eviewitf_frame_metadata_info_t* metadata);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_open(eviewitf_recording_t** recording, const char* path)
+ * @brief Open a recording file to read its frames
+ *
+ * @param[out] recording opened recording
+ * @param[in] path path of the file
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The whole index is loaded, so that any frame can then be read with a single system call. The index of a recording
+ * that has not been closed is rebuilt by reading the record of each frame.
+ */
+eviewitf_ret_t eviewitf_recording_open(eviewitf_recording_t** recording, const char* path);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_close(eviewitf_recording_t* recording)
+ * @brief Close a recording, writing its index and header if it has been created for writing
+ *
+ * @param[in] recording recording
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_recording_close(eviewitf_recording_t* recording);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_get_attributes(eviewitf_recording_t* recording,
+ *                                                     eviewitf_device_attributes_t* attributes)
+ * @brief Get the attributes of the recorded device
+ *
+ * @param[in] recording recording
+ * @param[out] attributes attributes stored in the file header
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_recording_get_attributes(eviewitf_recording_t* recording,
+                                                 eviewitf_device_attributes_t* attributes);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_get_nb_frames(eviewitf_recording_t* recording, uint32_t* nb_frames)
+ * @brief Get the number of frames of a recording
+ *
+ * @param[in] recording recording
+ * @param[out] nb_frames number of frames
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_recording_get_nb_frames(eviewitf_recording_t* recording, uint32_t* nb_frames);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_get_frame_info(eviewitf_recording_t* recording, uint32_t index,
+ *                                                     eviewitf_recording_frame_info_t* info)
+ * @brief Get the index entry of a frame
+ *
+ * @param[in] recording recording
+ * @param[in] index frame number, between 0 and the number of frames
+ * @param[out] info index entry of the frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_recording_get_frame_info(eviewitf_recording_t* recording, uint32_t index,
+                                                 eviewitf_recording_frame_info_t* info);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_recording_read_frame(eviewitf_recording_t* recording, uint32_t index, uint8_t* buffer,
+ *                                                 uint32_t size)
+ * @brief Read a frame of a recording
+ *
+ * @param[in] recording recording opened through eviewitf_recording_open
+ * @param[in] index frame number, between 0 and the number of frames
+ * @param[out] buffer buffer to store the frame
+ * @param[in] size size of buffer, the frame is truncated if it is bigger
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frames can be read in any order, and from several threads at once.
+ */
+eviewitf_ret_t eviewitf_recording_read_frame(eviewitf_recording_t* recording, uint32_t index, uint8_t* buffer,
+                                             uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_RECORDING_H */
+
+/*! \} */
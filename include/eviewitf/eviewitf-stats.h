@@ -0,0 +1,166 @@
+/**
+ * @file eviewitf-stats.h
+ * @brief Header for eViewItf API regarding requests statistics
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup stats
+ *
+ * Communication API between A53 and R7 CPUs to get statistics about the requests sent to eView
+ *
+ * @addtogroup stats
+ * @{
+ */
+
+#ifndef EVIEWITF_STATS_H
+#define EVIEWITF_STATS_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+#include "eviewitf-camera.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_STATS_MAX_COMMANDS
+ * @brief Max number of commands per device type
+ */
+#define EVIEWITF_STATS_MAX_COMMANDS 256
+
+/**
+ * @def EVIEWITF_STATS_HISTOGRAM_BUCKETS
+ * @brief Number of buckets of the latency histograms
+ *
+ * Bucket 0 counts the requests lasting less than 1 us, bucket i counts the requests lasting from 2^(i-1) us to
+ * 2^i us excluded, the last bucket also counts all the longer requests.
+ */
+#define EVIEWITF_STATS_HISTOGRAM_BUCKETS 24
+
+/**
+ * @brief Device types the statistics are kept for
+ */
+typedef enum eviewitf_stats_devtype {
+    EVIEWITF_STATS_DEVTYPE_CAMERA,     /*!< Camera I/O requests */
+    EVIEWITF_STATS_DEVTYPE_PIPELINE,   /*!< Pipeline I/O requests */
+    EVIEWITF_STATS_DEVTYPE_SERIALIZER, /*!< Serializer I/O requests */
+    EVIEWITF_STATS_DEVTYPE_VIDEO,      /*!< Video I/O requests */
+    EVIEWITF_STATS_DEVTYPE_FUNCTION,   /*!< Function requests (init, display, blending...) */
+    EVIEWITF_STATS_DEVTYPE_MAX,        /*!< Number of device types */
+} eviewitf_stats_devtype_t;
+
+/**
+ * @brief Statistics of a command
+ */
+typedef struct eviewitf_stats_entry {
+    uint64_t nb_requests;                                 /*!< Number of requests */
+    uint64_t nb_blocked;                                  /*!< Number of requests answered EVIEWITF_BLOCKED */
+    uint64_t nb_invalid;                                  /*!< Number of requests answered EVIEWITF_INVALID_PARAM */
+    uint64_t nb_failed;                                   /*!< Number of failed requests */
+    uint64_t total_ns;                                    /*!< Cumulated duration of the requests (ns) */
+    uint64_t max_ns;                                      /*!< Duration of the longest request (ns) */
+    uint64_t histogram[EVIEWITF_STATS_HISTOGRAM_BUCKETS]; /*!< Latency histogram */
+} eviewitf_stats_entry_t;
+
+/**
+ * @brief Latency distribution of the frames of a camera
+ */
+typedef struct eviewitf_stats_latency_entry {
+    uint64_t nb_frames;                                   /*!< Number of frames measured */
+    uint64_t total_ns;                                    /*!< Cumulated latency (ns) */
+    uint64_t max_ns;                                      /*!< Highest latency (ns) */
+    uint64_t histogram[EVIEWITF_STATS_HISTOGRAM_BUCKETS]; /*!< Latency histogram */
+} eviewitf_stats_latency_entry_t;
+
+/**
+ * @brief Latencies of the frames read from a camera
+ */
+typedef struct eviewitf_stats_latency {
+    /** From the R7 frame timestamp to the end of the frame read, beyond the lowest transfer delay */
+    eviewitf_stats_latency_entry_t sensor_to_user;
+    /** From the wake-up of a poll reporting a new frame to the end of the next frame read */
+    eviewitf_stats_latency_entry_t wake_to_data;
+} eviewitf_stats_latency_t;
+
+/**
+ * @brief Sequence counters of the frames read from a camera
+ */
+typedef struct eviewitf_stats_frames {
+    uint64_t nb_frames;     /*!< Number of frames read with a timestamp */
+    uint64_t nb_dropped;    /*!< Number of frames missed between two reads */
+    uint64_t nb_duplicated; /*!< Number of frames read again, or older than the previous one */
+    uint64_t jitter_ns;     /*!< Cumulated distance of the frames to the expected frame period (ns) */
+    uint64_t max_jitter_ns; /*!< Highest distance of a frame to the expected frame period (ns) */
+} eviewitf_stats_frames_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_stats_get(eviewitf_stats_devtype_t devtype, uint8_t cmd, eviewitf_stats_entry_t* entry)
+ * @brief Get the statistics of a command
+ *
+ * @param[in] devtype device type
+ * @param[in] cmd command number: I/O command number for I/O requests, function identifier for function requests
+ * @param[out] entry statistics of the command
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Statistics are shared by all the processes using eViewItf on the board that run as the same user or group, through a
+ * shared memory. A process that cannot use it, or that finds one created by another version of eViewItf, keeps its
+ * own statistics. The values are read one by one while requests may be in progress, so they can be slightly
+ * inconsistent with each other.
+ */
+eviewitf_ret_t eviewitf_stats_get(eviewitf_stats_devtype_t devtype, uint8_t cmd, eviewitf_stats_entry_t* entry);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_stats_get_latency(int cam_id, eviewitf_stats_latency_t* latency)
+ * @brief Get the latencies of the frames read from a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] latency latencies of the frames
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Frames copied through eviewitf_camera_get_frame or eviewitf_camera_get_frame_with_metadata are measured, frames
+ * without metadata only for the wake-up to data latency. eviewitf_camera_get_frame only looks for the metadata of
+ * whole frames, once eviewitf_camera_get_frame_with_metadata has read valid ones. The sensor to user latency relies on
+ * eviewitf_timestamp_to_monotonic, whose conversion includes the lowest transfer delay: it tells how much each frame
+ * was delayed by the R7 pipeline, the driver or the customer application, not the absolute exposure to user delay.
+ * Latencies are shared by all the processes using eViewItf on the board, like the requests statistics.
+ */
+eviewitf_ret_t eviewitf_stats_get_latency(int cam_id, eviewitf_stats_latency_t* latency);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_stats_get_frames(int cam_id, eviewitf_stats_frames_t* frames)
+ * @brief Get the sequence counters of the frames read from a camera
+ *
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param[out] frames sequence counters
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frames read by a process through eviewitf_camera_get_frame or eviewitf_camera_get_frame_with_metadata are
+ * compared to the previous one it read from the same camera: the time between their timestamps, against the period of
+ * the configured frame rate, tells how many frames were missed. Frames without metadata are not counted. Drops and
+ * jitter are only counted while the camera frame rate can be read. The frame rate is read again every second and when
+ * the attributes are refreshed, to follow the changes made by other processes. It is read by the asynchronous worker
+ * thread, which keeps the frame reads free of requests to eView, and uses one of the EVIEWITF_ASYNC_MAX_REQUESTS
+ * slots meanwhile.
+ * Counters are shared by all the processes using eViewItf on the board, like the requests statistics, but the sequence
+ * is tracked per process: each process compares the frames it reads to its own previous one, so the frames of a camera
+ * read by several processes are counted once per process.
+ */
+eviewitf_ret_t eviewitf_stats_get_frames(int cam_id, eviewitf_stats_frames_t* frames);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_stats_reset(void)
+ * @brief Reset the statistics of all the commands, and the latencies and sequence counters of all the cameras
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frame sequence of the calling process restarts with the next frame read, other processes keep theirs.
+ */
+eviewitf_ret_t eviewitf_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_STATS_H */
+
+/*! \} */
@@ -39,6 +39,18 @@ extern "C" {
  */
 eviewitf_ret_t eviewitf_streamer_open(int streamer_id);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_streamer_open(eviewitf_ctx_t* ctx, int streamer_id)
+ * @brief Open a streamer device in a context
+ *
+ * @param[in] ctx context the streamer is opened in
+ * @param[in] streamer_id id of the streamer between 0 and EVIEWITF_MAX_STREAMER
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * Same as eviewitf_streamer_open, the streamer being only seen as opened by the functions given the same context.
+ */
+eviewitf_ret_t eviewitf_ctx_streamer_open(eviewitf_ctx_t* ctx, int streamer_id);
+
 /**
  * @fn eviewitf_ret_t eviewitf_streamer_close(int streamer_id)
  * @brief Close a streamer device
@@ -50,6 +62,16 @@ eviewitf_ret_t eviewitf_streamer_open(int streamer_id);
  */
 eviewitf_ret_t eviewitf_streamer_close(int streamer_id);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_streamer_close(eviewitf_ctx_t* ctx, int streamer_id)
+ * @brief Close a streamer device opened in a context
+ *
+ * @param[in] ctx context the streamer is opened in
+ * @param[in] streamer_id id of the streamer between 0 and EVIEWITF_MAX_STREAMER
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_streamer_close(eviewitf_ctx_t* ctx, int streamer_id);
+
 /**
  * @fn eviewitf_ret_t eviewitf_streamer_get_attributes(int streamer_id, eviewitf_device_attributes_t* attributes)
  * @brief Get the attributes of a streamer such as buffer size
@@ -78,6 +100,20 @@ eviewitf_ret_t eviewitf_streamer_get_attributes(int streamer_id, eviewitf_device
  */
 eviewitf_ret_t eviewitf_streamer_write_frame(int streamer_id, uint8_t* frame_buffer, uint32_t buffer_size);
 
+/**
+ * @fn eviewitf_ret_t eviewitf_ctx_streamer_write_frame(eviewitf_ctx_t* ctx, int streamer_id, uint8_t* frame_buffer,
+ *                                                     uint32_t buffer_size)
+ * @brief Write a frame to a streamer opened in a context
+ *
+ * @param[in] ctx context the streamer is opened in
+ * @param[in] streamer_id id of the streamer between 0 and EVIEWITF_MAX_STREAMER
+ * @param[in] frame_buffer streamer buffer
+ * @param[in] buffer_size size of the streamer buffer
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_streamer_write_frame(eviewitf_ctx_t* ctx, int streamer_id, uint8_t* frame_buffer,
+                                                 uint32_t buffer_size);
+
 #ifdef __cplusplus
 }
 #endif
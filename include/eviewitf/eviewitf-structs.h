@@ -28,6 +28,7 @@ typedef enum eviewitf_ret {
     EVIEWITF_NOT_OPENED = -4,          /*!< The targeted device is not opened */
     EVIEWITF_FAIL = -5,                /*!< Something has failed during the function call */
     EVIEWITF_ALREADY_INITIALIZED = -6, /*!< The API is already initialized */
+    EVIEWITF_TOO_MANY_HELD = -7,       /*!< Too many frames are held by the customer application, release one first */
 } eviewitf_ret_t;
 
 /**
@@ -50,8 +51,8 @@ typedef struct eviewitf_frame_metadata_info {
     uint32_t frame_width;         /*!< The frame width (in pixels) */
     uint32_t frame_height;        /*!< The frame height (in pixels) */
     uint32_t frame_bpp;           /*!< The number of bytes per pixels */
-    uint32_t frame_timestamp_lsb; /*!< The timestamp (LSB). */
-    uint32_t frame_timestamp_msb; /*!< The timestamp (MSB). */
+    uint32_t frame_timestamp_lsb; /*!< The timestamp (LSB), in ns of the R7 clock. */
+    uint32_t frame_timestamp_msb; /*!< The timestamp (MSB), in ns of the R7 clock. */
     uint32_t frame_sync;          /*!< A frame synchronization flag */
     eviewitf_frame_segment_info_t segments[4]
         __attribute__((aligned(4))); /*!< Frame segments offset with a maximum of 4 segments */
@@ -60,6 +61,43 @@ typedef struct eviewitf_frame_metadata_info {
     uint32_t magic_number;           /*!< A memory pattern which marks the end of the metadata (magic number) */
 } eviewitf_frame_metadata_info_t;
 
+/**
+ * @brief Max number of planes of a frame, one per metadata segment
+ */
+#define EVIEWITF_FRAME_MAX_PLANES 4
+
+/**
+ * @brief Plane of a frame, pointing into the frame buffer
+ */
+typedef struct eviewitf_frame_plane {
+    const uint8_t *data; /*!< First byte of the plane */
+    uint32_t size;       /*!< The plane size (in bytes) */
+    uint32_t stride;     /*!< Distance between the start of two rows (in bytes) */
+    uint32_t width;      /*!< The plane width (in pixels of the frame) */
+    uint32_t height;     /*!< The number of rows */
+    uint8_t dt;          /*!< The plane data type */
+} eviewitf_frame_plane_t;
+
+/**
+ * @brief Planes of a frame described by its metadata segments
+ *
+ * The view points into the frame buffer, which must stay valid as long as the view is used.
+ * The first plane covers frame_height rows. A smaller plane is a chroma plane, with the same stride and width when there
+ * are two planes (semi-planar, e.g. NV12 or NV16), half of them when there are more (planar, e.g. I420, YV12 or I422).
+ */
+typedef struct eviewitf_frame_view {
+    const uint8_t *buffer;                                    /*!< Frame buffer */
+    eviewitf_frame_metadata_info_t metadata;                  /*!< Frame metadata */
+    int nb_planes;                                            /*!< Number of planes */
+    eviewitf_frame_plane_t planes[EVIEWITF_FRAME_MAX_PLANES]; /*!< Planes, in the frame buffer order */
+} eviewitf_frame_view_t;
+
+/**
+ * @brief Iterate over the planes of a frame view
+ */
+#define EVIEWITF_FRAME_VIEW_FOREACH_PLANE(view, plane) \
+    for ((plane) = (view)->planes; (plane) < (view)->planes + (view)->nb_planes; (plane)++)
+
 /**
  * @brief Structure to get a device (camera, streamer or blender) attributes
  *
@@ -76,6 +114,11 @@ typedef struct eviewitf_device_attributes {
     uint16_t dt;          /*!< The data type (Y only, YUV, RGB…) */
 } eviewitf_device_attributes_t;
 
+/**
+ * @brief Library context owning its own device handles, opaque to the customer application
+ */
+typedef struct eviewitf_ctx eviewitf_ctx_t;
+
 /**
  * @brief eViewItf frame format supported about plot features.
  */
@@ -0,0 +1,135 @@
+/**
+ * @file eviewitf-sync.h
+ * @brief Header for eViewItf API regarding synchronized frame sets
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup sync
+ *
+ * Communication API between A53 and R7 CPUs to get matching frames of several cameras
+ *
+ * @addtogroup sync
+ * @{
+ */
+
+#ifndef EVIEWITF_SYNC_H
+#define EVIEWITF_SYNC_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+#include "eviewitf-camera.h"
+#include "eviewitf-capture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_SYNC_MAX_PENDING
+ * @brief Max number of frames of a camera waiting to be matched
+ */
+#define EVIEWITF_SYNC_MAX_PENDING 4
+
+/**
+ * @brief How the frames of the cameras are matched
+ */
+typedef enum eviewitf_sync_mode {
+    EVIEWITF_SYNC_BY_FRAME_SYNC, /*!< Frames with the same frame_sync metadata value */
+    EVIEWITF_SYNC_BY_TIMESTAMP,  /*!< Frames whose timestamps differ by less than a tolerance */
+} eviewitf_sync_mode_t;
+
+/**
+ * @brief Synchronization group, opaque to the customer application
+ */
+typedef struct eviewitf_sync_group eviewitf_sync_group_t;
+
+/**
+ * @brief Set of matching frames
+ */
+typedef struct eviewitf_sync_set {
+    uint8_t complete;                                     /*!< A frame of every camera of the group is present */
+    int nb_frames;                                        /*!< Number of present frames */
+    uint8_t present[EVIEWITF_MAX_CAMERA];                 /*!< Frame present, per camera index in the group */
+    eviewitf_capture_frame_t frames[EVIEWITF_MAX_CAMERA]; /*!< Frames, per camera index in the group */
+} eviewitf_sync_set_t;
+
+/**
+ * @brief Synchronization counters of a group
+ */
+typedef struct eviewitf_sync_stats {
+    uint64_t nb_complete; /*!< Number of complete sets delivered */
+    uint64_t nb_partial;  /*!< Number of partial sets delivered */
+    uint64_t nb_late;     /*!< Number of frames dropped because they arrived too late to match any set */
+} eviewitf_sync_stats_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_sync_create(eviewitf_sync_group_t** group, const int* cam_id, int nb_cam,
+ *                                        eviewitf_sync_mode_t mode, uint64_t tolerance, int64_t ns_set_timeout)
+ * @brief Create a synchronization group
+ *
+ * @param[out] group created group
+ * @param[in] cam_id table of camera ids (id between 0 and EVIEWITF_MAX_CAMERA)
+ * @param[in] nb_cam number of cameras, between 1 and EVIEWITF_MAX_CAMERA
+ * @param[in] mode how the frames are matched
+ * @param[in] tolerance max timestamp difference between frames of a set, in timestamp unit, unused by frame_sync
+ * @param[in] ns_set_timeout delay to wait for the missing frames of a set before delivering it partial, in ns
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The frames are taken from the background capture of the cameras, which must be started through
+ * eviewitf_capture_start, and must not be taken by anyone else.
+ */
+eviewitf_ret_t eviewitf_sync_create(eviewitf_sync_group_t** group, const int* cam_id, int nb_cam,
+                                    eviewitf_sync_mode_t mode, uint64_t tolerance, int64_t ns_set_timeout);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_sync_destroy(eviewitf_sync_group_t* group)
+ * @brief Destroy a synchronization group, the frames waiting to be matched are released
+ *
+ * @param[in] group group
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_sync_destroy(eviewitf_sync_group_t* group);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_sync_get_set(eviewitf_sync_group_t* group, int64_t ns_timeout, eviewitf_sync_set_t* set)
+ * @brief Get the next set of matching frames
+ *
+ * @param[in] group group
+ * @param[in] ns_timeout delay the function should block waiting for a set in ns, negative value means infinite
+ * @param[out] set set of frames
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * A set is delivered partial when frames of some cameras are still missing ns_set_timeout after its oldest frame was
+ * captured. EVIEWITF_BLOCKED is returned on timeout. EVIEWITF_TOO_MANY_HELD is returned when a missing frame cannot be
+ * taken because EVIEWITF_CAPTURE_MAX_HELD_FRAMES frames of its camera are already held, by the sets not released yet
+ * for instance: a set must be released before trying again.
+ * The set must be given back through eviewitf_sync_release_set. A group must be used by a single thread at a time.
+ */
+eviewitf_ret_t eviewitf_sync_get_set(eviewitf_sync_group_t* group, int64_t ns_timeout, eviewitf_sync_set_t* set);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_sync_release_set(eviewitf_sync_group_t* group, eviewitf_sync_set_t* set)
+ * @brief Give back the frames of a set
+ *
+ * @param[in] group group
+ * @param[in] set set obtained through eviewitf_sync_get_set
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_sync_release_set(eviewitf_sync_group_t* group, eviewitf_sync_set_t* set);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_sync_get_stats(eviewitf_sync_group_t* group, eviewitf_sync_stats_t* stats)
+ * @brief Get the synchronization counters of a group
+ *
+ * @param[in] group group
+ * @param[out] stats synchronization counters since the group was created
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_sync_get_stats(eviewitf_sync_group_t* group, eviewitf_sync_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_SYNC_H */
+
+/*! \} */
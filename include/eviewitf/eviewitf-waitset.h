@@ -0,0 +1,146 @@
+/**
+ * @file eviewitf-waitset.h
+ * @brief Header for eViewItf API regarding wait sets
+ * @author LACROIX Impulse
+ * @copyright Copyright (c) 2019-2022 LACROIX Impulse
+ * @ingroup waitset
+ *
+ * Communication API between A53 and R7 CPUs to wait for events on several devices and file descriptors
+ *
+ * @addtogroup waitset
+ * @{
+ */
+
+#ifndef EVIEWITF_WAITSET_H
+#define EVIEWITF_WAITSET_H
+
+#include <stdint.h>
+#include "eviewitf-structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def EVIEWITF_WAITSET_MAX_ENTRIES
+ * @brief Max number of devices and file descriptors registered in a wait set
+ */
+#define EVIEWITF_WAITSET_MAX_ENTRIES 64
+
+/**
+ * @def EVIEWITF_WAITSET_EDGE_TRIGGERED
+ * @brief Wait set flag: an event is reported once when it occurs, instead of as long as the condition holds
+ */
+#define EVIEWITF_WAITSET_EDGE_TRIGGERED (1 << 0)
+
+/**
+ * @brief Wait set, opaque to the customer application
+ */
+typedef struct eviewitf_waitset eviewitf_waitset_t;
+
+/**
+ * @brief Source of a wait set event
+ */
+typedef enum eviewitf_waitset_source {
+    EVIEWITF_WAITSET_SOURCE_CAMERA, /*!< Camera, a new frame is available */
+    EVIEWITF_WAITSET_SOURCE_FD,     /*!< File descriptor registered by the customer application */
+} eviewitf_waitset_source_t;
+
+/**
+ * @brief Wait set event
+ */
+typedef struct eviewitf_waitset_event {
+    eviewitf_waitset_source_t source; /*!< Source of the event */
+    int id;                           /*!< Camera id or file descriptor */
+    uint32_t events;                  /*!< Detected events, as poll() events (POLLIN, POLLOUT, POLLERR...) */
+    void* user_ctx;                   /*!< User context given when the file descriptor was added, NULL for cameras */
+} eviewitf_waitset_event_t;
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_create(eviewitf_waitset_t** waitset, uint32_t flags)
+ * @brief Create a wait set
+ *
+ * @param[out] waitset created wait set
+ * @param[in] flags 0 or EVIEWITF_WAITSET_EDGE_TRIGGERED
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_waitset_create(eviewitf_waitset_t** waitset, uint32_t flags);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_destroy(eviewitf_waitset_t* waitset)
+ * @brief Destroy a wait set
+ *
+ * @param[in] waitset wait set
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The registered devices and file descriptors are not closed.
+ */
+eviewitf_ret_t eviewitf_waitset_destroy(eviewitf_waitset_t* waitset);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_add_camera(eviewitf_waitset_t* waitset, int cam_id)
+ * @brief Register a camera in a wait set
+ *
+ * @param[in] waitset wait set
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The camera must be opened. It is removed from the wait set when it is closed, and must be registered again once
+ * reopened.
+ */
+eviewitf_ret_t eviewitf_waitset_add_camera(eviewitf_waitset_t* waitset, int cam_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_remove_camera(eviewitf_waitset_t* waitset, int cam_id)
+ * @brief Remove a camera from a wait set
+ *
+ * @param[in] waitset wait set
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_waitset_remove_camera(eviewitf_waitset_t* waitset, int cam_id);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_add_fd(eviewitf_waitset_t* waitset, int fd, uint32_t events, void* user_ctx)
+ * @brief Register a file descriptor of the customer application in a wait set
+ *
+ * @param[in] waitset wait set
+ * @param[in] fd file descriptor
+ * @param[in] events events to wait for, as poll() events (POLLIN, POLLOUT...)
+ * @param[in] user_ctx user context given back in the events
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_waitset_add_fd(eviewitf_waitset_t* waitset, int fd, uint32_t events, void* user_ctx);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_remove_fd(eviewitf_waitset_t* waitset, int fd)
+ * @brief Remove a file descriptor from a wait set
+ *
+ * @param[in] waitset wait set
+ * @param[in] fd file descriptor
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_waitset_remove_fd(eviewitf_waitset_t* waitset, int fd);
+
+/**
+ * @fn eviewitf_ret_t eviewitf_waitset_wait(eviewitf_waitset_t* waitset, int64_t ns_timeout,
+ *                                         eviewitf_waitset_event_t* events, int max_events, int* nb_events)
+ * @brief Wait for events on the devices and file descriptors of a wait set
+ *
+ * @param[in] waitset wait set
+ * @param[in] ns_timeout delay the function should block waiting for an event in ns, negative value means infinite
+ * @param[out] events table of detected events, only the ready cameras and file descriptors are reported
+ * @param[in] max_events size of the events table
+ * @param[out] nb_events number of detected events, 0 on timeout
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_waitset_wait(eviewitf_waitset_t* waitset, int64_t ns_timeout, eviewitf_waitset_event_t* events,
+                                     int max_events, int* nb_events);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVIEWITF_WAITSET_H */
+
+/*! \} */
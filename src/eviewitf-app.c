@@ -34,15 +34,16 @@
  ******************************************************************************************/
 
 /**
- * @fn eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, char *record_path)
+ * @fn eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, int legacy, char *record_path)
  * @brief Request R7 to change camera used on display
  *
  * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
  * @param delay: duration of the record in seconds
+ * @param legacy: record one file per frame instead of a recording file
  * @param record_path: record path
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, char *record_path) {
+eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, int legacy, char *record_path) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     char *record_dir = NULL;
     eviewitf_device_attributes_t attributes;
@@ -60,7 +61,8 @@ eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, char *record_path)
         }
         printf("SSD storage directory %s \n", record_dir);
         eviewitf_camera_get_attributes(cam_id, &attributes);
-        ret = eviewitf_ssd_record_stream(cam_id, delay, record_dir, attributes.buffer_size);
+        ret = eviewitf_ssd_record_stream(cam_id, delay, record_dir, attributes.buffer_size,
+                                         legacy ? SSD_LAYOUT_LEGACY : SSD_LAYOUT_RECORDING);
         if (record_path == NULL) {
             free(record_dir);
         }
@@ -88,16 +90,17 @@ eviewitf_ret_t eviewitf_app_reset_camera(int cam_id) {
 }
 
 /**
- * @fn eviewitf_ret_t eviewitf_app_streamer_play(int streamer_id, int fps, char *frames_dir)
+ * @fn eviewitf_ret_t eviewitf_app_streamer_play(int streamer_id, int fps, int catch_up, char *frames_dir)
  * @brief Update the frames to be printed on a streamer
 
  * @param streamer_id: id of the streamer
  * @param fps: fps to apply on the recording
+ * @param catch_up: play the late frames instead of skipping them
  * @param frames_dir: path to the recording
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t eviewitf_app_streamer_play(int streamer_id, int fps, char *frames_dir) {
+eviewitf_ret_t eviewitf_app_streamer_play(int streamer_id, int fps, int catch_up, char *frames_dir) {
     eviewitf_ret_t ret = EVIEWITF_OK;
 
     /* Test API has been initialized */
@@ -115,7 +118,7 @@ eviewitf_ret_t eviewitf_app_streamer_play(int streamer_id, int fps, char *frames
     if (EVIEWITF_OK == ret) {
         ret = eviewitf_ssd_streamer_play(
             streamer_id, (get_device_object(streamer_id + EVIEWITF_OFFSET_STREAMER))->attributes.buffer_size, fps,
-            frames_dir);
+            catch_up ? SSD_LATE_CATCH_UP : SSD_LATE_SKIP, frames_dir);
     }
 
     return ret;
@@ -0,0 +1,330 @@
+/**
+ * @file eviewitf-async.c
+ * @brief Communication API between A53 and R7 CPUs for asynchronous requests
+ * @author LACROIX Impulse
+ *
+ * API to submit requests to the R7 CPU without waiting for its answers.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/eventfd.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Delay before submitting again commands answered EVIEWITF_BLOCKED (in ns)
+ */
+#define ASYNC_RETRY_DELAY_NS 1000000
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef async_request_t
+ * @brief Asynchronous request
+ *
+ * @struct async_request
+ * @brief Asynchronous request waiting to be submitted
+ */
+typedef struct async_request {
+    eviewitf_async_completion_t completion; /*!< Completion, filled in once the request is submitted */
+    eviewitf_async_callback_t callback;     /*!< Completion callback, can be NULL */
+} async_request_t;
+
+/**
+ * @typedef async_engine_t
+ * @brief Asynchronous requests engine
+ *
+ * @struct async_engine
+ * @brief Queues of pending requests and of completions waiting to be collected, and the worker thread
+ */
+typedef struct async_engine {
+    pthread_mutex_t mutex;                                                /*!< Protects the whole structure */
+    pthread_cond_t cond;                                                  /*!< Signaled when a request is queued */
+    pthread_t thread;                                                     /*!< Worker thread */
+    uint8_t started;                                                      /*!< Worker thread is running */
+    uint8_t stop;                                                         /*!< Worker thread must stop */
+    int event_fd;                                                         /*!< Completions notification, -1 if none */
+    uint32_t next_id;                                                     /*!< Identifier of the next request */
+    uint32_t nb_pending;                                                  /*!< Requests not completed or collected */
+    uint32_t req_head;                                                    /*!< Oldest queued request */
+    uint32_t req_count;                                                   /*!< Number of queued requests */
+    async_request_t requests[EVIEWITF_ASYNC_MAX_REQUESTS];                /*!< Queued requests */
+    uint32_t cpl_head;                                                    /*!< Oldest completion */
+    uint32_t cpl_count;                                                   /*!< Number of completions */
+    eviewitf_async_completion_t completions[EVIEWITF_ASYNC_MAX_REQUESTS]; /*!< Completions to collect */
+} async_engine_t;
+
+/******************************************************************************************
+ * Private enumerations
+ ******************************************************************************************/
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+/**
+ * @brief Asynchronous requests engine
+ */
+static async_engine_t async_engine = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .event_fd = -1,
+};
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static uint8_t async_is_blocked(eviewitf_batch_t *batch)
+ * @brief Check if a command of a submitted batch was answered EVIEWITF_BLOCKED
+ *
+ * @param batch: pointer on the submitted batch
+ * @return 1 if a command is blocked, 0 otherwise
+ */
+static uint8_t async_is_blocked(eviewitf_batch_t *batch) {
+    for (uint32_t i = 0; i < batch->nb_commands; i++) {
+        if (batch->commands[i].result == EVIEWITF_BLOCKED) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @fn static void async_execute(async_request_t *request)
+ * @brief Submit the batch of a request, retrying the commands answered EVIEWITF_BLOCKED
+ *
+ * @param request: pointer on the request
+ */
+static void async_execute(async_request_t *request) {
+    struct timespec delay = {.tv_sec = 0, .tv_nsec = ASYNC_RETRY_DELAY_NS};
+    eviewitf_ret_t ret;
+    int retries = 0;
+
+    ret = eviewitf_batch_submit(request->completion.batch);
+    while (async_is_blocked(request->completion.batch) && (retries < EVIEWITF_ASYNC_MAX_RETRIES)) {
+        nanosleep(&delay, NULL);
+        ret = batch_submit_blocked(request->completion.batch);
+        retries++;
+    }
+    request->completion.result = ret;
+}
+
+/**
+ * @fn static void async_complete(async_request_t *request)
+ * @brief Hand a completed request over to the customer application
+ *
+ * @param request: pointer on the completed request
+ */
+static void async_complete(async_request_t *request) {
+    uint64_t event = 1;
+    uint32_t index;
+
+    if (request->callback) {
+        request->callback(&request->completion);
+        pthread_mutex_lock(&async_engine.mutex);
+        async_engine.nb_pending--;
+        pthread_mutex_unlock(&async_engine.mutex);
+        return;
+    }
+
+    pthread_mutex_lock(&async_engine.mutex);
+    /* Cannot overflow, nb_pending bounds the number of completions */
+    index = (async_engine.cpl_head + async_engine.cpl_count) % EVIEWITF_ASYNC_MAX_REQUESTS;
+    async_engine.completions[index] = request->completion;
+    async_engine.cpl_count++;
+    if (write(async_engine.event_fd, &event, sizeof(event)) < 0) {
+        fprintf(stderr, "%s() cannot notify completion : %s\n", __FUNCTION__, strerror(errno));
+    }
+    pthread_mutex_unlock(&async_engine.mutex);
+}
+
+/**
+ * @fn static void *async_worker(void *arg)
+ * @brief Worker thread submitting the queued requests
+ *
+ * Queued requests are all submitted before the thread stops.
+ *
+ * @param arg: unused
+ * @return NULL
+ */
+static void *async_worker(void *arg) {
+    async_request_t request;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&async_engine.mutex);
+        while ((async_engine.req_count == 0) && !async_engine.stop) {
+            pthread_cond_wait(&async_engine.cond, &async_engine.mutex);
+        }
+        if (async_engine.req_count == 0) {
+            pthread_mutex_unlock(&async_engine.mutex);
+            break;
+        }
+        request = async_engine.requests[async_engine.req_head];
+        async_engine.req_head = (async_engine.req_head + 1) % EVIEWITF_ASYNC_MAX_REQUESTS;
+        async_engine.req_count--;
+        pthread_mutex_unlock(&async_engine.mutex);
+
+        async_execute(&request);
+        async_complete(&request);
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static eviewitf_ret_t async_start(void)
+ * @brief Create the completions notification and start the worker thread if not already done
+ *
+ * The caller must hold the engine mutex.
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t async_start(void) {
+    int ret;
+
+    if (async_engine.started) {
+        return EVIEWITF_OK;
+    }
+
+    async_engine.event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (async_engine.event_fd < 0) {
+        fprintf(stderr, "%s() cannot create eventfd : %s\n", __FUNCTION__, strerror(errno));
+        return EVIEWITF_FAIL;
+    }
+
+    async_engine.stop = 0;
+    ret = pthread_create(&async_engine.thread, NULL, async_worker, NULL);
+    if (ret != 0) {
+        fprintf(stderr, "%s() cannot create worker thread : %s\n", __FUNCTION__, strerror(ret));
+        close(async_engine.event_fd);
+        async_engine.event_fd = -1;
+        return EVIEWITF_FAIL;
+    }
+    async_engine.started = 1;
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn void async_deinit(void)
+ * @brief Stop the worker thread once all the queued requests are submitted
+ *
+ * Completions not yet collected are dropped.
+ */
+void async_deinit(void) {
+    pthread_mutex_lock(&async_engine.mutex);
+    if (!async_engine.started) {
+        pthread_mutex_unlock(&async_engine.mutex);
+        return;
+    }
+    async_engine.stop = 1;
+    pthread_cond_signal(&async_engine.cond);
+    pthread_mutex_unlock(&async_engine.mutex);
+
+    pthread_join(async_engine.thread, NULL);
+
+    pthread_mutex_lock(&async_engine.mutex);
+    close(async_engine.event_fd);
+    async_engine.event_fd = -1;
+    async_engine.started = 0;
+    async_engine.nb_pending = 0;
+    async_engine.req_head = 0;
+    async_engine.req_count = 0;
+    async_engine.cpl_head = 0;
+    async_engine.cpl_count = 0;
+    pthread_mutex_unlock(&async_engine.mutex);
+}
+
+eviewitf_ret_t eviewitf_async_submit(eviewitf_batch_t *batch, eviewitf_async_callback_t callback, void *user_ctx,
+                                     uint32_t *request_id) {
+    eviewitf_ret_t ret;
+    async_request_t *request;
+    uint32_t index;
+
+    if (batch == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&async_engine.mutex);
+
+    ret = async_start();
+    if ((ret == EVIEWITF_OK) && (async_engine.nb_pending >= EVIEWITF_ASYNC_MAX_REQUESTS)) {
+        ret = EVIEWITF_BLOCKED;
+    }
+
+    if (ret == EVIEWITF_OK) {
+        index = (async_engine.req_head + async_engine.req_count) % EVIEWITF_ASYNC_MAX_REQUESTS;
+        request = &async_engine.requests[index];
+        request->completion.request_id = async_engine.next_id++;
+        request->completion.batch = batch;
+        request->completion.result = EVIEWITF_BLOCKED;
+        request->completion.user_ctx = user_ctx;
+        request->callback = callback;
+        async_engine.req_count++;
+        async_engine.nb_pending++;
+        if (request_id) *request_id = request->completion.request_id;
+        pthread_cond_signal(&async_engine.cond);
+    }
+
+    pthread_mutex_unlock(&async_engine.mutex);
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_async_get_fd(int *fd) {
+    eviewitf_ret_t ret;
+
+    if (fd == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&async_engine.mutex);
+    ret = async_start();
+    if (ret == EVIEWITF_OK) {
+        *fd = async_engine.event_fd;
+    }
+    pthread_mutex_unlock(&async_engine.mutex);
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_async_get_completion(eviewitf_async_completion_t *completion) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    uint64_t event;
+
+    if (completion == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&async_engine.mutex);
+    if (async_engine.cpl_count == 0) {
+        ret = EVIEWITF_BLOCKED;
+    } else {
+        *completion = async_engine.completions[async_engine.cpl_head];
+        async_engine.cpl_head = (async_engine.cpl_head + 1) % EVIEWITF_ASYNC_MAX_REQUESTS;
+        async_engine.cpl_count--;
+        async_engine.nb_pending--;
+
+        /* Clear the notification once every completion is collected, so that the fd stays readable until then */
+        if ((async_engine.cpl_count == 0) && (read(async_engine.event_fd, &event, sizeof(event)) < 0) &&
+            (errno != EAGAIN)) {
+            fprintf(stderr, "%s() cannot clear notification : %s\n", __FUNCTION__, strerror(errno));
+        }
+    }
+    pthread_mutex_unlock(&async_engine.mutex);
+
+    return ret;
+}
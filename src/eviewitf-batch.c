@@ -0,0 +1,375 @@
+/**
+ * @file eviewitf-batch.c
+ * @brief Communication API between A53 and R7 CPUs for batched requests
+ * @author LACROIX Impulse
+ *
+ * API to submit several device requests to the R7 CPU at once.
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "eviewitf-priv.h"
+#include "cam-ioctl.h"
+#include "video-ioctl.h"
+#include "pipeline-ioctl.h"
+#include "mfis-communication.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+
+/******************************************************************************************
+ * Private enumerations
+ ******************************************************************************************/
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static eviewitf_batch_command_t *batch_add_command(eviewitf_batch_t *batch, uint8_t devtype, uint8_t devid,
+ *                                                      uint16_t cmd, const void *param)
+ * @brief Append a command to a batch
+ *
+ * @param batch: pointer on the batch
+ * @param devtype: device type
+ * @param devid: device identifier
+ * @param cmd: I/O command
+ * @param param: I/O parameter, can be NULL
+ *
+ * @return pointer on the added command or NULL if the batch is full
+ */
+static eviewitf_batch_command_t *batch_add_command(eviewitf_batch_t *batch, uint8_t devtype, uint8_t devid,
+                                                   uint16_t cmd, const void *param) {
+    eviewitf_batch_command_t *command;
+
+    if ((batch == NULL) || (batch->nb_commands >= EVIEWITF_BATCH_MAX_COMMANDS)) {
+        return NULL;
+    }
+
+    command = &batch->commands[batch->nb_commands];
+    memset(command, 0, sizeof(eviewitf_batch_command_t));
+    command->devtype = devtype;
+    command->devid = devid;
+    command->cmd = cmd;
+    command->result = EVIEWITF_OK;
+    if ((param != NULL) && (MFIS_IOCSZ(cmd) > 0)) {
+        memcpy(command->param, param, MFIS_IOCSZ(cmd));
+    }
+    batch->nb_commands++;
+
+    return command;
+}
+
+/**
+ * @fn static void batch_store_outputs(eviewitf_batch_command_t *command)
+ * @brief Store the values read by a command where requested by the caller
+ *
+ * Commands added through eviewitf_batch_add have no output, their values are left in their param field.
+ *
+ * @param command: pointer on the submitted command
+ */
+static void batch_store_outputs(eviewitf_batch_command_t *command) {
+    cam_exp_t *exposure_value;
+    cam_pt_t *offset;
+
+    if ((command->result != EVIEWITF_OK) || (command->devtype != MFIS_DEV_CAM) || (command->output[0] == NULL)) {
+        return;
+    }
+
+    switch (command->cmd) {
+        case IOCGCAMEXP:
+            exposure_value = (cam_exp_t *)command->param;
+            *(uint32_t *)command->output[0] = exposure_value->exp_us;
+            *(uint32_t *)command->output[1] = exposure_value->gain_thou;
+            break;
+        case IOCGCAMRATE:
+            memcpy(command->output[0], command->param, sizeof(uint16_t));
+            break;
+        case IOCGCAMOFFSET:
+            offset = (cam_pt_t *)command->param;
+            *(uint32_t *)command->output[0] = (uint32_t)offset->x;
+            *(uint32_t *)command->output[1] = (uint32_t)offset->y;
+            break;
+        default:
+            break;
+    }
+}
+
+eviewitf_ret_t eviewitf_batch_reset(eviewitf_batch_t *batch) {
+    if (batch == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    batch->nb_commands = 0;
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static eviewitf_ret_t batch_submit_commands(eviewitf_batch_t *batch, uint8_t only_blocked)
+ * @brief Submit the commands of a batch
+ *
+ * @param batch: pointer on the batch
+ * @param only_blocked: if not 0, only the commands whose last result is EVIEWITF_BLOCKED are submitted
+ *
+ * @return EVIEWITF_OK if all the commands of the batch succeeded, otherwise the result of the first failed command
+ */
+static eviewitf_ret_t batch_submit_commands(eviewitf_batch_t *batch, uint8_t only_blocked) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    mfis_ioctl_desc_t requests[EVIEWITF_BATCH_MAX_COMMANDS];
+    uint32_t index[EVIEWITF_BATCH_MAX_COMMANDS];
+    int nb_requests = 0;
+    uint32_t i;
+
+    if ((batch == NULL) || (batch->nb_commands > EVIEWITF_BATCH_MAX_COMMANDS)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    for (i = 0; i < batch->nb_commands; i++) {
+        if (only_blocked && (batch->commands[i].result != EVIEWITF_BLOCKED)) {
+            continue;
+        }
+        requests[nb_requests].devtype = batch->commands[i].devtype;
+        requests[nb_requests].devid = batch->commands[i].devid;
+        requests[nb_requests].cmd = batch->commands[i].cmd;
+        requests[nb_requests].param = batch->commands[i].param;
+        requests[nb_requests].result = EVIEWITF_OK;
+        index[nb_requests] = i;
+        nb_requests++;
+    }
+
+    mfis_ioctl_batch_request(requests, nb_requests);
+
+    for (i = 0; i < (uint32_t)nb_requests; i++) {
+        batch->commands[index[i]].result = requests[i].result;
+        batch_store_outputs(&batch->commands[index[i]]);
+    }
+
+    /* Overall result, including the commands that were not submitted again */
+    for (i = 0; i < batch->nb_commands; i++) {
+        if (batch->commands[i].result != EVIEWITF_OK) {
+            ret = batch->commands[i].result;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @fn eviewitf_ret_t batch_submit_blocked(eviewitf_batch_t *batch)
+ * @brief Submit again the commands of a batch that were answered EVIEWITF_BLOCKED
+ *
+ * @param batch: pointer on an already submitted batch
+ *
+ * @return EVIEWITF_OK if all the commands of the batch succeeded, otherwise the result of the first failed command
+ */
+eviewitf_ret_t batch_submit_blocked(eviewitf_batch_t *batch) { return batch_submit_commands(batch, 1); }
+
+eviewitf_ret_t eviewitf_batch_submit(eviewitf_batch_t *batch) { return batch_submit_commands(batch, 0); }
+
+eviewitf_ret_t eviewitf_batch_get_result(eviewitf_batch_t *batch, uint32_t index, eviewitf_ret_t *result) {
+    if ((batch == NULL) || (result == NULL) || (index >= batch->nb_commands)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    *result = batch->commands[index].result;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_add(eviewitf_batch_t *batch, uint8_t devtype, uint8_t devid, uint16_t cmd,
+                                  const void *param) {
+    /* Test device type */
+    if (devtype > MFIS_DEV_VIDEO) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, devtype, devid, cmd, param) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_set_exposure(eviewitf_batch_t *batch, int cam_id, uint32_t exposure_us,
+                                                  uint32_t gain_thou) {
+    cam_exp_t exposure_value = {.exp_us = exposure_us, .gain_thou = gain_thou};
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCSCAMEXP, &exposure_value) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_set_digital_gains(eviewitf_batch_t *batch, int cam_id, uint16_t dg_cf00,
+                                                       uint16_t dg_cf01, uint16_t dg_cf10, uint16_t dg_cf11) {
+    cam_dg_t dg = {.cf00 = dg_cf00, .cf01 = dg_cf01, .cf10 = dg_cf10, .cf11 = dg_cf11};
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCSCAMDG, &dg) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_set_frame_rate(eviewitf_batch_t *batch, int cam_id, uint16_t fps) {
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCSCAMRATE, &fps) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_set_frame_offset(eviewitf_batch_t *batch, int cam_id, uint32_t x_offset,
+                                                      uint32_t y_offset) {
+    cam_pt_t offset = {.x = (int32_t)x_offset, .y = (int32_t)y_offset};
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCSCAMOFFSET, &offset) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_set_test_pattern(eviewitf_batch_t *batch, int cam_id, uint8_t pattern) {
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCSCAMTP, &pattern) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_get_exposure(eviewitf_batch_t *batch, int cam_id, uint32_t *exposure_us,
+                                                  uint32_t *gain_thou) {
+    eviewitf_batch_command_t *command;
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (exposure_us == NULL) || (gain_thou == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    command = batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCGCAMEXP, NULL);
+    if (command == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    command->output[0] = exposure_us;
+    command->output[1] = gain_thou;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_get_frame_rate(eviewitf_batch_t *batch, int cam_id, uint16_t *fps) {
+    eviewitf_batch_command_t *command;
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (fps == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    command = batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCGCAMRATE, NULL);
+    if (command == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    command->output[0] = fps;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_camera_get_frame_offset(eviewitf_batch_t *batch, int cam_id, uint32_t *x_offset,
+                                                      uint32_t *y_offset) {
+    eviewitf_batch_command_t *command;
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (x_offset == NULL) || (y_offset == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    command = batch_add_command(batch, MFIS_DEV_CAM, cam_id, IOCGCAMOFFSET, NULL);
+    if (command == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    command->output[0] = x_offset;
+    command->output[1] = y_offset;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_video_resume(eviewitf_batch_t *batch, int cam_id) {
+    uint32_t param = VIDEO_STATE_RUNNING;
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_VIDEO, cam_id, IOCSVIDSTATE, &param) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_video_suspend(eviewitf_batch_t *batch, int cam_id) {
+    uint32_t param = VIDEO_STATE_SUSPENDED;
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (batch_add_command(batch, MFIS_DEV_VIDEO, cam_id, IOCSVIDSTATE, &param) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_pipeline_configure(eviewitf_batch_t *batch, uint8_t pipeline_id, uint32_t frame_width,
+                                                 uint32_t frame_height) {
+    pipeline_geometry_t geometry = {.height = frame_height, .width = frame_width};
+
+    if (batch_add_command(batch, MFIS_DEV_PIPELINE, pipeline_id, IOCSPIPELINECONFIGURE, &geometry) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_pipeline_start(eviewitf_batch_t *batch, uint8_t pipeline_id) {
+    if (batch_add_command(batch, MFIS_DEV_PIPELINE, pipeline_id, IOCPIPELINESTART, NULL) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_batch_pipeline_stop(eviewitf_batch_t *batch, uint8_t pipeline_id) {
+    if (batch_add_command(batch, MFIS_DEV_PIPELINE, pipeline_id, IOCPIPELINESTOP, NULL) == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    return EVIEWITF_OK;
+}
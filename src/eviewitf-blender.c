@@ -64,13 +64,17 @@ int blender_open(int device_id) {
  * process at the same time.
  */
 eviewitf_ret_t eviewitf_blender_open(int blender_id) {
-    /* Test blender id */
-    if ((blender_id < 0) || (blender_id >= EVIEWITF_MAX_BLENDER)) {
+    return eviewitf_ctx_blender_open(device_default_ctx(), blender_id);
+}
+
+eviewitf_ret_t eviewitf_ctx_blender_open(eviewitf_ctx_t *ctx, int blender_id) {
+    /* Test context and blender id */
+    if ((ctx == NULL) || (blender_id < 0) || (blender_id >= EVIEWITF_MAX_BLENDER)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
     /* Open device */
-    return device_open(blender_id + EVIEWITF_OFFSET_BLENDER);
+    return device_open(ctx, blender_id + EVIEWITF_OFFSET_BLENDER);
 }
 
 /**
@@ -84,12 +88,16 @@ eviewitf_ret_t eviewitf_blender_open(int blender_id) {
  * A blender should be closed before to stop the process that opened it.
  */
 eviewitf_ret_t eviewitf_blender_close(int blender_id) {
-    /* Test blender id */
-    if ((blender_id < 0) || (blender_id >= EVIEWITF_MAX_BLENDER)) {
+    return eviewitf_ctx_blender_close(device_default_ctx(), blender_id);
+}
+
+eviewitf_ret_t eviewitf_ctx_blender_close(eviewitf_ctx_t *ctx, int blender_id) {
+    /* Test context and blender id */
+    if ((ctx == NULL) || (blender_id < 0) || (blender_id >= EVIEWITF_MAX_BLENDER)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    return device_close(blender_id + EVIEWITF_OFFSET_BLENDER);
+    return device_close(ctx, blender_id + EVIEWITF_OFFSET_BLENDER);
 }
 
 /**
@@ -127,10 +135,15 @@ eviewitf_ret_t eviewitf_blender_get_attributes(int blender_id, eviewitf_device_a
  * connected to the eCube through eviewitf_display_select_blender.
  */
 eviewitf_ret_t eviewitf_blender_write_frame(int blender_id, uint8_t *frame_buffer, uint32_t buffer_size) {
-    /* Test blender id */
-    if ((blender_id < 0) || (blender_id >= EVIEWITF_MAX_BLENDER)) {
+    return eviewitf_ctx_blender_write_frame(device_default_ctx(), blender_id, frame_buffer, buffer_size);
+}
+
+eviewitf_ret_t eviewitf_ctx_blender_write_frame(eviewitf_ctx_t *ctx, int blender_id, uint8_t *frame_buffer,
+                                                uint32_t buffer_size) {
+    /* Test context and blender id */
+    if ((ctx == NULL) || (blender_id < 0) || (blender_id >= EVIEWITF_MAX_BLENDER)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    return device_write(blender_id + EVIEWITF_OFFSET_BLENDER, frame_buffer, buffer_size);
+    return device_write(ctx, blender_id + EVIEWITF_OFFSET_BLENDER, frame_buffer, buffer_size);
 }
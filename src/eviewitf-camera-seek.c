@@ -138,6 +138,12 @@ static seek_handler_t seek_handlers[SEEK_NB_CAMERAS] = {0};
  ******************************************************************************************/
 
 eviewitf_ret_t camera_seek_register(int cam_id) {
+    /* Already registered when the attributes are retrieved again */
+    for (int i = 0; i < SEEK_NB_CAMERAS; i++) {
+        if ((seek_handlers[i].used == true) && (seek_handlers[i].cam_id == cam_id)) {
+            return EVIEWITF_OK;
+        }
+    }
     for (int i = 0; i < SEEK_NB_CAMERAS; i++) {
         if (seek_handlers[i].used == false) {
             seek_handlers[i].cam_id = cam_id;
@@ -225,15 +231,24 @@ int camera_seek_close(int file_descriptor) {
     return -1;
 }
 
-int camera_seek_read(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_size) {
+int camera_seek_read(int file_descriptor, const iovec_t *iov, int iovcnt, off_t offset) {
     u_int8_t msg[SEEK_CONFIG_MESSAGE_SIZE];
-    int min_size = MIN(buffer_size, sizeof(seek_shared_memory_t));
+    int min_size = 0;
+    size_t size;
+
+    if ((offset < 0) || (offset > (off_t)sizeof(seek_shared_memory_t))) {
+        return -1;
+    }
 
     for (int i = 0; i < SEEK_NB_CAMERAS; i++) {
         if (seek_handlers[i].sock == file_descriptor) {
             sem_wait(seek_handlers[i].mutex_sem);
             /* Copy content from shared memory */
-            memcpy(frame_buffer, seek_handlers[i].ptr_shm, min_size);
+            for (int j = 0; j < iovcnt; j++) {
+                size = MIN(iov[j].iov_len, sizeof(seek_shared_memory_t) - offset - min_size);
+                memcpy(iov[j].iov_base, (uint8_t *)seek_handlers[i].ptr_shm + offset + min_size, size);
+                min_size += size;
+            }
             /* Read message on socket to cancel polling */
             if (read(seek_handlers[i].sock, msg, SEEK_CONFIG_MESSAGE_SIZE) != SEEK_CONFIG_MESSAGE_SIZE) {
                 min_size = -1;
@@ -9,14 +9,223 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
 
 #include "eviewitf/eviewitf-camera.h"
 #include "eviewitf-priv.h"
 #include "cam-ioctl.h"
 #include "mfis-communication.h"
 
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Max gap between two rows of regions of interest read in the same operation, the gap is read and discarded
+ */
+#define CAMERA_ROI_MAX_GAP 4096
+
+/**
+ * @brief Max number of buffers of a vectored read, as accepted by Linux
+ */
+#define CAMERA_ROI_MAX_IOV 1024
+
+/**
+ * @brief Delay after which the frame rate of a camera is read again, to follow changes made by other processes (in ns)
+ */
+#define CAMERA_PERIOD_VALIDITY_NS 1000000000ULL
+
+/**
+ * @brief Delay before reading again a frame rate that could not be read (in ns)
+ */
+#define CAMERA_PERIOD_RETRY_NS 100000000ULL
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef camera_frame_state_t
+ * @brief State of a frame held by the customer application
+ *
+ * @enum camera_frame_state
+ * @brief State of a frame held by the customer application
+ */
+typedef enum camera_frame_state {
+    CAMERA_FRAME_FREE,   /*!< Slot not used */
+    CAMERA_FRAME_BUSY,   /*!< Frame being copied */
+    CAMERA_FRAME_COPIED, /*!< Frame copied into a pool buffer */
+} camera_frame_state_t;
+
+/**
+ * @typedef camera_frame_t
+ * @brief Frame held by the customer application
+ *
+ * @struct camera_frame
+ * @brief Frame held by the customer application
+ */
+typedef struct camera_frame {
+    camera_frame_state_t state; /*!< State */
+    uint8_t *buffer;            /*!< Frame buffer */
+    uint32_t size;              /*!< Frame buffer size */
+} camera_frame_t;
+
+/**
+ * @typedef camera_frames_t
+ * @brief Frames of a camera held by the customer application
+ *
+ * @struct camera_frames
+ * @brief Frames of a camera held by the customer application
+ */
+typedef struct camera_frames {
+    uint8_t no_map;                                    /*!< The camera device cannot be mapped */
+    uint8_t has_metadata;                              /*!< The last frame read with its metadata had valid ones */
+    eviewitf_pool_t *pool;                             /*!< Buffers the held frames are copied into */
+    uint32_t pool_size;                                /*!< Size of the pool buffers */
+    camera_frame_t frames[EVIEWITF_MAX_CAMERA_FRAMES]; /*!< Frames */
+    uint8_t *roi_buffer;                               /*!< Mapping the regions of interest are copied from */
+    uint32_t roi_size;                                 /*!< Size of the regions of interest mapping */
+    uint32_t roi_generation;                           /*!< Generation of the device the mapping has been made on */
+    int roi_users;                                     /*!< Number of copies in progress from the mapping */
+} camera_frames_t;
+
+/**
+ * @typedef camera_poll_cache_t
+ * @brief Wait set used by eviewitf_camera_poll
+ *
+ * @struct camera_poll_cache
+ * @brief Wait set used by eviewitf_camera_poll, kept per thread and rebuilt only when the polled cameras change
+ */
+typedef struct camera_poll_cache {
+    eviewitf_waitset_t *waitset;              /*!< Wait set of the polled cameras */
+    int nb_cam;                               /*!< Number of polled cameras */
+    int cam_id[EVIEWITF_MAX_CAMERA];          /*!< Polled cameras */
+    uint32_t generation[EVIEWITF_MAX_CAMERA]; /*!< Generation of the polled cameras when they were registered */
+} camera_poll_cache_t;
+
+/**
+ * @typedef camera_roi_row_t
+ * @brief Row of a region of interest
+ *
+ * @struct camera_roi_row
+ * @brief Row of a region of interest and where to store it
+ */
+typedef struct camera_roi_row {
+    uint32_t offset; /*!< Offset of the row in the frame buffer */
+    uint32_t size;   /*!< Size of the row */
+    uint8_t *buffer; /*!< Where to store the row */
+} camera_roi_row_t;
+
+/**
+ * @typedef camera_period_t
+ * @brief Frame period of a camera
+ *
+ * @struct camera_period
+ * @brief Frame period of a camera, read from its configured frame rate
+ */
+typedef struct camera_period {
+    uint64_t period_ns;  /*!< Frame period, 0 if unknown */
+    uint64_t expiry_ns;  /*!< Time the frame rate is to be read again, 0 to read it on the next frame */
+    uint32_t generation; /*!< Attributes generation the frame rate has been read in */
+} camera_period_t;
+
+/**
+ * @typedef camera_period_request_t
+ * @brief Frame rate read of a camera
+ *
+ * @struct camera_period_request
+ * @brief Frame rate read of a camera, submitted to the asynchronous worker thread
+ */
+typedef struct camera_period_request {
+    eviewitf_batch_t batch; /*!< Batch reading the frame rate */
+    uint16_t fps;           /*!< Frame rate read */
+    int cam_id;             /*!< Id of the camera */
+    uint64_t expiry_ns;     /*!< Expiry of the frame period when the read was submitted */
+} camera_period_request_t;
+
+/**
+ * @typedef camera_plane_t
+ * @brief Geometry of a frame plane
+ *
+ * @struct camera_plane
+ * @brief Geometry of a frame plane, given by a metadata segment
+ */
+typedef struct camera_plane {
+    uint32_t offset; /*!< Offset of the plane in the frame buffer */
+    uint32_t size;   /*!< Size of the plane (in bytes) */
+    uint32_t stride; /*!< Distance between the start of two rows (in bytes) */
+    uint32_t width;  /*!< Width of the plane (in pixels) */
+    uint32_t height; /*!< Number of rows */
+    uint32_t bpp;    /*!< Number of bytes per pixel of the plane */
+    uint8_t dt;      /*!< Data type of the plane */
+} camera_plane_t;
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+/**
+ * @brief Frames held by the customer application
+ */
+static camera_frames_t camera_frames[EVIEWITF_MAX_CAMERA];
+
+/**
+ * @brief Held frames mutex
+ */
+static pthread_mutex_t camera_frames_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Frame period of the cameras
+ */
+static camera_period_t camera_periods[EVIEWITF_MAX_CAMERA];
+
+/**
+ * @brief Frame periods mutex
+ */
+static pthread_mutex_t camera_periods_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Per thread poll wait set key
+ */
+static pthread_key_t camera_poll_key;
+
+/**
+ * @brief Per thread poll wait set key creation control
+ */
+static pthread_once_t camera_poll_once = PTHREAD_ONCE_INIT;
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static void camera_unmap_rois(camera_frames_t *frames)
+ * @brief Unmap the frame buffer the regions of interest are copied from, if no copy is in progress
+ *
+ * @param frames: frames of the camera, camera_frames_mutex being held
+ */
+static void camera_unmap_rois(camera_frames_t *frames) {
+    if ((frames->roi_buffer != NULL) && (frames->roi_users == 0)) {
+        munmap(frames->roi_buffer, frames->roi_size);
+        frames->roi_buffer = NULL;
+    }
+}
+
+/**
+ * @fn static void camera_reset_period(int cam_id)
+ * @brief Forget the frame period of a camera, its frame rate is read again on the next frame
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ */
+static void camera_reset_period(int cam_id) {
+    pthread_mutex_lock(&camera_periods_mutex);
+    camera_periods[cam_id].period_ns = 0;
+    camera_periods[cam_id].expiry_ns = 0;
+    pthread_mutex_unlock(&camera_periods_mutex);
+}
+
 /**
  * @fn int camera_open(int cam_id)
  * @brief open a camera device
@@ -35,37 +244,127 @@ int camera_open(int cam_id) {
 }
 
 /**
- * @fn int camera_read(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_size)
+ * @fn int camera_read(int file_descriptor, const iovec_t *iov, int iovcnt, off_t offset)
  * @brief Read from a camera
  *
  * @param file_descriptor: file descriptor on an opened device
- * @param frame_buffer: buffer containing the frame
- * @param buffer_size: size of the frame
+ * @param iov: buffers to fill in, in order
+ * @param iovcnt: number of buffers
+ * @param offset: offset in the frame to read from
  *
  * @return the number of read bytes or -1
  */
-int camera_read(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_size) {
-    /* Read from device */
-    return read(file_descriptor, frame_buffer, buffer_size);
+int camera_read(int file_descriptor, const iovec_t *iov, int iovcnt, off_t offset) {
+    /* Positional read from device, a single buffer does not need the vectored call */
+    if (iovcnt == 1) {
+        return pread(file_descriptor, iov[0].iov_base, iov[0].iov_len, offset);
+    }
+    return preadv(file_descriptor, iov, iovcnt, offset);
 }
 
-eviewitf_ret_t eviewitf_camera_open(int cam_id) {
-    /* Test camera id */
-    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+/**
+ * @fn uint8_t *camera_map(int file_descriptor, uint32_t buffer_size)
+ * @brief Map a camera frame buffer
+ *
+ * @param file_descriptor: file descriptor on an opened device
+ * @param buffer_size: size of the frame buffer
+ *
+ * @return pointer on the mapped frame buffer or NULL
+ */
+uint8_t *camera_map(int file_descriptor, uint32_t buffer_size) {
+    void *frame_buffer = mmap(NULL, buffer_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+
+    if (frame_buffer == MAP_FAILED) {
+        return NULL;
+    }
+    return frame_buffer;
+}
+
+/**
+ * @fn static eviewitf_ret_t camera_check_metadata(const eviewitf_frame_metadata_info_t *metadata,
+ *                                                uint32_t buffer_size, eviewitf_frame_metadata_info_t *frame_metadata)
+ * @brief Check the metadata read at the end of a frame buffer
+ *
+ * @param metadata: metadata read at the end of the frame buffer
+ * @param buffer_size: size of the frame buffer
+ * @param frame_metadata: copy of the metadata if valid, zeroed otherwise
+ *
+ * @return EVIEWITF_OK if the metadata are present and valid, EVIEWITF_FAIL otherwise
+ */
+static eviewitf_ret_t camera_check_metadata(const eviewitf_frame_metadata_info_t *metadata, uint32_t buffer_size,
+                                            eviewitf_frame_metadata_info_t *frame_metadata) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    if (metadata->magic_number == FRAME_MAGIC_NUMBER) {
+        if (metadata->frame_size > buffer_size) {
+            /* Special case where frame's data looks like a magic number */
+            ret = EVIEWITF_FAIL;
+        } else {
+            if ((metadata->frame_width * metadata->frame_height * metadata->frame_bpp) != metadata->frame_size) {
+                /* Special case where:                      */
+                /* - frame's data looks like a magic number */
+                /* - frame_size is lower than buffer_size   */
+                ret = EVIEWITF_FAIL;
+            } else {
+                /* Metadata are present and valid */
+                memmove(frame_metadata, metadata, sizeof(eviewitf_frame_metadata_info_t));
+            }
+        }
+    } else {
+        /* Magic number not found, no metadata */
+        ret = EVIEWITF_FAIL;
+    }
+
+    if (ret != EVIEWITF_OK) {
+        /* No metadata available */
+        memset(frame_metadata, 0, sizeof(eviewitf_frame_metadata_info_t));
+    }
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_camera_open(int cam_id) { return eviewitf_ctx_camera_open(device_default_ctx(), cam_id); }
+
+eviewitf_ret_t eviewitf_ctx_camera_open(eviewitf_ctx_t *ctx, int cam_id) {
+    eviewitf_ret_t ret;
+
+    /* Test context and camera id */
+    if ((ctx == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
     /* Open device */
-    return device_open(cam_id + EVIEWITF_OFFSET_CAMERA);
+    ret = device_open(ctx, cam_id + EVIEWITF_OFFSET_CAMERA);
+    if (ret != EVIEWITF_OK) {
+        return ret;
+    }
+
+    /* Mapping is attempted again on the newly opened device */
+    pthread_mutex_lock(&camera_frames_mutex);
+    camera_frames[cam_id].no_map = 0;
+    pthread_mutex_unlock(&camera_frames_mutex);
+    __atomic_store_n(&camera_frames[cam_id].has_metadata, 0, __ATOMIC_RELAXED);
+    camera_reset_period(cam_id);
+
+    return EVIEWITF_OK;
 }
 
-eviewitf_ret_t eviewitf_camera_close(int cam_id) {
-    /* Test camera id */
-    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+eviewitf_ret_t eviewitf_camera_close(int cam_id) { return eviewitf_ctx_camera_close(device_default_ctx(), cam_id); }
+
+eviewitf_ret_t eviewitf_ctx_camera_close(eviewitf_ctx_t *ctx, int cam_id) {
+    /* Test context and camera id */
+    if ((ctx == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    return device_close(cam_id + EVIEWITF_OFFSET_CAMERA);
+    /* The regions of interest are copied from the device of the default context */
+    if (ctx == device_default_ctx()) {
+        pthread_mutex_lock(&camera_frames_mutex);
+        camera_unmap_rois(&camera_frames[cam_id]);
+        pthread_mutex_unlock(&camera_frames_mutex);
+    }
+
+    return device_close(ctx, cam_id + EVIEWITF_OFFSET_CAMERA);
 }
 
 /**
@@ -108,15 +407,105 @@ eviewitf_ret_t eviewitf_camera_stop(int cam_id) {
     return ret;
 }
 
+/**
+ * @fn static void camera_period_read(const eviewitf_async_completion_t *completion)
+ * @brief Store the frame period of a camera once its frame rate has been read
+ *
+ * @param completion: completion of the frame rate read, its user context is the camera_period_request_t
+ */
+static void camera_period_read(const eviewitf_async_completion_t *completion) {
+    camera_period_request_t *request = completion->user_ctx;
+    camera_period_t *period = &camera_periods[request->cam_id];
+
+    /* Unless the period has been reset meanwhile */
+    pthread_mutex_lock(&camera_periods_mutex);
+    if (period->expiry_ns == request->expiry_ns) {
+        period->period_ns = 0;
+        if ((completion->result == EVIEWITF_OK) && (request->fps != 0)) {
+            period->period_ns = 1000000000ULL / request->fps;
+            period->expiry_ns = stats_now_ns() + CAMERA_PERIOD_VALIDITY_NS;
+        }
+    }
+    pthread_mutex_unlock(&camera_periods_mutex);
+
+    free(request);
+}
+
+/**
+ * @fn static uint64_t camera_get_period(int cam_id)
+ * @brief Get the frame period of a camera, requesting its frame rate when unknown or outdated
+ *
+ * The frame rate is read again once CAMERA_PERIOD_VALIDITY_NS have elapsed and when the attributes are refreshed, or
+ * CAMERA_PERIOD_RETRY_NS after it could not be read. It is read by the asynchronous worker thread so that no ioctl is
+ * issued from the caller, the previous period is returned meanwhile.
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return frame period in ns, 0 if unknown
+ */
+static uint64_t camera_get_period(int cam_id) {
+    camera_period_t *period = &camera_periods[cam_id];
+    camera_period_request_t *request = NULL;
+    uint32_t generation = device_get_attributes_generation();
+    uint64_t now_ns = stats_now_ns();
+    uint64_t period_ns;
+
+    pthread_mutex_lock(&camera_periods_mutex);
+    if ((period->generation != generation) || (now_ns >= period->expiry_ns)) {
+        /* A single read is requested, the next one after CAMERA_PERIOD_RETRY_NS if it does not complete */
+        period->generation = generation;
+        period->expiry_ns = now_ns + CAMERA_PERIOD_RETRY_NS;
+        request = malloc(sizeof(camera_period_request_t));
+        if (request != NULL) {
+            request->cam_id = cam_id;
+            request->expiry_ns = period->expiry_ns;
+        }
+    }
+    period_ns = period->period_ns;
+    pthread_mutex_unlock(&camera_periods_mutex);
+
+    if ((request != NULL) &&
+        ((eviewitf_batch_reset(&request->batch) != EVIEWITF_OK) ||
+         (eviewitf_batch_camera_get_frame_rate(&request->batch, cam_id, &request->fps) != EVIEWITF_OK) ||
+         (eviewitf_async_submit(&request->batch, camera_period_read, request, NULL) != EVIEWITF_OK))) {
+        free(request);
+    }
+
+    return period_ns;
+}
+
 eviewitf_ret_t eviewitf_camera_get_frame(int cam_id, uint8_t *frame_buffer, uint32_t buffer_size) {
-    /* Test camera id */
-    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+    return eviewitf_ctx_camera_get_frame(device_default_ctx(), cam_id, frame_buffer, buffer_size);
+}
+
+eviewitf_ret_t eviewitf_ctx_camera_get_frame(eviewitf_ctx_t *ctx, int cam_id, uint8_t *frame_buffer,
+                                             uint32_t buffer_size) {
+    eviewitf_frame_metadata_info_t metadata;
+    eviewitf_ret_t ret;
+    uint32_t device_size;
+
+    /* Test context and camera id */
+    if ((ctx == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
         return EVIEWITF_INVALID_PARAM;
     }
-    /* Do not check return value for backward compatibility */
-    device_seek(cam_id + EVIEWITF_OFFSET_CAMERA, 0, SEEK_SET);
 
-    return device_read(cam_id + EVIEWITF_OFFSET_CAMERA, frame_buffer, buffer_size);
+    ret = device_read(ctx, cam_id + EVIEWITF_OFFSET_CAMERA, frame_buffer, buffer_size, 0);
+    if (ret == EVIEWITF_OK) {
+        /* The metadata of the latency measurement are at the end of the buffer if the whole frame was read, they are
+         * only looked for once the camera is known to emit them */
+        memset(&metadata, 0, sizeof(eviewitf_frame_metadata_info_t));
+        device_size = get_device_object(cam_id + EVIEWITF_OFFSET_CAMERA)->attributes.buffer_size;
+        if (__atomic_load_n(&camera_frames[cam_id].has_metadata, __ATOMIC_RELAXED) &&
+            (device_size >= sizeof(eviewitf_frame_metadata_info_t)) && (buffer_size >= device_size) &&
+            (camera_check_metadata((const eviewitf_frame_metadata_info_t *)(frame_buffer + device_size -
+                                                                            sizeof(eviewitf_frame_metadata_info_t)),
+                                   device_size, &metadata) == EVIEWITF_OK)) {
+            stats_camera_frame(cam_id, &metadata, camera_get_period(cam_id));
+        } else {
+            stats_camera_frame(cam_id, &metadata, 0);
+        }
+    }
+
+    return ret;
 }
 
 /**
@@ -135,19 +524,275 @@ eviewitf_ret_t eviewitf_camera_get_frame(int cam_id, uint8_t *frame_buffer, uint
  * call to eviewitf_camera_get_frame_metadata.
  */
 eviewitf_ret_t eviewitf_camera_get_frame_segment(int cam_id, uint8_t *buffer, uint32_t size, uint32_t offset) {
+    return eviewitf_ctx_camera_get_frame_segment(device_default_ctx(), cam_id, buffer, size, offset);
+}
+
+eviewitf_ret_t eviewitf_ctx_camera_get_frame_segment(eviewitf_ctx_t *ctx, int cam_id, uint8_t *buffer, uint32_t size,
+                                                     uint32_t offset) {
+    /* Test context and camera id */
+    if ((ctx == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    return device_read(ctx, cam_id + EVIEWITF_OFFSET_CAMERA, buffer, size, offset);
+}
+
+/**
+ * @fn static int camera_get_planes(const eviewitf_frame_metadata_info_t *metadata, camera_plane_t *planes)
+ * @brief Get the geometry of the planes of a frame from its metadata
+ *
+ * Each segment whose offset follows the previous one within the frame size gives a plane, ending where the next one
+ * starts. The first plane covers the frame_height rows of the frame. A smaller plane is a chroma plane: interleaved
+ * with the same stride if there are two planes (semi-planar), one per component with half the width and stride
+ * otherwise (planar). The number of rows of a plane follows from its size and stride.
+ *
+ * @param metadata: frame metadata
+ * @param planes: geometry of the planes, EVIEWITF_FRAME_MAX_PLANES entries
+ * @return number of planes, 0 if the metadata do not describe any
+ */
+static int camera_get_planes(const eviewitf_frame_metadata_info_t *metadata, camera_plane_t *planes) {
+    uint32_t offsets[EVIEWITF_FRAME_MAX_PLANES + 1];
+    camera_plane_t *plane;
+    int nb_planes;
+
+    if ((metadata->frame_width == 0) || (metadata->frame_height == 0) ||
+        (metadata->segments[0].offset >= metadata->frame_size)) {
+        return 0;
+    }
+
+    /* Unused segments do not follow the previous one, the last plane ends with the frame */
+    nb_planes = 1;
+    offsets[0] = metadata->segments[0].offset;
+    while ((nb_planes < EVIEWITF_FRAME_MAX_PLANES) && (metadata->segments[nb_planes].offset > offsets[nb_planes - 1]) &&
+           (metadata->segments[nb_planes].offset < metadata->frame_size)) {
+        offsets[nb_planes] = metadata->segments[nb_planes].offset;
+        nb_planes++;
+    }
+    offsets[nb_planes] = metadata->frame_size;
+
+    for (int i = 0; i < nb_planes; i++) {
+        plane = &planes[i];
+        plane->offset = offsets[i];
+        plane->size = offsets[i + 1] - offsets[i];
+        plane->dt = metadata->segments[i].dt;
+        if (i == 0) {
+            plane->stride = plane->size / metadata->frame_height;
+            plane->width = metadata->frame_width;
+        } else if ((plane->size < planes[0].size) && (nb_planes > 2)) {
+            plane->stride = planes[0].stride / 2;
+            plane->width = planes[0].width / 2;
+        } else {
+            plane->stride = planes[0].stride;
+            plane->width = planes[0].width;
+        }
+        if ((plane->stride == 0) || (plane->width == 0)) {
+            return 0;
+        }
+        plane->height = plane->size / plane->stride;
+        plane->bpp = plane->stride / plane->width;
+    }
+
+    return nb_planes;
+}
+
+/**
+ * @fn static int camera_roi_row_compare(const void *a, const void *b)
+ * @brief Order the rows of regions of interest by offset in the frame buffer
+ *
+ * @param a: first row
+ * @param b: second row
+ * @return negative, zero or positive as a is before, at or after b
+ */
+static int camera_roi_row_compare(const void *a, const void *b) {
+    const camera_roi_row_t *row_a = a;
+    const camera_roi_row_t *row_b = b;
+
+    return (row_a->offset > row_b->offset) - (row_a->offset < row_b->offset);
+}
+
+/**
+ * @fn static eviewitf_ret_t camera_map_rows(int cam_id, uint32_t size, const camera_roi_row_t *rows, int nb_rows)
+ * @brief Copy rows straight from the mapped camera frame buffer
+ *
+ * The mapping is kept for the next calls, as long as the device is not reopened.
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param size: size of the frame buffer
+ * @param rows: rows to copy
+ * @param nb_rows: number of rows
+ * @return return code as specified by the eviewitf_ret_t enumeration, EVIEWITF_FAIL if the camera cannot be mapped,
+ *         EVIEWITF_BLOCKED if a previous mapping is still in use and cannot be replaced yet
+ */
+static eviewitf_ret_t camera_map_rows(int cam_id, uint32_t size, const camera_roi_row_t *rows, int nb_rows) {
+    camera_frames_t *frames = &camera_frames[cam_id];
     eviewitf_ret_t ret = EVIEWITF_OK;
+    uint32_t generation;
+    uint8_t *frame_buffer;
+
+    generation = device_get_generation(device_default_ctx(), cam_id + EVIEWITF_OFFSET_CAMERA);
+
+    pthread_mutex_lock(&camera_frames_mutex);
+    if ((frames->roi_buffer != NULL) && ((frames->roi_size != size) || (frames->roi_generation != generation))) {
+        camera_unmap_rois(frames);
+        if (frames->roi_buffer != NULL) {
+            ret = EVIEWITF_BLOCKED;
+        }
+    }
+    if ((ret == EVIEWITF_OK) && (frames->roi_buffer == NULL)) {
+        ret = device_map(device_default_ctx(), cam_id + EVIEWITF_OFFSET_CAMERA, &frames->roi_buffer, size);
+        if (ret == EVIEWITF_OK) {
+            frames->roi_size = size;
+            frames->roi_generation = generation;
+        } else {
+            frames->roi_buffer = NULL;
+        }
+    }
+    if (ret == EVIEWITF_OK) {
+        frames->roi_users++;
+        frame_buffer = frames->roi_buffer;
+    }
+    pthread_mutex_unlock(&camera_frames_mutex);
+
+    if (ret != EVIEWITF_OK) {
+        return ret;
+    }
+
+    for (int i = 0; i < nb_rows; i++) {
+        memcpy(rows[i].buffer, frame_buffer + rows[i].offset, rows[i].size);
+    }
+
+    pthread_mutex_lock(&camera_frames_mutex);
+    frames->roi_users--;
+    pthread_mutex_unlock(&camera_frames_mutex);
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static eviewitf_ret_t camera_read_rows(int cam_id, const camera_roi_row_t *rows, int nb_rows)
+ * @brief Read rows sorted by offset, the rows close to each other in a single vectored read
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param rows: rows to read, sorted by offset
+ * @param nb_rows: number of rows
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t camera_read_rows(int cam_id, const camera_roi_row_t *rows, int nb_rows) {
+    static uint8_t gap[CAMERA_ROI_MAX_GAP];
+    iovec_t iov[CAMERA_ROI_MAX_IOV];
+    eviewitf_ret_t ret;
+    uint32_t start = 0;
+    uint32_t end = 0;
+    int iovcnt = 0;
+
+    for (int i = 0; i < nb_rows; i++) {
+        /* A new read is started for overlapping or distant rows */
+        if ((iovcnt != 0) && ((rows[i].offset < end) || (rows[i].offset - end > CAMERA_ROI_MAX_GAP) ||
+                              (iovcnt > CAMERA_ROI_MAX_IOV - 2))) {
+            ret = device_readv(device_default_ctx(), cam_id + EVIEWITF_OFFSET_CAMERA, iov, iovcnt, start);
+            if (ret != EVIEWITF_OK) {
+                return ret;
+            }
+            iovcnt = 0;
+        }
+
+        if (iovcnt == 0) {
+            start = rows[i].offset;
+        } else if (rows[i].offset > end) {
+            /* The gap is only written, never read, so that it can be shared by all the reads */
+            iov[iovcnt].iov_base = gap;
+            iov[iovcnt].iov_len = rows[i].offset - end;
+            iovcnt++;
+        }
+        iov[iovcnt].iov_base = rows[i].buffer;
+        iov[iovcnt].iov_len = rows[i].size;
+        iovcnt++;
+        end = rows[i].offset + rows[i].size;
+    }
+
+    return device_readv(device_default_ctx(), cam_id + EVIEWITF_OFFSET_CAMERA, iov, iovcnt, start);
+}
+
+eviewitf_ret_t eviewitf_camera_get_frame_rois(int cam_id, const eviewitf_frame_metadata_info_t *frame_metadata,
+                                              const eviewitf_camera_roi_t *rois, int nb_rois) {
+    const eviewitf_camera_roi_t *roi;
+    camera_plane_t planes[EVIEWITF_FRAME_MAX_PLANES];
+    camera_plane_t *plane;
+    camera_roi_row_t *rows;
+    device_object_t *device;
+    eviewitf_ret_t ret;
+    uint32_t size;
+    uint8_t no_map;
+    int nb_planes;
+    int nb_rows = 0;
 
     /* Test camera id */
-    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (frame_metadata == NULL) || (rois == NULL) ||
+        (nb_rois <= 0) || (nb_rois > EVIEWITF_MAX_CAMERA_ROI)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    /* Seek before read */
-    ret = device_seek(cam_id + EVIEWITF_OFFSET_CAMERA, offset, SEEK_SET);
-    if (ret == EVIEWITF_OK) {
-        ret = device_read(cam_id + EVIEWITF_OFFSET_CAMERA, buffer, size);
+    device = get_device_object(cam_id + EVIEWITF_OFFSET_CAMERA);
+    size = device->attributes.buffer_size;
+    if (size == 0) {
+        return EVIEWITF_FAIL;
+    }
+
+    /* Regions must lie within their plane, and the frame within the frame buffer */
+    nb_planes = camera_get_planes(frame_metadata, planes);
+    if ((nb_planes == 0) || (frame_metadata->frame_size > size)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+    for (int i = 0; i < nb_rois; i++) {
+        roi = &rois[i];
+        if ((roi->buffer == NULL) || (roi->segment >= nb_planes) || (roi->width == 0) || (roi->height == 0)) {
+            return EVIEWITF_INVALID_PARAM;
+        }
+        plane = &planes[roi->segment];
+        if ((roi->x >= plane->width) || (roi->width > plane->width - roi->x) || (roi->y >= plane->height) ||
+            (roi->height > plane->height - roi->y)) {
+            return EVIEWITF_INVALID_PARAM;
+        }
+        nb_rows += roi->height;
+    }
+
+    rows = malloc(nb_rows * sizeof(camera_roi_row_t));
+    if (rows == NULL) {
+        return EVIEWITF_FAIL;
     }
+    nb_rows = 0;
+    for (int i = 0; i < nb_rois; i++) {
+        roi = &rois[i];
+        plane = &planes[roi->segment];
+        for (uint32_t y = 0; y < roi->height; y++) {
+            rows[nb_rows].offset = plane->offset + (roi->y + y) * plane->stride + roi->x * plane->bpp;
+            rows[nb_rows].size = roi->width * plane->bpp;
+            rows[nb_rows].buffer = roi->buffer + y * rows[nb_rows].size;
+            nb_rows++;
+        }
+    }
+
+    /* Rows are copied in the frame buffer order */
+    qsort(rows, nb_rows, sizeof(camera_roi_row_t), camera_roi_row_compare);
+
+    pthread_mutex_lock(&camera_frames_mutex);
+    no_map = camera_frames[cam_id].no_map;
+    pthread_mutex_unlock(&camera_frames_mutex);
 
+    ret = EVIEWITF_FAIL;
+    if (!no_map) {
+        ret = camera_map_rows(cam_id, size, rows, nb_rows);
+    }
+    if ((ret == EVIEWITF_FAIL) && !no_map) {
+        pthread_mutex_lock(&camera_frames_mutex);
+        camera_frames[cam_id].no_map = 1;
+        pthread_mutex_unlock(&camera_frames_mutex);
+    }
+    if (ret != EVIEWITF_OK) {
+        ret = camera_read_rows(cam_id, rows, nb_rows);
+    }
+
+    free(rows);
     return ret;
 }
 
@@ -163,11 +808,15 @@ eviewitf_ret_t eviewitf_camera_get_frame_segment(int cam_id, uint8_t *buffer, ui
  eviewitf_frame_metadata_info_t.
  */
 eviewitf_ret_t eviewitf_camera_get_frame_metadata(int cam_id, eviewitf_frame_metadata_info_t *frame_metadata) {
-    eviewitf_ret_t ret;
+    return eviewitf_ctx_camera_get_frame_metadata(device_default_ctx(), cam_id, frame_metadata);
+}
+
+eviewitf_ret_t eviewitf_ctx_camera_get_frame_metadata(eviewitf_ctx_t *ctx, int cam_id,
+                                                      eviewitf_frame_metadata_info_t *frame_metadata) {
     uint32_t offset;
 
-    /* Test camera id */
-    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+    /* Test context and camera id */
+    if ((ctx == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
@@ -177,28 +826,350 @@ eviewitf_ret_t eviewitf_camera_get_frame_metadata(int cam_id, eviewitf_frame_met
     }
     offset = device->attributes.buffer_size - sizeof(eviewitf_frame_metadata_info_t);
 
-    /* Seek before read */
-    ret = device_seek(cam_id + EVIEWITF_OFFSET_CAMERA, offset, SEEK_SET);
+    return device_read(ctx, cam_id + EVIEWITF_OFFSET_CAMERA, (uint8_t *)frame_metadata,
+                       sizeof(eviewitf_frame_metadata_info_t), offset);
+}
+
+eviewitf_ret_t eviewitf_camera_get_frame_with_metadata(int cam_id, uint8_t *frame_buffer, uint32_t buffer_size,
+                                                       eviewitf_frame_metadata_info_t *frame_metadata) {
+    return eviewitf_ctx_camera_get_frame_with_metadata(device_default_ctx(), cam_id, frame_buffer, buffer_size,
+                                                       frame_metadata);
+}
+
+eviewitf_ret_t eviewitf_ctx_camera_get_frame_with_metadata(eviewitf_ctx_t *ctx, int cam_id, uint8_t *frame_buffer,
+                                                           uint32_t buffer_size,
+                                                           eviewitf_frame_metadata_info_t *frame_metadata) {
+    eviewitf_ret_t ret;
+    eviewitf_frame_metadata_info_t metadata;
+    device_object_t *device;
+    iovec_t iov[2];
+
+    /* Test context and camera id */
+    if ((ctx == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (frame_buffer == NULL) ||
+        (frame_metadata == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    device = get_device_object(cam_id + EVIEWITF_OFFSET_CAMERA);
+    if (device->attributes.buffer_size < sizeof(eviewitf_frame_metadata_info_t)) {
+        return EVIEWITF_FAIL;
+    }
+
+    if (buffer_size == device->attributes.buffer_size) {
+        /* The metadata are read along with the frame, at the end of the buffer */
+        ret = device_read(ctx, cam_id + EVIEWITF_OFFSET_CAMERA, frame_buffer, buffer_size, 0);
+        if (ret == EVIEWITF_OK) {
+            memcpy(&metadata, frame_buffer + buffer_size - sizeof(eviewitf_frame_metadata_info_t),
+                   sizeof(eviewitf_frame_metadata_info_t));
+        }
+    } else if (buffer_size == device->attributes.buffer_size - sizeof(eviewitf_frame_metadata_info_t)) {
+        /* The metadata are read apart from the frame, in the same operation */
+        iov[0].iov_base = frame_buffer;
+        iov[0].iov_len = buffer_size;
+        iov[1].iov_base = &metadata;
+        iov[1].iov_len = sizeof(eviewitf_frame_metadata_info_t);
+        ret = device_readv(ctx, cam_id + EVIEWITF_OFFSET_CAMERA, iov, 2, 0);
+    } else {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (ret == EVIEWITF_OK) {
+        /* Frames without metadata are still returned, with zeroed metadata */
+        if (camera_check_metadata(&metadata, device->attributes.buffer_size, frame_metadata) == EVIEWITF_OK) {
+            __atomic_store_n(&camera_frames[cam_id].has_metadata, 1, __ATOMIC_RELAXED);
+            stats_camera_frame(cam_id, frame_metadata, camera_get_period(cam_id));
+        } else {
+            __atomic_store_n(&camera_frames[cam_id].has_metadata, 0, __ATOMIC_RELAXED);
+            stats_camera_frame(cam_id, frame_metadata, 0);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @fn static eviewitf_ret_t camera_frames_get_pool(int cam_id, uint32_t size, eviewitf_pool_t **pool)
+ * @brief Get the pool the frames of a camera are copied into, creating it on first use
+ *
+ * The pool is created again when the frame size has changed, once all the frames copied into it are released.
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param size: size of a frame
+ * @param pool: pool of the camera
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t camera_frames_get_pool(int cam_id, uint32_t size, eviewitf_pool_t **pool) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    pthread_mutex_lock(&camera_frames_mutex);
+    if ((camera_frames[cam_id].pool != NULL) && (camera_frames[cam_id].pool_size != size)) {
+        ret = eviewitf_pool_destroy(camera_frames[cam_id].pool);
+        if (ret == EVIEWITF_OK) {
+            camera_frames[cam_id].pool = NULL;
+        }
+    }
+    if ((ret == EVIEWITF_OK) && (camera_frames[cam_id].pool == NULL)) {
+        ret = eviewitf_pool_create(&camera_frames[cam_id].pool, size, EVIEWITF_MAX_CAMERA_FRAMES, 0);
+        camera_frames[cam_id].pool_size = size;
+    }
+    *pool = camera_frames[cam_id].pool;
+    pthread_mutex_unlock(&camera_frames_mutex);
+
+    return ret;
+}
+
+/**
+ * @fn void camera_deinit(void)
+ * @brief Free the pools the frames of the cameras are copied into, and the regions of interest mappings
+ *
+ * Pools holding frames not released are kept.
+ */
+void camera_deinit(void) {
+    pthread_mutex_lock(&camera_frames_mutex);
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA; i++) {
+        camera_unmap_rois(&camera_frames[i]);
+        if ((camera_frames[i].pool != NULL) && (eviewitf_pool_destroy(camera_frames[i].pool) == EVIEWITF_OK)) {
+            camera_frames[i].pool = NULL;
+        }
+    }
+    pthread_mutex_unlock(&camera_frames_mutex);
+}
+
+eviewitf_ret_t eviewitf_camera_create_pool(int cam_id, int nb_buffers, uint32_t flags, eviewitf_pool_t **pool) {
+    eviewitf_device_attributes_t attributes;
+    eviewitf_ret_t ret;
+
+    ret = eviewitf_camera_get_attributes(cam_id, &attributes);
+    if (ret != EVIEWITF_OK) {
+        return ret;
+    }
+
+    return eviewitf_pool_create(pool, attributes.buffer_size, nb_buffers, flags);
+}
+
+eviewitf_ret_t eviewitf_camera_map_frame(int cam_id, uint8_t **frame_buffer, uint32_t *buffer_size) {
+    eviewitf_ret_t ret;
+    device_object_t *device;
+    camera_frame_t *frame = NULL;
+    eviewitf_pool_t *pool;
+    uint32_t size;
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (frame_buffer == NULL) || (buffer_size == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    device = get_device_object(cam_id + EVIEWITF_OFFSET_CAMERA);
+    size = device->attributes.buffer_size;
+    if (size == 0) {
+        return EVIEWITF_FAIL;
+    }
+
+    /* Reserve a frame slot */
+    pthread_mutex_lock(&camera_frames_mutex);
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA_FRAMES; i++) {
+        if (camera_frames[cam_id].frames[i].state == CAMERA_FRAME_FREE) {
+            frame = &camera_frames[cam_id].frames[i];
+            frame->state = CAMERA_FRAME_BUSY;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&camera_frames_mutex);
+    if (frame == NULL) {
+        return EVIEWITF_BLOCKED;
+    }
+
+    /* The driver keeps writing into its single frame buffer, a held frame is a copy of it to stay unchanged */
+    ret = camera_frames_get_pool(cam_id, size, &pool);
     if (ret == EVIEWITF_OK) {
-        ret = device_read(cam_id + EVIEWITF_OFFSET_CAMERA, (uint8_t *)frame_metadata,
-                          sizeof(eviewitf_frame_metadata_info_t));
+        ret = eviewitf_pool_acquire(pool, &frame->buffer);
+    }
+    if (ret == EVIEWITF_OK) {
+        ret = eviewitf_camera_get_frame(cam_id, frame->buffer, size);
+        if (ret != EVIEWITF_OK) {
+            eviewitf_pool_release(pool, frame->buffer);
+        }
+    }
+
+    pthread_mutex_lock(&camera_frames_mutex);
+    if (ret == EVIEWITF_OK) {
+        frame->size = size;
+        frame->state = CAMERA_FRAME_COPIED;
+        *frame_buffer = frame->buffer;
+        *buffer_size = size;
+    } else {
+        frame->buffer = NULL;
+        frame->state = CAMERA_FRAME_FREE;
     }
+    pthread_mutex_unlock(&camera_frames_mutex);
 
     return ret;
 }
 
+eviewitf_ret_t eviewitf_camera_release_frame(int cam_id, uint8_t *frame_buffer) {
+    camera_frame_t released = {.state = CAMERA_FRAME_FREE};
+
+    /* Test camera id */
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (frame_buffer == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&camera_frames_mutex);
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA_FRAMES; i++) {
+        camera_frame_t *frame = &camera_frames[cam_id].frames[i];
+        if ((frame->state == CAMERA_FRAME_COPIED) && (frame->buffer == frame_buffer)) {
+            released = *frame;
+            frame->buffer = NULL;
+            frame->state = CAMERA_FRAME_FREE;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&camera_frames_mutex);
+
+    if (released.state != CAMERA_FRAME_COPIED) {
+        /* Not a frame of this camera */
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    return eviewitf_pool_release(camera_frames[cam_id].pool, released.buffer);
+}
+
+/**
+ * @fn static void camera_poll_cache_free(void *cache)
+ * @brief Free the poll wait set of a thread when it exits
+ *
+ * @param cache: poll wait set of the thread
+ */
+static void camera_poll_cache_free(void *cache) {
+    camera_poll_cache_t *poll_cache = cache;
+
+    eviewitf_waitset_destroy(poll_cache->waitset);
+    free(poll_cache);
+}
+
+/**
+ * @fn static void camera_poll_key_create(void)
+ * @brief Create the per thread poll wait set key
+ */
+static void camera_poll_key_create(void) { pthread_key_create(&camera_poll_key, camera_poll_cache_free); }
+
+/**
+ * @fn static uint8_t camera_poll_cache_is_valid(camera_poll_cache_t *cache, int *cam_id, int nb_cam)
+ * @brief Check the cached wait set still matches the polled cameras
+ *
+ * @param cache: poll wait set of the thread
+ * @param cam_id: table of camera ids to poll on
+ * @param nb_cam: number of cameras on which the polling applies
+ * @return 1 if the wait set can be used as is, 0 otherwise
+ */
+static uint8_t camera_poll_cache_is_valid(camera_poll_cache_t *cache, int *cam_id, int nb_cam) {
+    if (cache->nb_cam != nb_cam) {
+        return 0;
+    }
+
+    /* A camera reopened since it was registered may have a new file descriptor */
+    for (int i = 0; i < nb_cam; i++) {
+        if ((cache->cam_id[i] != cam_id[i]) ||
+            (cache->generation[i] != device_get_generation(device_default_ctx(), cam_id[i] + EVIEWITF_OFFSET_CAMERA))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @fn static eviewitf_ret_t camera_poll_cache_build(camera_poll_cache_t *cache, int *cam_id, int nb_cam)
+ * @brief Register the polled cameras in a new wait set
+ *
+ * @param cache: poll wait set of the thread
+ * @param cam_id: table of camera ids to poll on
+ * @param nb_cam: number of cameras on which the polling applies
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t camera_poll_cache_build(camera_poll_cache_t *cache, int *cam_id, int nb_cam) {
+    eviewitf_ret_t ret;
+
+    if (cache->waitset != NULL) {
+        eviewitf_waitset_destroy(cache->waitset);
+    }
+    cache->nb_cam = 0;
+
+    ret = eviewitf_waitset_create(&cache->waitset, 0);
+    if (ret != EVIEWITF_OK) {
+        cache->waitset = NULL;
+        return ret;
+    }
+
+    for (int i = 0; i < nb_cam; i++) {
+        cache->cam_id[i] = cam_id[i];
+        cache->generation[i] = device_get_generation(device_default_ctx(), cam_id[i] + EVIEWITF_OFFSET_CAMERA);
+        ret = eviewitf_waitset_add_camera(cache->waitset, cam_id[i]);
+
+        /* A camera may be listed several times */
+        if ((ret != EVIEWITF_OK) && (ret != EVIEWITF_INVALID_PARAM)) {
+            return ret;
+        }
+    }
+    cache->nb_cam = nb_cam;
+
+    return EVIEWITF_OK;
+}
+
 eviewitf_ret_t eviewitf_camera_poll(int *cam_id, int nb_cam, int ms_timeout, short *event_return) {
-    if (cam_id == NULL) {
+    eviewitf_waitset_event_t events[EVIEWITF_MAX_CAMERA];
+    camera_poll_cache_t *cache;
+    eviewitf_ret_t ret;
+    int nb_events;
+
+    if ((cam_id == NULL) || (event_return == NULL) || (nb_cam < 0) || (nb_cam > EVIEWITF_MAX_CAMERA)) {
         return EVIEWITF_INVALID_PARAM;
     } else {
         for (int i = 0; i < nb_cam; i++) {
             if ((cam_id[i] < 0) || (cam_id[i] >= EVIEWITF_MAX_CAMERA)) {
                 return EVIEWITF_INVALID_PARAM;
             }
+            if (device_get_fd(device_default_ctx(), cam_id[i] + EVIEWITF_OFFSET_CAMERA) == -1) {
+                return EVIEWITF_NOT_OPENED;
+            }
+        }
+    }
+
+    /* Get the wait set of this thread */
+    pthread_once(&camera_poll_once, camera_poll_key_create);
+    cache = pthread_getspecific(camera_poll_key);
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(camera_poll_cache_t));
+        if (cache == NULL) {
+            return EVIEWITF_FAIL;
         }
+        pthread_setspecific(camera_poll_key, cache);
     }
 
-    return device_poll(cam_id, nb_cam, ms_timeout, event_return);
+    /* Register the cameras only when they have changed since the previous poll */
+    if ((cache->waitset == NULL) || !camera_poll_cache_is_valid(cache, cam_id, nb_cam)) {
+        ret = camera_poll_cache_build(cache, cam_id, nb_cam);
+        if (ret != EVIEWITF_OK) {
+            return ret;
+        }
+    }
+
+    ret = eviewitf_waitset_wait(cache->waitset, (ms_timeout < 0) ? -1 : (int64_t)ms_timeout * 1000000, events,
+                                EVIEWITF_MAX_CAMERA, &nb_events);
+    if (ret != EVIEWITF_OK) {
+        return ret;
+    }
+
+    for (int i = 0; i < nb_cam; i++) {
+        event_return[i] = 0;
+        for (int j = 0; j < nb_events; j++) {
+            if ((events[j].id == cam_id[i]) && (events[j].events & POLLIN)) {
+                event_return[i] = 1;
+            }
+        }
+    }
+
+    return EVIEWITF_OK;
 }
 
 /**
@@ -220,10 +1191,6 @@ eviewitf_ret_t eviewitf_camera_get_attributes(int cam_id, eviewitf_device_attrib
 
 eviewitf_ret_t eviewitf_camera_extract_metadata(uint8_t *buf, uint32_t buffer_size,
                                                 eviewitf_frame_metadata_info_t *frame_metadata) {
-    eviewitf_ret_t ret = EVIEWITF_OK;
-    uint8_t *ptr_metadata;
-    eviewitf_frame_metadata_info_t *metadata = NULL;
-
     if ((buf == NULL) || (frame_metadata == NULL)) {
         return EVIEWITF_INVALID_PARAM;
     }
@@ -233,34 +1200,63 @@ eviewitf_ret_t eviewitf_camera_extract_metadata(uint8_t *buf, uint32_t buffer_si
     }
 
     /* Metadata magic number is located at the end of the buffer if present */
-    ptr_metadata = buf + buffer_size - sizeof(eviewitf_frame_metadata_info_t);
-    metadata = (eviewitf_frame_metadata_info_t *)ptr_metadata;
-    if (metadata->magic_number == FRAME_MAGIC_NUMBER) {
-        if (metadata->frame_size > buffer_size) {
-            /* Special case where frame's data looks like a magic number */
-            ret = EVIEWITF_FAIL;
-        } else {
-            if ((metadata->frame_width * metadata->frame_height * metadata->frame_bpp) != metadata->frame_size) {
-                /* Special case where:                      */
-                /* - frame's data looks like a magic number */
-                /* - frame_size is lower than buffer_size   */
-                ret = EVIEWITF_FAIL;
-            } else {
-                /* Metadata are present and valid */
-                memcpy(frame_metadata, metadata, sizeof(eviewitf_frame_metadata_info_t));
-            }
-        }
-    } else {
-        /* Magic number not found, no metadata */
-        ret = EVIEWITF_FAIL;
+    return camera_check_metadata(
+        (eviewitf_frame_metadata_info_t *)(buf + buffer_size - sizeof(eviewitf_frame_metadata_info_t)), buffer_size,
+        frame_metadata);
+}
+
+eviewitf_ret_t eviewitf_camera_get_frame_view(const uint8_t *buf, uint32_t buffer_size, eviewitf_frame_view_t *view) {
+    camera_plane_t planes[EVIEWITF_FRAME_MAX_PLANES];
+    eviewitf_frame_plane_t *plane;
+    eviewitf_ret_t ret;
+    int nb_planes = 0;
+
+    if ((buf == NULL) || (view == NULL) || (buffer_size < sizeof(eviewitf_frame_metadata_info_t))) {
+        return EVIEWITF_INVALID_PARAM;
     }
 
-    if (ret != EVIEWITF_OK) {
-        /* No metadata available */
-        memset(frame_metadata, 0, sizeof(eviewitf_frame_metadata_info_t));
+    ret = camera_check_metadata(
+        (const eviewitf_frame_metadata_info_t *)(buf + buffer_size - sizeof(eviewitf_frame_metadata_info_t)),
+        buffer_size, &view->metadata);
+    if (ret == EVIEWITF_OK) {
+        nb_planes = camera_get_planes(&view->metadata, planes);
+    }
+    if (nb_planes == 0) {
+        view->nb_planes = 0;
+        return EVIEWITF_FAIL;
     }
 
-    return ret;
+    view->buffer = buf;
+    view->nb_planes = nb_planes;
+    for (int i = 0; i < nb_planes; i++) {
+        plane = &view->planes[i];
+        plane->data = buf + planes[i].offset;
+        plane->size = planes[i].size;
+        plane->stride = planes[i].stride;
+        plane->width = planes[i].width;
+        plane->height = planes[i].height;
+        plane->dt = planes[i].dt;
+    }
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_camera_find_plane(const eviewitf_frame_view_t *view, uint8_t dt,
+                                          const eviewitf_frame_plane_t **plane) {
+    const eviewitf_frame_plane_t *current;
+
+    if ((view == NULL) || (plane == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    EVIEWITF_FRAME_VIEW_FOREACH_PLANE(view, current) {
+        if (current->dt == dt) {
+            *plane = current;
+            return EVIEWITF_OK;
+        }
+    }
+
+    return EVIEWITF_FAIL;
 }
 
 /**
@@ -425,7 +1421,13 @@ eviewitf_ret_t eviewitf_camera_set_digital_gains(int cam_id, uint16_t dg_cf00, u
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
 eviewitf_ret_t eviewitf_camera_set_frame_rate(int cam_id, uint16_t fps) {
-    return mfis_ioctl_request(MFIS_DEV_CAM, cam_id, IOCSCAMRATE, &fps);
+    eviewitf_ret_t ret = mfis_ioctl_request(MFIS_DEV_CAM, cam_id, IOCSCAMRATE, &fps);
+
+    /* The frame period is read again on the next frame */
+    if ((ret == EVIEWITF_OK) && (cam_id >= 0) && (cam_id < EVIEWITF_MAX_CAMERA)) {
+        camera_reset_period(cam_id);
+    }
+    return ret;
 }
 
 /**
@@ -0,0 +1,901 @@
+/**
+ * @file eviewitf-capture.c
+ * @brief Communication API between A53 and R7 CPUs for background capture
+ * @author LACROIX Impulse
+ *
+ * Reader threads queuing the frames of the cameras as soon as they are available.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Number of buffers of a capture pool: queued frames, latest frame, held frames and frame being read
+ */
+#define CAPTURE_POOL_SIZE(nb_frames) ((nb_frames) + 1 + EVIEWITF_CAPTURE_MAX_HELD_FRAMES + 1)
+
+/**
+ * @brief Executors of the subscriptions callbacks
+ */
+#define CAPTURE_EXECUTORS (EVIEWITF_SUBSCRIBE_INLINE | EVIEWITF_SUBSCRIBE_WORKER_POOL | EVIEWITF_SUBSCRIBE_THREAD)
+
+/**
+ * @brief Size of the workers jobs queue, it cannot overflow as each job is a held frame
+ */
+#define CAPTURE_MAX_JOBS (EVIEWITF_MAX_CAMERA * EVIEWITF_CAPTURE_MAX_HELD_FRAMES)
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef capture_engine_t
+ * @brief Capture engine of a camera
+ *
+ * @struct capture_engine
+ * @brief Reader thread of a camera and queue of its captured frames
+ */
+typedef struct capture_engine {
+    pthread_mutex_t mutex;                                        /*!< Protects the whole structure */
+    pthread_cond_t cond;                                          /*!< Signaled when a frame is queued */
+    pthread_t thread;                                             /*!< Reader thread */
+    uint8_t started;                                              /*!< Capture is running */
+    uint8_t draining;                                             /*!< Capture stops once all frames are released */
+    int cam_id;                                                   /*!< Captured camera */
+    int stop_fd;                                                  /*!< Reader thread stop notification */
+    eviewitf_waitset_t *waitset;                                  /*!< Camera and stop notification wait set */
+    eviewitf_pool_t *pool;                                        /*!< Frame buffers */
+    eviewitf_pool_t *retired_pool;                                /*!< Frame buffers of the previous size, if held */
+    uint32_t buffer_size;                                         /*!< Size of a frame buffer */
+    uint32_t attributes_generation;                               /*!< Attributes generation of buffer_size */
+    eviewitf_capture_policy_t policy;                             /*!< Behavior when the queue is full */
+    uint64_t sequence;                                            /*!< Sequence number of the last captured frame */
+    uint32_t nb_held;                                             /*!< Frames held by the customer application */
+    uint8_t has_latest;                                           /*!< A frame has been captured */
+    eviewitf_capture_frame_t latest;                              /*!< Latest captured frame */
+    uint32_t depth;                                               /*!< Max number of queued frames */
+    uint32_t head;                                                /*!< Oldest queued frame */
+    uint32_t count;                                               /*!< Number of queued frames */
+    eviewitf_capture_frame_t frames[EVIEWITF_CAPTURE_MAX_FRAMES]; /*!< Queued frames */
+    eviewitf_capture_stats_t stats;                               /*!< Capture counters */
+    eviewitf_camera_callback_t callback;                          /*!< Subscription callback, NULL if none */
+    void *user_ctx;                                               /*!< Subscription user context */
+    uint32_t executor;                                            /*!< Subscription callback executor */
+    pthread_t subscriber;                                         /*!< Callback thread of EVIEWITF_SUBSCRIBE_THREAD */
+} capture_engine_t;
+
+/**
+ * @typedef capture_job_t
+ * @brief Frame to deliver to a subscription callback
+ *
+ * @struct capture_job
+ * @brief Frame to deliver to a subscription callback by the workers
+ */
+typedef struct capture_job {
+    capture_engine_t *engine;       /*!< Capture engine of the camera */
+    eviewitf_capture_frame_t frame; /*!< Held frame */
+} capture_job_t;
+
+/**
+ * @typedef capture_workers_t
+ * @brief Workers shared by the subscriptions of EVIEWITF_SUBSCRIBE_WORKER_POOL
+ *
+ * @struct capture_workers
+ * @brief Worker threads and queue of the frames to deliver
+ */
+typedef struct capture_workers {
+    pthread_mutex_t mutex;                         /*!< Protects the whole structure */
+    pthread_cond_t cond;                           /*!< Signaled when a job is queued */
+    pthread_t threads[EVIEWITF_SUBSCRIBE_WORKERS]; /*!< Worker threads */
+    int nb_threads;                                /*!< Number of running worker threads */
+    uint8_t stop;                                  /*!< Worker threads must stop */
+    uint32_t head;                                 /*!< Oldest job */
+    uint32_t count;                                /*!< Number of jobs */
+    capture_job_t jobs[CAPTURE_MAX_JOBS];          /*!< Queued jobs */
+} capture_workers_t;
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+/**
+ * @brief Capture engines of the cameras
+ */
+static capture_engine_t capture_engines[EVIEWITF_MAX_CAMERA];
+
+/**
+ * @brief Capture engines initialization control
+ */
+static pthread_once_t capture_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Serializes the capture starts and stops
+ */
+static pthread_mutex_t capture_control_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Workers shared by the subscriptions
+ */
+static capture_workers_t capture_workers = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static void capture_init(void)
+ * @brief Initialize the capture engines, conditions use the monotonic clock for timeouts
+ */
+static void capture_init(void) {
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA; i++) {
+        pthread_mutex_init(&capture_engines[i].mutex, NULL);
+        pthread_cond_init(&capture_engines[i].cond, &attr);
+        capture_engines[i].stop_fd = -1;
+    }
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @fn static capture_engine_t *capture_get_engine(int cam_id)
+ * @brief Get the capture engine of a camera
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @return pointer on the capture engine, NULL if cam_id is invalid
+ */
+static capture_engine_t *capture_get_engine(int cam_id) {
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return NULL;
+    }
+
+    pthread_once(&capture_once, capture_init);
+    return &capture_engines[cam_id];
+}
+
+/**
+ * @fn static void capture_deliver(capture_engine_t *engine, eviewitf_capture_frame_t *frame)
+ * @brief Give a held frame to the subscription callback, then release it
+ *
+ * @param engine: capture engine of the camera
+ * @param frame: held frame
+ */
+static void capture_deliver(capture_engine_t *engine, eviewitf_capture_frame_t *frame) {
+    engine->callback(engine->cam_id, frame, engine->user_ctx);
+    eviewitf_capture_release_frame(engine->cam_id, frame);
+}
+
+/**
+ * @fn static void capture_workers_push(capture_engine_t *engine, eviewitf_capture_frame_t *frame)
+ * @brief Queue a held frame to be delivered by the workers
+ *
+ * @param engine: capture engine of the camera
+ * @param frame: held frame
+ */
+static void capture_workers_push(capture_engine_t *engine, eviewitf_capture_frame_t *frame) {
+    capture_job_t *job;
+
+    pthread_mutex_lock(&capture_workers.mutex);
+    job = &capture_workers.jobs[(capture_workers.head + capture_workers.count) % CAPTURE_MAX_JOBS];
+    job->engine = engine;
+    job->frame = *frame;
+    capture_workers.count++;
+    pthread_cond_signal(&capture_workers.cond);
+    pthread_mutex_unlock(&capture_workers.mutex);
+}
+
+/**
+ * @fn static eviewitf_ret_t capture_release_buffer(capture_engine_t *engine, uint8_t *buffer)
+ * @brief Release a frame buffer of a capture engine, destroying the retired pool once its last buffer is released
+ *
+ * The caller must hold the engine mutex.
+ *
+ * @param engine: capture engine of the camera
+ * @param buffer: frame buffer, of the current or of the retired pool
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t capture_release_buffer(capture_engine_t *engine, uint8_t *buffer) {
+    eviewitf_ret_t ret;
+
+    ret = eviewitf_pool_release(engine->pool, buffer);
+    if ((ret == EVIEWITF_INVALID_PARAM) && (engine->retired_pool != NULL)) {
+        ret = eviewitf_pool_release(engine->retired_pool, buffer);
+        if ((ret == EVIEWITF_OK) && (eviewitf_pool_destroy(engine->retired_pool) == EVIEWITF_OK)) {
+            engine->retired_pool = NULL;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @fn static void capture_resize(capture_engine_t *engine, uint32_t generation)
+ * @brief Allocate the frame buffers again after the attributes of the camera have changed
+ *
+ * The queued frames, of the previous size, are dropped. The held ones stay in the retired pool until they are released,
+ * the resize is postponed while frames of an earlier retired pool are still held.
+ *
+ * @param engine: capture engine of the camera
+ * @param generation: current attributes generation
+ */
+static void capture_resize(capture_engine_t *engine, uint32_t generation) {
+    eviewitf_device_attributes_t attributes;
+    eviewitf_pool_t *pool;
+    uint8_t retired;
+
+    if ((eviewitf_camera_get_attributes(engine->cam_id, &attributes) != EVIEWITF_OK) ||
+        (attributes.buffer_size == 0)) {
+        return;
+    }
+    if (attributes.buffer_size == engine->buffer_size) {
+        engine->attributes_generation = generation;
+        return;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+    if ((engine->retired_pool != NULL) && (eviewitf_pool_destroy(engine->retired_pool) == EVIEWITF_OK)) {
+        engine->retired_pool = NULL;
+    }
+    retired = (engine->retired_pool != NULL);
+    pthread_mutex_unlock(&engine->mutex);
+    if (retired ||
+        (eviewitf_pool_create(&pool, attributes.buffer_size, CAPTURE_POOL_SIZE(engine->depth), 0) != EVIEWITF_OK)) {
+        return;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+    for (uint32_t i = 0; i < engine->count; i++) {
+        eviewitf_pool_release(engine->pool, engine->frames[(engine->head + i) % engine->depth].buffer);
+        engine->stats.nb_dropped++;
+    }
+    engine->head = 0;
+    engine->count = 0;
+    if (engine->has_latest) {
+        eviewitf_pool_release(engine->pool, engine->latest.buffer);
+        engine->has_latest = 0;
+    }
+    engine->retired_pool = engine->pool;
+    if (eviewitf_pool_destroy(engine->retired_pool) == EVIEWITF_OK) {
+        engine->retired_pool = NULL;
+    }
+    engine->pool = pool;
+    engine->buffer_size = attributes.buffer_size;
+    engine->attributes_generation = generation;
+    pthread_mutex_unlock(&engine->mutex);
+}
+
+/**
+ * @fn static void capture_read(capture_engine_t *engine)
+ * @brief Read the new frame of a camera and queue it
+ *
+ * @param engine: capture engine of the camera
+ */
+static void capture_read(capture_engine_t *engine) {
+    eviewitf_capture_frame_t frame;
+    uint8_t *released[2] = {NULL, NULL};
+    uint8_t dispatch = 0;
+    uint32_t generation;
+    eviewitf_ret_t ret;
+
+    /* The frame size may have changed, only the reader thread replaces the pool */
+    generation = device_get_attributes_generation();
+    if (generation != engine->attributes_generation) {
+        capture_resize(engine, generation);
+    }
+
+    /* Cannot fail, the pool holds enough buffers for all the frames queued or held */
+    if (eviewitf_pool_acquire(engine->pool, &frame.buffer) != EVIEWITF_OK) {
+        pthread_mutex_lock(&engine->mutex);
+        engine->stats.nb_dropped++;
+        pthread_mutex_unlock(&engine->mutex);
+        return;
+    }
+
+    frame.buffer_size = engine->buffer_size;
+    ret = eviewitf_camera_get_frame_with_metadata(engine->cam_id, frame.buffer, frame.buffer_size, &frame.metadata);
+    frame.capture_ns = stats_now_ns();
+
+    pthread_mutex_lock(&engine->mutex);
+    if ((ret != EVIEWITF_OK) || !engine->started || engine->draining) {
+        if (ret != EVIEWITF_OK) {
+            engine->stats.nb_errors++;
+        }
+        pthread_mutex_unlock(&engine->mutex);
+        eviewitf_pool_release(engine->pool, frame.buffer);
+        return;
+    }
+    engine->stats.nb_captured++;
+    frame.sequence = ++engine->sequence;
+
+    /* The latest frame holds its own reference */
+    if (engine->has_latest) {
+        released[0] = engine->latest.buffer;
+    }
+    eviewitf_pool_ref(engine->pool, frame.buffer);
+    engine->latest = frame;
+    engine->has_latest = 1;
+
+    /* Frames of subscriptions not served by a thread of their own are given to their executor instead of queued */
+    if ((engine->callback != NULL) && (engine->executor != EVIEWITF_SUBSCRIBE_THREAD)) {
+        if (engine->nb_held == EVIEWITF_CAPTURE_MAX_HELD_FRAMES) {
+            engine->stats.nb_dropped++;
+            released[1] = frame.buffer;
+        } else {
+            engine->nb_held++;
+            dispatch = 1;
+        }
+    }
+
+    /* Queue the frame, the queue reference is the one taken by the pool acquisition */
+    else if (engine->count == engine->depth) {
+        engine->stats.nb_dropped++;
+        if (engine->policy == EVIEWITF_CAPTURE_DROP_NEWEST) {
+            released[1] = frame.buffer;
+        } else {
+            released[1] = engine->frames[engine->head].buffer;
+            engine->head = (engine->head + 1) % engine->depth;
+            engine->count--;
+        }
+    }
+    if ((released[1] != frame.buffer) && !dispatch) {
+        engine->frames[(engine->head + engine->count) % engine->depth] = frame;
+        engine->count++;
+        pthread_cond_signal(&engine->cond);
+    }
+    pthread_mutex_unlock(&engine->mutex);
+
+    for (int i = 0; i < 2; i++) {
+        if (released[i] != NULL) {
+            eviewitf_pool_release(engine->pool, released[i]);
+        }
+    }
+
+    if (dispatch) {
+        if (engine->executor == EVIEWITF_SUBSCRIBE_INLINE) {
+            capture_deliver(engine, &frame);
+        } else {
+            capture_workers_push(engine, &frame);
+        }
+    }
+}
+
+/**
+ * @fn static void *capture_reader(void *arg)
+ * @brief Reader thread reading the frames of a camera as soon as they are available
+ *
+ * @param arg: capture engine of the camera
+ * @return NULL
+ */
+static void *capture_reader(void *arg) {
+    capture_engine_t *engine = arg;
+    eviewitf_waitset_event_t events[2];
+    int nb_events;
+
+    for (;;) {
+        if (eviewitf_waitset_wait(engine->waitset, -1, events, 2, &nb_events) != EVIEWITF_OK) {
+            fprintf(stderr, "%s() cannot wait for camera %d\n", __FUNCTION__, engine->cam_id);
+            break;
+        }
+
+        for (int i = 0; i < nb_events; i++) {
+            if (events[i].source == EVIEWITF_WAITSET_SOURCE_FD) {
+                return NULL;
+            }
+            capture_read(engine);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static void capture_cleanup(capture_engine_t *engine)
+ * @brief Free the resources of a capture engine whose reader thread is not running
+ *
+ * @param engine: capture engine
+ */
+static void capture_cleanup(capture_engine_t *engine) {
+    for (uint32_t i = 0; i < engine->count; i++) {
+        eviewitf_pool_release(engine->pool, engine->frames[(engine->head + i) % engine->depth].buffer);
+    }
+    if (engine->has_latest) {
+        eviewitf_pool_release(engine->pool, engine->latest.buffer);
+    }
+    engine->head = 0;
+    engine->count = 0;
+    engine->has_latest = 0;
+
+    if (engine->pool != NULL) {
+        eviewitf_pool_destroy(engine->pool);
+        engine->pool = NULL;
+    }
+    if (engine->retired_pool != NULL) {
+        eviewitf_pool_destroy(engine->retired_pool);
+        engine->retired_pool = NULL;
+    }
+    if (engine->waitset != NULL) {
+        eviewitf_waitset_destroy(engine->waitset);
+        engine->waitset = NULL;
+    }
+    if (engine->stop_fd != -1) {
+        close(engine->stop_fd);
+        engine->stop_fd = -1;
+    }
+}
+
+/**
+ * @fn static eviewitf_ret_t capture_start(capture_engine_t *engine, int cam_id, int nb_frames,
+ *                                        eviewitf_capture_policy_t policy)
+ * @brief Start the reader thread of a camera
+ *
+ * The caller must hold the control mutex.
+ *
+ * @param engine: capture engine of the camera
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param nb_frames: number of queued frames
+ * @param policy: behavior when the queue is full
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t capture_start(capture_engine_t *engine, int cam_id, int nb_frames,
+                                    eviewitf_capture_policy_t policy) {
+    eviewitf_device_attributes_t attributes;
+    eviewitf_ret_t ret;
+    int err;
+
+    if (engine->started) {
+        return EVIEWITF_FAIL;
+    }
+
+    /* Taken before the attributes, a refresh in between makes the reader thread check the size again */
+    engine->attributes_generation = device_get_attributes_generation();
+    ret = eviewitf_camera_get_attributes(cam_id, &attributes);
+    if (ret != EVIEWITF_OK) {
+        return ret;
+    }
+
+    engine->cam_id = cam_id;
+    engine->buffer_size = attributes.buffer_size;
+    engine->policy = policy;
+    engine->depth = nb_frames;
+    engine->sequence = 0;
+    engine->nb_held = 0;
+    memset(&engine->stats, 0, sizeof(engine->stats));
+
+    engine->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (engine->stop_fd < 0) {
+        fprintf(stderr, "%s() cannot create eventfd : %s\n", __FUNCTION__, strerror(errno));
+        ret = EVIEWITF_FAIL;
+    }
+    if (ret == EVIEWITF_OK) {
+        ret = eviewitf_waitset_create(&engine->waitset, 0);
+    }
+    if (ret == EVIEWITF_OK) {
+        ret = eviewitf_waitset_add_fd(engine->waitset, engine->stop_fd, POLLIN, NULL);
+    }
+    if (ret == EVIEWITF_OK) {
+        ret = eviewitf_waitset_add_camera(engine->waitset, cam_id);
+    }
+    if (ret == EVIEWITF_OK) {
+        ret = eviewitf_pool_create(&engine->pool, engine->buffer_size, CAPTURE_POOL_SIZE(nb_frames), 0);
+    }
+    if (ret == EVIEWITF_OK) {
+        pthread_mutex_lock(&engine->mutex);
+        engine->started = 1;
+        pthread_mutex_unlock(&engine->mutex);
+
+        err = pthread_create(&engine->thread, NULL, capture_reader, engine);
+        if (err != 0) {
+            fprintf(stderr, "%s() cannot create reader thread : %s\n", __FUNCTION__, strerror(err));
+            pthread_mutex_lock(&engine->mutex);
+            engine->started = 0;
+            pthread_mutex_unlock(&engine->mutex);
+            ret = EVIEWITF_FAIL;
+        }
+    }
+    if (ret != EVIEWITF_OK) {
+        capture_cleanup(engine);
+    }
+
+    return ret;
+}
+
+/**
+ * @fn static eviewitf_ret_t capture_halt(capture_engine_t *engine, uint8_t drain)
+ * @brief Stop the reader thread of a camera
+ *
+ * The caller must hold the control mutex.
+ *
+ * @param engine: capture engine of the camera
+ * @param drain: wait for the held frames to be released, instead of failing if some are held
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t capture_halt(capture_engine_t *engine, uint8_t drain) {
+    uint64_t event = 1;
+
+    pthread_mutex_lock(&engine->mutex);
+    if (!engine->started) {
+        pthread_mutex_unlock(&engine->mutex);
+        return EVIEWITF_NOT_OPENED;
+    }
+    if (drain) {
+        /* No frame can be taken anymore, the held ones are waited for */
+        engine->draining = 1;
+        pthread_cond_broadcast(&engine->cond);
+        while (engine->nb_held != 0) {
+            pthread_cond_wait(&engine->cond, &engine->mutex);
+        }
+    } else if (engine->nb_held != 0) {
+        pthread_mutex_unlock(&engine->mutex);
+        return EVIEWITF_BLOCKED;
+    }
+
+    /* No frame can be taken anymore, waiting callers are woken up */
+    engine->started = 0;
+    engine->draining = 0;
+    pthread_cond_broadcast(&engine->cond);
+    pthread_mutex_unlock(&engine->mutex);
+
+    if (write(engine->stop_fd, &event, sizeof(event)) < 0) {
+        fprintf(stderr, "%s() cannot notify reader thread : %s\n", __FUNCTION__, strerror(errno));
+    }
+    pthread_join(engine->thread, NULL);
+
+    capture_cleanup(engine);
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_capture_start(int cam_id, int nb_frames, eviewitf_capture_policy_t policy) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    eviewitf_ret_t ret;
+
+    if ((engine == NULL) || (nb_frames <= 0) || (nb_frames > EVIEWITF_CAPTURE_MAX_FRAMES) ||
+        ((policy != EVIEWITF_CAPTURE_DROP_OLDEST) && (policy != EVIEWITF_CAPTURE_DROP_NEWEST))) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&capture_control_mutex);
+    ret = capture_start(engine, cam_id, nb_frames, policy);
+    pthread_mutex_unlock(&capture_control_mutex);
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_capture_stop(int cam_id) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    eviewitf_ret_t ret;
+
+    if (engine == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&capture_control_mutex);
+    if (engine->callback != NULL) {
+        /* Subscribed cameras are stopped through eviewitf_camera_unsubscribe */
+        ret = EVIEWITF_INVALID_PARAM;
+    } else {
+        ret = capture_halt(engine, 0);
+    }
+    pthread_mutex_unlock(&capture_control_mutex);
+
+    return ret;
+}
+
+/**
+ * @fn static void *capture_worker(void *arg)
+ * @brief Worker thread delivering the frames of the subscriptions of EVIEWITF_SUBSCRIBE_WORKER_POOL
+ *
+ * Queued jobs are all delivered before the thread stops.
+ *
+ * @param arg: unused
+ * @return NULL
+ */
+static void *capture_worker(void *arg) {
+    capture_job_t job;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&capture_workers.mutex);
+        while ((capture_workers.count == 0) && !capture_workers.stop) {
+            pthread_cond_wait(&capture_workers.cond, &capture_workers.mutex);
+        }
+        if (capture_workers.count == 0) {
+            pthread_mutex_unlock(&capture_workers.mutex);
+            break;
+        }
+        job = capture_workers.jobs[capture_workers.head];
+        capture_workers.head = (capture_workers.head + 1) % CAPTURE_MAX_JOBS;
+        capture_workers.count--;
+        pthread_mutex_unlock(&capture_workers.mutex);
+
+        capture_deliver(job.engine, &job.frame);
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static eviewitf_ret_t capture_workers_start(void)
+ * @brief Start the worker threads if not already done
+ *
+ * The caller must hold the control mutex.
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t capture_workers_start(void) {
+    int err;
+
+    capture_workers.stop = 0;
+    while (capture_workers.nb_threads < EVIEWITF_SUBSCRIBE_WORKERS) {
+        err = pthread_create(&capture_workers.threads[capture_workers.nb_threads], NULL, capture_worker, NULL);
+        if (err != 0) {
+            fprintf(stderr, "%s() cannot create worker thread : %s\n", __FUNCTION__, strerror(err));
+            /* The started workers are enough to deliver the frames */
+            return (capture_workers.nb_threads != 0) ? EVIEWITF_OK : EVIEWITF_FAIL;
+        }
+        capture_workers.nb_threads++;
+    }
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static void capture_unsubscribe(capture_engine_t *engine)
+ * @brief Stop the capture of a subscribed camera once its held frames are delivered
+ *
+ * The caller must hold the control mutex.
+ *
+ * @param engine: capture engine of the camera
+ */
+static void capture_unsubscribe(capture_engine_t *engine) {
+    capture_halt(engine, 1);
+    if (engine->executor == EVIEWITF_SUBSCRIBE_THREAD) {
+        pthread_join(engine->subscriber, NULL);
+    }
+    engine->callback = NULL;
+}
+
+/**
+ * @fn static void *capture_subscriber(void *arg)
+ * @brief Thread delivering the frames of a subscription of EVIEWITF_SUBSCRIBE_THREAD
+ *
+ * @param arg: capture engine of the camera
+ * @return NULL
+ */
+static void *capture_subscriber(void *arg) {
+    capture_engine_t *engine = arg;
+    eviewitf_capture_frame_t frame;
+
+    /* Stops once the capture is draining */
+    while (eviewitf_capture_get_frame(engine->cam_id, -1, &frame) == EVIEWITF_OK) {
+        capture_deliver(engine, &frame);
+    }
+
+    return NULL;
+}
+
+eviewitf_ret_t eviewitf_camera_subscribe(int cam_id, eviewitf_camera_callback_t callback, void *user_ctx,
+                                         uint32_t flags) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    uint32_t executor = flags & CAPTURE_EXECUTORS;
+    eviewitf_ret_t ret;
+    int err;
+
+    if (executor == 0) {
+        executor = EVIEWITF_SUBSCRIBE_THREAD;
+    }
+    if ((engine == NULL) || (callback == NULL) || (flags & ~CAPTURE_EXECUTORS) || (executor & (executor - 1))) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&capture_control_mutex);
+    if (engine->started) {
+        pthread_mutex_unlock(&capture_control_mutex);
+        return EVIEWITF_FAIL;
+    }
+
+    /* Set before the reader thread starts */
+    engine->callback = callback;
+    engine->user_ctx = user_ctx;
+    engine->executor = executor;
+
+    ret = EVIEWITF_OK;
+    if (executor == EVIEWITF_SUBSCRIBE_WORKER_POOL) {
+        ret = capture_workers_start();
+    }
+    if (ret == EVIEWITF_OK) {
+        ret = capture_start(engine, cam_id, EVIEWITF_SUBSCRIBE_QUEUED_FRAMES, EVIEWITF_CAPTURE_DROP_OLDEST);
+    }
+    if ((ret == EVIEWITF_OK) && (executor == EVIEWITF_SUBSCRIBE_THREAD)) {
+        err = pthread_create(&engine->subscriber, NULL, capture_subscriber, engine);
+        if (err != 0) {
+            fprintf(stderr, "%s() cannot create subscriber thread : %s\n", __FUNCTION__, strerror(err));
+            capture_halt(engine, 1);
+            ret = EVIEWITF_FAIL;
+        }
+    }
+    if (ret != EVIEWITF_OK) {
+        engine->callback = NULL;
+    }
+    pthread_mutex_unlock(&capture_control_mutex);
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_camera_unsubscribe(int cam_id) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    if (engine == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&capture_control_mutex);
+    if (engine->callback == NULL) {
+        ret = EVIEWITF_NOT_OPENED;
+    } else {
+        capture_unsubscribe(engine);
+    }
+    pthread_mutex_unlock(&capture_control_mutex);
+
+    return ret;
+}
+
+/**
+ * @fn void capture_deinit(void)
+ * @brief Stop all the subscriptions, the worker threads and the captures
+ *
+ * Captures whose frames are still held by the customer application go on.
+ */
+void capture_deinit(void) {
+    capture_engine_t *engine;
+
+    pthread_mutex_lock(&capture_control_mutex);
+    for (int i = 0; i < EVIEWITF_MAX_CAMERA; i++) {
+        engine = capture_get_engine(i);
+        if (engine->callback != NULL) {
+            capture_unsubscribe(engine);
+        } else {
+            capture_halt(engine, 0);
+        }
+    }
+
+    pthread_mutex_lock(&capture_workers.mutex);
+    capture_workers.stop = 1;
+    pthread_cond_broadcast(&capture_workers.cond);
+    pthread_mutex_unlock(&capture_workers.mutex);
+    for (int i = 0; i < capture_workers.nb_threads; i++) {
+        pthread_join(capture_workers.threads[i], NULL);
+    }
+    capture_workers.nb_threads = 0;
+    pthread_mutex_unlock(&capture_control_mutex);
+}
+
+eviewitf_ret_t eviewitf_capture_get_frame(int cam_id, int64_t ns_timeout, eviewitf_capture_frame_t *frame) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    struct timespec deadline;
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    int err = 0;
+
+    if ((engine == NULL) || (frame == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (ns_timeout >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += ns_timeout / 1000000000;
+        deadline.tv_nsec += ns_timeout % 1000000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    /* Waiting is pointless when no frame can be handed over until one is released */
+    pthread_mutex_lock(&engine->mutex);
+    while (engine->started && !engine->draining && (engine->nb_held < EVIEWITF_CAPTURE_MAX_HELD_FRAMES) &&
+           (engine->count == 0) && (err != ETIMEDOUT)) {
+        if (ns_timeout < 0) {
+            pthread_cond_wait(&engine->cond, &engine->mutex);
+        } else {
+            err = pthread_cond_timedwait(&engine->cond, &engine->mutex, &deadline);
+        }
+    }
+
+    if (!engine->started || engine->draining) {
+        ret = EVIEWITF_NOT_OPENED;
+    } else if (engine->nb_held == EVIEWITF_CAPTURE_MAX_HELD_FRAMES) {
+        ret = EVIEWITF_TOO_MANY_HELD;
+    } else if (engine->count == 0) {
+        ret = EVIEWITF_BLOCKED;
+    } else {
+        /* The queue reference is handed over to the caller */
+        *frame = engine->frames[engine->head];
+        engine->head = (engine->head + 1) % engine->depth;
+        engine->count--;
+        engine->nb_held++;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_capture_get_latest_frame(int cam_id, eviewitf_capture_frame_t *frame) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    if ((engine == NULL) || (frame == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+    if (!engine->started || engine->draining) {
+        ret = EVIEWITF_NOT_OPENED;
+    } else if (engine->nb_held == EVIEWITF_CAPTURE_MAX_HELD_FRAMES) {
+        ret = EVIEWITF_TOO_MANY_HELD;
+    } else if (!engine->has_latest) {
+        ret = EVIEWITF_BLOCKED;
+    } else {
+        eviewitf_pool_ref(engine->pool, engine->latest.buffer);
+        *frame = engine->latest;
+        engine->nb_held++;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_capture_release_frame(int cam_id, eviewitf_capture_frame_t *frame) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+    eviewitf_ret_t ret;
+
+    if ((engine == NULL) || (frame == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+    if (engine->nb_held == 0) {
+        ret = EVIEWITF_INVALID_PARAM;
+    } else {
+        ret = capture_release_buffer(engine, frame->buffer);
+        if (ret == EVIEWITF_OK) {
+            engine->nb_held--;
+            if (engine->draining && (engine->nb_held == 0)) {
+                pthread_cond_broadcast(&engine->cond);
+            }
+        }
+    }
+    pthread_mutex_unlock(&engine->mutex);
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_capture_get_stats(int cam_id, eviewitf_capture_stats_t *stats) {
+    capture_engine_t *engine = capture_get_engine(cam_id);
+
+    if ((engine == NULL) || (stats == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+    *stats = engine->stats;
+    pthread_mutex_unlock(&engine->mutex);
+
+    return EVIEWITF_OK;
+}
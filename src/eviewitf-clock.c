@@ -0,0 +1,252 @@
+/**
+ * @file eviewitf-clock.c
+ * @brief Communication API between A53 and R7 CPUs for the R7 clock
+ * @author LACROIX Impulse
+ *
+ * Estimation of the R7 clock offset and drift from the frames arrival times. The R7 timestamps count nanoseconds, like
+ * CLOCK_MONOTONIC, so that their difference is the transfer delay and the fitted slope stays close to one.
+ *
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Duration over which the earliest frame arrival gives a synchronization point (ns)
+ */
+#define CLOCK_WINDOW_NS 1000000000ULL
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef clock_point_t
+ * @brief Synchronization point
+ *
+ * @struct clock_point
+ * @brief R7 timestamp of a frame and CLOCK_MONOTONIC time it was read
+ */
+typedef struct clock_point {
+    uint64_t timestamp;    /*!< R7 timestamp */
+    uint64_t monotonic_ns; /*!< CLOCK_MONOTONIC time (ns) */
+} clock_point_t;
+
+/**
+ * @typedef clock_estimate_t
+ * @brief Published estimation of the R7 clock
+ *
+ * @struct clock_estimate
+ * @brief Published estimation of the R7 clock, read lock free through its sequence number
+ */
+typedef struct clock_estimate {
+    uint32_t sequence;      /*!< Odd while the estimation is being updated */
+    uint8_t valid;          /*!< A frame has been read */
+    int nb_points;          /*!< Number of synchronization points */
+    uint64_t ref_timestamp; /*!< Reference R7 timestamp */
+    uint64_t ref_ns;        /*!< CLOCK_MONOTONIC time of the reference timestamp (ns) */
+    double slope;           /*!< Duration of an R7 timestamp unit (ns) */
+    uint64_t update_ns;     /*!< CLOCK_MONOTONIC time of the latest point (ns) */
+} clock_estimate_t;
+
+/**
+ * @typedef clock_points_t
+ * @brief Synchronization points
+ *
+ * @struct clock_points
+ * @brief Synchronization points and window being collected
+ */
+typedef struct clock_points {
+    pthread_mutex_t mutex;                           /*!< Protects the whole structure */
+    uint8_t has_window;                              /*!< A window is being collected */
+    uint64_t window_start_ns;                        /*!< Start of the window (ns) */
+    clock_point_t window;                            /*!< Earliest frame arrival of the window */
+    int head;                                        /*!< Oldest point */
+    int nb_points;                                   /*!< Number of points */
+    clock_point_t points[EVIEWITF_CLOCK_MAX_POINTS]; /*!< Points, one per window */
+} clock_points_t;
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+/**
+ * @brief Synchronization points
+ */
+static clock_points_t clock_points = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * @brief Published estimation
+ */
+static clock_estimate_t clock_estimate;
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static void clock_publish(const clock_point_t *ref, double slope, int nb_points, uint64_t update_ns)
+ * @brief Publish a new estimation
+ *
+ * Readers retry while the sequence number is odd or has changed during their read.
+ *
+ * @param ref: point the estimation goes through
+ * @param slope: duration of an R7 timestamp unit (ns)
+ * @param nb_points: number of synchronization points
+ * @param update_ns: CLOCK_MONOTONIC time of the latest point (ns)
+ */
+static void clock_publish(const clock_point_t *ref, double slope, int nb_points, uint64_t update_ns) {
+    __atomic_store_n(&clock_estimate.sequence, clock_estimate.sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    clock_estimate.valid = 1;
+    clock_estimate.nb_points = nb_points;
+    clock_estimate.ref_timestamp = ref->timestamp;
+    clock_estimate.ref_ns = ref->monotonic_ns;
+    clock_estimate.slope = slope;
+    clock_estimate.update_ns = update_ns;
+
+    __atomic_store_n(&clock_estimate.sequence, clock_estimate.sequence + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @fn static void clock_fit(void)
+ * @brief Fit a line through the synchronization points and publish it
+ *
+ * Least squares regression of the arrival times against the timestamps, relative to the latest point so that the
+ * values stay small enough for a double.
+ */
+static void clock_fit(void) {
+    clock_point_t *last = &clock_points.points[(clock_points.head + clock_points.nb_points - 1) %
+                                               EVIEWITF_CLOCK_MAX_POINTS];
+    clock_point_t *point;
+    clock_point_t ref = *last;
+    double mean_x = 0;
+    double mean_y = 0;
+    double var_x = 0;
+    double cov_xy = 0;
+    double slope = 1;
+    double x;
+    double y;
+
+    for (int i = 0; i < clock_points.nb_points; i++) {
+        point = &clock_points.points[(clock_points.head + i) % EVIEWITF_CLOCK_MAX_POINTS];
+        mean_x += (double)(int64_t)(point->timestamp - last->timestamp);
+        mean_y += (double)(int64_t)(point->monotonic_ns - last->monotonic_ns);
+    }
+    mean_x /= clock_points.nb_points;
+    mean_y /= clock_points.nb_points;
+
+    for (int i = 0; i < clock_points.nb_points; i++) {
+        point = &clock_points.points[(clock_points.head + i) % EVIEWITF_CLOCK_MAX_POINTS];
+        x = (double)(int64_t)(point->timestamp - last->timestamp) - mean_x;
+        y = (double)(int64_t)(point->monotonic_ns - last->monotonic_ns) - mean_y;
+        var_x += x * x;
+        cov_xy += x * y;
+    }
+
+    /* The line goes through the mean point, taken back to the latest timestamp */
+    if (var_x > 0) {
+        slope = cov_xy / var_x;
+        ref.monotonic_ns = last->monotonic_ns + (int64_t)(mean_y - slope * mean_x);
+    }
+
+    clock_publish(&ref, slope, clock_points.nb_points, last->monotonic_ns);
+}
+
+/**
+ * @fn void clock_sample(uint64_t timestamp, uint64_t monotonic_ns)
+ * @brief Account for the arrival of a frame
+ *
+ * The earliest arrival of each window, the one least delayed by the transfer and the scheduling, becomes a
+ * synchronization point. Samples are skipped rather than waited for while another thread is updating the points.
+ *
+ * @param timestamp: R7 timestamp of the frame (ns)
+ * @param monotonic_ns: CLOCK_MONOTONIC time the frame was read (ns)
+ */
+void clock_sample(uint64_t timestamp, uint64_t monotonic_ns) {
+    clock_point_t sample = {timestamp, monotonic_ns};
+
+    if ((timestamp == 0) || (pthread_mutex_trylock(&clock_points.mutex) != 0)) {
+        return;
+    }
+
+    if (!clock_points.has_window) {
+        clock_points.has_window = 1;
+        clock_points.window_start_ns = monotonic_ns;
+        clock_points.window = sample;
+    } else if ((int64_t)(monotonic_ns - timestamp) <
+               (int64_t)(clock_points.window.monotonic_ns - clock_points.window.timestamp)) {
+        clock_points.window = sample;
+    }
+
+    if (monotonic_ns - clock_points.window_start_ns >= CLOCK_WINDOW_NS) {
+        if (clock_points.nb_points == EVIEWITF_CLOCK_MAX_POINTS) {
+            clock_points.head = (clock_points.head + 1) % EVIEWITF_CLOCK_MAX_POINTS;
+            clock_points.nb_points--;
+        }
+        clock_points.points[(clock_points.head + clock_points.nb_points) % EVIEWITF_CLOCK_MAX_POINTS] =
+            clock_points.window;
+        clock_points.nb_points++;
+        clock_points.has_window = 0;
+        clock_fit();
+    } else if (clock_points.nb_points == 0) {
+        /* Until the first point, the earliest arrival so far is used */
+        clock_publish(&clock_points.window, 1, 0, monotonic_ns);
+    }
+
+    pthread_mutex_unlock(&clock_points.mutex);
+}
+
+/**
+ * @fn static uint8_t clock_read(clock_estimate_t *estimate)
+ * @brief Get a consistent copy of the published estimation
+ *
+ * @param estimate: copy of the estimation
+ * @return 1 if a frame has been read, 0 otherwise
+ */
+static uint8_t clock_read(clock_estimate_t *estimate) {
+    uint32_t sequence;
+
+    do {
+        sequence = __atomic_load_n(&clock_estimate.sequence, __ATOMIC_ACQUIRE);
+        *estimate = clock_estimate;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((sequence & 1) || (sequence != __atomic_load_n(&clock_estimate.sequence, __ATOMIC_RELAXED)));
+
+    return estimate->valid;
+}
+
+eviewitf_ret_t eviewitf_timestamp_to_monotonic(uint64_t timestamp, uint64_t *monotonic_ns) {
+    clock_estimate_t estimate;
+
+    if (monotonic_ns == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (!clock_read(&estimate)) {
+        return EVIEWITF_BLOCKED;
+    }
+
+    *monotonic_ns = estimate.ref_ns + (int64_t)((double)(int64_t)(timestamp - estimate.ref_timestamp) * estimate.slope);
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_clock_get_sync(eviewitf_clock_sync_t *sync) {
+    clock_estimate_t estimate;
+
+    if (sync == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    clock_read(&estimate);
+    sync->nb_points = estimate.nb_points;
+    sync->offset_ns = (int64_t)(estimate.ref_ns - estimate.ref_timestamp);
+    sync->drift_ppm = estimate.valid ? (estimate.slope - 1) * 1000000 : 0;
+    sync->update_ns = estimate.update_ns;
+
+    return EVIEWITF_OK;
+}
@@ -9,8 +9,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <poll.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "eviewitf-priv.h"
 #include "mfis-communication.h"
@@ -26,25 +28,161 @@
 /******************************************************************************************
  * Private structures
  ******************************************************************************************/
+/**
+ * @typedef device_class_t
+ * @brief Class of devices, whose attributes are retrieved together
+ *
+ * @enum device_class
+ * @brief Class of devices, whose attributes are retrieved together
+ */
+typedef enum device_class {
+    DEVICE_CLASS_CAMERA,  /*!< Cameras and streamers */
+    DEVICE_CLASS_BLENDER, /*!< Blenders */
+} device_class_t;
+
+/**
+ * @typedef device_snapshot_t
+ * @brief Device objects published by a refresh
+ *
+ * @struct device_snapshot
+ * @brief Device objects published by a refresh, never modified once published
+ */
+typedef struct device_snapshot {
+    struct device_snapshot *previous;              /*!< Snapshot published before this one */
+    device_object_t objects[EVIEWITF_MAX_DEVICES]; /*!< Device objects */
+} device_snapshot_t;
 
 /******************************************************************************************
  * Private enumerations
  ******************************************************************************************/
 
 /**
- * @brief Device objects
+ * @brief Device objects filled by the first retrieval of the attributes
+ */
+static device_object_t device_initial_objects[EVIEWITF_MAX_DEVICES] = {0};
+
+/**
+ * @brief Device objects in use, switched to a new snapshot by a refresh
+ */
+static device_object_t *device_objects = device_initial_objects;
+
+/**
+ * @brief Snapshots published by the refreshes, most recent first, kept as long as their objects may be in use
+ */
+static device_snapshot_t *device_snapshots;
+
+/**
+ * @brief Initialization flags
+ */
+static uint32_t device_flags;
+
+/**
+ * @brief Classes of devices whose attributes have been retrieved, bit field indexed by device_class_t
  */
-static device_object_t device_objects[EVIEWITF_MAX_DEVICES] = {0};
+static uint32_t device_loaded;
 
 /**
- * @brief File descriptors
+ * @brief Attributes retrieval mutex
  */
-static int file_descriptors[EVIEWITF_MAX_DEVICES];
+static pthread_mutex_t device_load_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Number of times the attributes of a device have changed since the library was loaded
+ */
+static uint32_t device_attributes_generation;
+
+/**
+ * @brief Default context, used by the functions without context
+ */
+static eviewitf_ctx_t device_ctx;
+
+/**
+ * @brief Default context initialization control
+ */
+static pthread_once_t device_ctx_once = PTHREAD_ONCE_INIT;
 
 /******************************************************************************************
  * Functions
  ******************************************************************************************/
 
+/**
+ * @fn void device_ctx_init(eviewitf_ctx_t *ctx)
+ * @brief Initialize a context, with no device opened
+ *
+ * @param ctx: context
+ */
+void device_ctx_init(eviewitf_ctx_t *ctx) {
+    for (int i = 0; i < EVIEWITF_MAX_DEVICES; i++) {
+        ctx->file_descriptors[i] = -1;
+        ctx->generations[i] = 0;
+        pthread_rwlock_init(&ctx->locks[i], NULL);
+    }
+}
+
+/**
+ * @fn void device_ctx_release(eviewitf_ctx_t *ctx)
+ * @brief Close the devices still opened through a context and release its resources
+ *
+ * @param ctx: context, no longer used by any other thread
+ */
+void device_ctx_release(eviewitf_ctx_t *ctx) {
+    device_object_t *device;
+
+    for (int i = 0; i < EVIEWITF_MAX_DEVICES; i++) {
+        if (ctx->file_descriptors[i] != -1) {
+            device = get_device_object(i);
+            if (device->operations.close != NULL) {
+                device->operations.close(ctx->file_descriptors[i]);
+            }
+        }
+        pthread_rwlock_destroy(&ctx->locks[i]);
+    }
+}
+
+/**
+ * @fn static void device_default_ctx_init(void)
+ * @brief Initialize the default context
+ */
+static void device_default_ctx_init(void) { device_ctx_init(&device_ctx); }
+
+/**
+ * @fn eviewitf_ctx_t *device_default_ctx(void)
+ * @brief Get the default context, used by the functions without context
+ *
+ * @return pointer on the default context
+ */
+eviewitf_ctx_t *device_default_ctx(void) {
+    pthread_once(&device_ctx_once, device_default_ctx_init);
+    return &device_ctx;
+}
+
+/**
+ * @fn static void device_lock(eviewitf_ctx_t *ctx, int device_id, uint8_t exclusive)
+ * @brief Lock the file descriptor of a device in a context
+ *
+ * Each device of each context has its own lock, so that the I/O on different devices never contend.
+ *
+ * @param ctx: context
+ * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
+ * @param exclusive: 1 to change the file descriptor, 0 to use it
+ */
+static void device_lock(eviewitf_ctx_t *ctx, int device_id, uint8_t exclusive) {
+    if (exclusive) {
+        pthread_rwlock_wrlock(&ctx->locks[device_id]);
+    } else {
+        pthread_rwlock_rdlock(&ctx->locks[device_id]);
+    }
+}
+
+/**
+ * @fn static void device_unlock(eviewitf_ctx_t *ctx, int device_id)
+ * @brief Unlock the file descriptor of a device in a context
+ *
+ * @param ctx: context
+ * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
+ */
+static void device_unlock(eviewitf_ctx_t *ctx, int device_id) { pthread_rwlock_unlock(&ctx->locks[device_id]); }
+
 /**
  * @fn int generic_close(int file_descriptor)
  * @brief close device
@@ -74,15 +212,33 @@ int generic_write(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_si
 }
 
 /**
- * @fn eviewitf_ret_t device_objects_init()
- * @brief Initialize device_objcets structure
+ * @fn static void device_set_none(device_object_t *device)
+ * @brief Set a device as not available
+ *
+ * @param device: device object
+ */
+static void device_set_none(device_object_t *device) {
+    device->attributes.type = DEVICE_TYPE_NONE;
+    device->operations.open = NULL;
+    device->operations.close = NULL;
+    device->operations.write = NULL;
+    device->operations.read = NULL;
+    device->operations.display = camera_display; /* Force display welcome screen */
+    device->operations.map = NULL;
+    device->operations.get_attributes = NULL;
+}
+
+/**
+ * @fn static eviewitf_ret_t device_load_cameras(device_object_t *objects)
+ * @brief Get the cameras and streamers attributes and set their operations
+ *
+ * @param objects: device objects to fill
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t device_objects_init() {
+static eviewitf_ret_t device_load_cameras(device_object_t *objects) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     eviewitf_mfis_camera_attributes_t cameras_attributes[EVIEWITF_MAX_CAMERA + EVIEWITF_MAX_STREAMER] = {0};
-    eviewitf_mfis_blending_attributes_t blendings_attributes[EVIEWITF_MAX_BLENDER] = {0};
 
     /* Get the cameras attributes (including streamers) */
     ret = mfis_get_cam_attributes(cameras_attributes);
@@ -90,41 +246,46 @@ eviewitf_ret_t device_objects_init() {
     if (ret == EVIEWITF_OK) {
         /* Set camera operations */
         for (int i = 0; i < EVIEWITF_MAX_CAMERA + EVIEWITF_MAX_STREAMER; i++) {
-            /* File descriptor */
-            file_descriptors[i] = -1;
             /* Copy attributes */
-            device_objects[i].attributes.buffer_size = cameras_attributes[i].buffer_size;
-            device_objects[i].attributes.dt = cameras_attributes[i].dt;
-            device_objects[i].attributes.height = cameras_attributes[i].height;
-            device_objects[i].attributes.width = cameras_attributes[i].width;
+            objects[i].attributes.buffer_size = cameras_attributes[i].buffer_size;
+            objects[i].attributes.dt = cameras_attributes[i].dt;
+            objects[i].attributes.height = cameras_attributes[i].height;
+            objects[i].attributes.width = cameras_attributes[i].width;
             /* Set operations */
             switch (cameras_attributes[i].cam_type) {
                 case EVIEWITF_MFIS_CAM_TYPE_GENERIC:
-                    device_objects[i].attributes.type = DEVICE_TYPE_CAMERA;
-                    device_objects[i].operations.open = camera_open;
-                    device_objects[i].operations.close = generic_close;
-                    device_objects[i].operations.write = NULL;
-                    device_objects[i].operations.read = camera_read;
-                    device_objects[i].operations.display = camera_display;
-                    device_objects[i].operations.get_attributes = NULL;
+                    objects[i].attributes.type = DEVICE_TYPE_CAMERA;
+                    objects[i].operations.open = camera_open;
+                    objects[i].operations.close = generic_close;
+                    objects[i].operations.write = NULL;
+                    objects[i].operations.read = camera_read;
+                    objects[i].operations.display = camera_display;
+                    objects[i].operations.map = camera_map;
+                    objects[i].operations.get_attributes = NULL;
                     break;
                 case EVIEWITF_MFIS_CAM_TYPE_VIRTUAL:
-                    device_objects[i].attributes.type = DEVICE_TYPE_STREAMER;
-                    device_objects[i].operations.open = streamer_open;
-                    device_objects[i].operations.close = generic_close;
-                    device_objects[i].operations.write = generic_write;
-                    device_objects[i].operations.read = NULL;
-                    device_objects[i].operations.display = camera_display;
-                    device_objects[i].operations.get_attributes = NULL;
+                    objects[i].attributes.type = DEVICE_TYPE_STREAMER;
+                    objects[i].operations.open = streamer_open;
+                    objects[i].operations.close = generic_close;
+                    objects[i].operations.write = generic_write;
+                    objects[i].operations.read = NULL;
+                    objects[i].operations.display = camera_display;
+                    objects[i].operations.map = NULL;
+                    objects[i].operations.get_attributes = NULL;
                     break;
                 case EVIEWITF_MFIS_CAM_TYPE_SEEK:
-                    device_objects[i].attributes.type = DEVICE_TYPE_CAMERA_SEEK;
-                    device_objects[i].operations.open = camera_seek_open;
-                    device_objects[i].operations.close = camera_seek_close;
-                    device_objects[i].operations.write = NULL;
-                    device_objects[i].operations.read = camera_seek_read;
-                    device_objects[i].operations.display = camera_seek_display;
-                    device_objects[i].operations.get_attributes = camera_seek_get_attributes;
+                    if (device_flags & EVIEWITF_INIT_NO_SEEK) {
+                        device_set_none(&objects[i]);
+                        break;
+                    }
+                    objects[i].attributes.type = DEVICE_TYPE_CAMERA_SEEK;
+                    objects[i].operations.open = camera_seek_open;
+                    objects[i].operations.close = camera_seek_close;
+                    objects[i].operations.write = NULL;
+                    objects[i].operations.read = camera_seek_read;
+                    objects[i].operations.display = camera_seek_display;
+                    objects[i].operations.map = NULL;
+                    objects[i].operations.get_attributes = camera_seek_get_attributes;
                     /* Check if there are enough seek instances available */
                     if (camera_seek_register(i) != EVIEWITF_OK) {
                         ret = EVIEWITF_OK;
@@ -132,41 +293,193 @@ eviewitf_ret_t device_objects_init() {
                     break;
 
                 default:
-                    device_objects[i].attributes.type = DEVICE_TYPE_NONE;
-                    device_objects[i].operations.open = NULL;
-                    device_objects[i].operations.close = NULL;
-                    device_objects[i].operations.write = NULL;
-                    device_objects[i].operations.read = NULL;
-                    device_objects[i].operations.display = camera_display; /* Force display welcome screen */
-                    device_objects[i].operations.get_attributes = NULL;
-
+                    device_set_none(&objects[i]);
                     break;
             }
         }
     }
 
+    return ret;
+}
+
+/**
+ * @fn static eviewitf_ret_t device_load_blenders(device_object_t *objects)
+ * @brief Get the blenders attributes and set their operations
+ *
+ * @param objects: device objects to fill
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t device_load_blenders(device_object_t *objects) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    eviewitf_mfis_blending_attributes_t blendings_attributes[EVIEWITF_MAX_BLENDER] = {0};
+
     /* Get the blendings attributes */
-    if (ret == EVIEWITF_OK) {
-        ret = mfis_get_blend_attributes(blendings_attributes);
-    }
+    ret = mfis_get_blend_attributes(blendings_attributes);
 
     /* Fill device structure */
     if (ret == EVIEWITF_OK) {
         for (int i = 0; i < EVIEWITF_MAX_BLENDER; i++) {
-            /* File descriptor */
-            file_descriptors[i + EVIEWITF_OFFSET_BLENDER] = -1;
             /* Copy attributes */
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].attributes.buffer_size = blendings_attributes[i].buffer_size;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].attributes.dt = blendings_attributes[i].dt;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].attributes.height = blendings_attributes[i].height;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].attributes.width = blendings_attributes[i].width;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].attributes.type = DEVICE_TYPE_BLENDER;
+            objects[i + EVIEWITF_OFFSET_BLENDER].attributes.buffer_size = blendings_attributes[i].buffer_size;
+            objects[i + EVIEWITF_OFFSET_BLENDER].attributes.dt = blendings_attributes[i].dt;
+            objects[i + EVIEWITF_OFFSET_BLENDER].attributes.height = blendings_attributes[i].height;
+            objects[i + EVIEWITF_OFFSET_BLENDER].attributes.width = blendings_attributes[i].width;
+            objects[i + EVIEWITF_OFFSET_BLENDER].attributes.type = DEVICE_TYPE_BLENDER;
             /* Set operations */
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].operations.open = blender_open;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].operations.close = generic_close;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].operations.write = generic_write;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].operations.read = NULL;
-            device_objects[i + EVIEWITF_OFFSET_BLENDER].operations.display = NULL;
+            objects[i + EVIEWITF_OFFSET_BLENDER].operations.open = blender_open;
+            objects[i + EVIEWITF_OFFSET_BLENDER].operations.close = generic_close;
+            objects[i + EVIEWITF_OFFSET_BLENDER].operations.write = generic_write;
+            objects[i + EVIEWITF_OFFSET_BLENDER].operations.read = NULL;
+            objects[i + EVIEWITF_OFFSET_BLENDER].operations.display = NULL;
+            objects[i + EVIEWITF_OFFSET_BLENDER].operations.map = NULL;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @fn static eviewitf_ret_t device_load(device_class_t device_class)
+ * @brief Get the attributes of a class of devices, once
+ *
+ * @param device_class: class of devices
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t device_load(device_class_t device_class) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    uint64_t start_ns;
+
+    if (__atomic_load_n(&device_loaded, __ATOMIC_ACQUIRE) & (1 << device_class)) {
+        return EVIEWITF_OK;
+    }
+
+    pthread_mutex_lock(&device_load_mutex);
+    if (!(device_loaded & (1 << device_class))) {
+        start_ns = stats_now_ns();
+        /* The objects of a class are not used before they are loaded */
+        if (device_class == DEVICE_CLASS_CAMERA) {
+            ret = device_load_cameras(device_objects);
+            init_trace("cameras and streamers attributes retrieved", start_ns);
+        } else {
+            ret = device_load_blenders(device_objects);
+            init_trace("blenders attributes retrieved", start_ns);
+        }
+        /* Retried on next use on failure */
+        if (ret == EVIEWITF_OK) {
+            __atomic_or_fetch(&device_loaded, 1 << device_class, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&device_load_mutex);
+
+    return ret;
+}
+
+/**
+ * @fn eviewitf_ret_t device_refresh(void)
+ * @brief Retrieve again the attributes of the classes of devices already retrieved
+ *
+ * The opened devices are left untouched. The attributes are retrieved into a new snapshot of the device objects, which
+ * replaces the one in use if any of them has changed, the attributes generation being then incremented. The objects in
+ * use are never modified, as they are read without lock: the replaced snapshots are freed on the next initialization.
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t device_refresh(void) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    device_snapshot_t *snapshot;
+    device_attributes_t *previous;
+    device_attributes_t *current;
+    uint8_t changed = 0;
+    uint64_t start_ns;
+
+    snapshot = malloc(sizeof(device_snapshot_t));
+    if (snapshot == NULL) {
+        return EVIEWITF_FAIL;
+    }
+
+    pthread_mutex_lock(&device_load_mutex);
+
+    memcpy(snapshot->objects, device_objects, sizeof(snapshot->objects));
+    start_ns = stats_now_ns();
+    if (device_loaded & (1 << DEVICE_CLASS_CAMERA)) {
+        ret = device_load_cameras(snapshot->objects);
+    }
+    if ((ret == EVIEWITF_OK) && (device_loaded & (1 << DEVICE_CLASS_BLENDER))) {
+        ret = device_load_blenders(snapshot->objects);
+    }
+    init_trace("attributes refreshed", start_ns);
+
+    for (int i = 0; (ret == EVIEWITF_OK) && (i < EVIEWITF_MAX_DEVICES); i++) {
+        previous = &device_objects[i].attributes;
+        current = &snapshot->objects[i].attributes;
+        if ((previous->type != current->type) || (previous->buffer_size != current->buffer_size) ||
+            (previous->width != current->width) || (previous->height != current->height) ||
+            (previous->dt != current->dt)) {
+            changed = 1;
+        }
+    }
+
+    /* Published before the generation, so that a new generation always comes with its attributes */
+    if (changed) {
+        snapshot->previous = device_snapshots;
+        device_snapshots = snapshot;
+        __atomic_store_n(&device_objects, snapshot->objects, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&device_attributes_generation, 1, __ATOMIC_RELEASE);
+    } else {
+        free(snapshot);
+    }
+
+    pthread_mutex_unlock(&device_load_mutex);
+
+    return ret;
+}
+
+/**
+ * @fn uint32_t device_get_attributes_generation(void)
+ * @brief Get the number of times the attributes of a device have changed
+ *
+ * @return attributes generation
+ */
+uint32_t device_get_attributes_generation(void) {
+    return __atomic_load_n(&device_attributes_generation, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @fn eviewitf_ret_t device_objects_init(uint32_t flags)
+ * @brief Initialize device_objcets structure
+ *
+ * @param flags: initialization flags, EVIEWITF_INIT_* values
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t device_objects_init(uint32_t flags) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    eviewitf_ctx_t *ctx = device_default_ctx();
+    device_snapshot_t *snapshot;
+
+    /* File descriptors */
+    for (int i = 0; i < EVIEWITF_MAX_DEVICES; i++) {
+        __atomic_store_n(&ctx->file_descriptors[i], -1, __ATOMIC_RELEASE);
+    }
+
+    /* Attributes retrieved again, now or on first use, the snapshots of the previous initialization are not used */
+    pthread_mutex_lock(&device_load_mutex);
+    device_flags = flags;
+    __atomic_store_n(&device_loaded, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&device_objects, device_initial_objects, __ATOMIC_RELEASE);
+    while (device_snapshots != NULL) {
+        snapshot = device_snapshots;
+        device_snapshots = snapshot->previous;
+        free(snapshot);
+    }
+    pthread_mutex_unlock(&device_load_mutex);
+
+    if (!(flags & EVIEWITF_INIT_LAZY)) {
+        ret = device_load(DEVICE_CLASS_CAMERA);
+        if ((ret == EVIEWITF_OK) && !(flags & EVIEWITF_INIT_NO_BLENDER)) {
+            ret = device_load(DEVICE_CLASS_BLENDER);
         }
     }
 
@@ -177,6 +490,8 @@ eviewitf_ret_t device_objects_init() {
  * @fn device_object_t *get_device_object(int device_id)
  * @brief Get a pointer on the device object
  *
+ * The attributes of the class of the device are retrieved on first use when the initialization is lazy.
+ *
  * @param [in] device_id: device id
  *
  * @return pointer on device object structure
@@ -185,29 +500,42 @@ device_object_t *get_device_object(int device_id) {
     if (device_id < 0 || device_id >= EVIEWITF_MAX_DEVICES) {
         return NULL;
     }
-    return &device_objects[device_id];
+
+    if (eviewitf_is_initialized()) {
+        if (device_id < EVIEWITF_OFFSET_BLENDER) {
+            device_load(DEVICE_CLASS_CAMERA);
+        } else if (!(device_flags & EVIEWITF_INIT_NO_BLENDER)) {
+            device_load(DEVICE_CLASS_BLENDER);
+        }
+    }
+
+    return &__atomic_load_n(&device_objects, __ATOMIC_ACQUIRE)[device_id];
 }
 
 /**
- * @fn eviewitf_ret_t device_open(int device_id)
+ * @fn eviewitf_ret_t device_open(eviewitf_ctx_t *ctx, int device_id)
  * @brief Open a device
  *
+ * @param ctx: context the device is opened through
  * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
  *        we assume this value has been tested by the caller
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t device_open(int device_id) {
+eviewitf_ret_t device_open(eviewitf_ctx_t *ctx, int device_id) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     device_object_t *device;
+    int fd;
 
     /* Test API has been initialized */
     if (eviewitf_is_initialized() == 0) {
-        ret = EVIEWITF_NOT_INITIALIZED;
+        return EVIEWITF_NOT_INITIALIZED;
     }
 
+    device_lock(ctx, device_id, 1);
+
     /* Test already open */
-    else if (file_descriptors[device_id] != -1) {
+    if (ctx->file_descriptors[device_id] != -1) {
         ret = EVIEWITF_FAIL;
     }
 
@@ -217,31 +545,39 @@ eviewitf_ret_t device_open(int device_id) {
         if (device->operations.open == NULL) {
             ret = EVIEWITF_FAIL;
         } else {
-            file_descriptors[device_id] = device->operations.open(device_id);
-            if (file_descriptors[device_id] == -1) {
-                return EVIEWITF_FAIL;
+            fd = device->operations.open(device_id);
+            if (fd == -1) {
+                ret = EVIEWITF_FAIL;
+            } else {
+                __atomic_store_n(&ctx->file_descriptors[device_id], fd, __ATOMIC_RELEASE);
+                __atomic_add_fetch(&ctx->generations[device_id], 1, __ATOMIC_RELEASE);
             }
         }
     }
 
+    device_unlock(ctx, device_id);
     return ret;
 }
 
 /**
- * @fn eviewitf_ret_t device_close(int device_id)
+ * @fn eviewitf_ret_t device_close(eviewitf_ctx_t *ctx, int device_id)
  * @brief Close a device
  *
+ * @param ctx: context the device is opened through
  * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
  *        we assume this value has been tested by the caller
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t device_close(int device_id) {
+eviewitf_ret_t device_close(eviewitf_ctx_t *ctx, int device_id) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     device_object_t *device;
 
+    /* Wait for the I/O in progress on the device */
+    device_lock(ctx, device_id, 1);
+
     // Test device has been opened
-    if (file_descriptors[device_id] == -1) {
+    if (ctx->file_descriptors[device_id] == -1) {
         ret = EVIEWITF_NOT_OPENED;
     }
 
@@ -250,55 +586,52 @@ eviewitf_ret_t device_close(int device_id) {
         if (device->operations.close == NULL) {
             ret = EVIEWITF_FAIL;
         } else {
-            if (device->operations.close(file_descriptors[device_id]) != 0) {
+            if (device->operations.close(ctx->file_descriptors[device_id]) != 0) {
                 ret = EVIEWITF_FAIL;
             } else {
-                file_descriptors[device_id] = -1;
+                __atomic_store_n(&ctx->file_descriptors[device_id], -1, __ATOMIC_RELEASE);
             }
         }
     }
 
+    device_unlock(ctx, device_id);
     return ret;
 }
 
 /**
- * @fn eviewitf_ret_t device_seek(int device_id, off_t offset, int whence)
- * @brief Copy frame from physical memory to the given buffer location
+ * @fn eviewitf_ret_t device_readv(eviewitf_ctx_t *ctx, int device_id, const iovec_t *iov, int iovcnt, off_t offset)
+ * @brief Copy a part of the frame from physical memory to the given buffers, in a single operation
  *
+ * The read is positional, it does not depend on nor change a file offset shared by the readers of the device.
+ *
+ * @param ctx: context the device is opened through
  * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
  *        we assume this value has been tested by the caller
- * @param offset: offset for seek operation (SEEK_SET)
- * @param whence: seek mode (SEEK_CUR / SEEK_CUR / SEEK_END)
+ * @param iov: buffers to fill in, in order
+ * @param iovcnt: number of buffers
+ * @param offset: offset in the frame to read from
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t device_seek(int device_id, off_t offset, int whence) {
+eviewitf_ret_t device_readv(eviewitf_ctx_t *ctx, int device_id, const iovec_t *iov, int iovcnt, off_t offset) {
     eviewitf_ret_t ret = EVIEWITF_OK;
+    device_object_t *device;
+    ssize_t size = 0;
 
-    if (lseek(file_descriptors[device_id], offset, whence) != offset) {
-        ret = EVIEWITF_FAIL;
+    if ((iov == NULL) || (iovcnt <= 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_base == NULL) {
+            return EVIEWITF_INVALID_PARAM;
+        }
+        size += iov[i].iov_len;
     }
 
-    return ret;
-}
-/**
- * @fn eviewitf_ret_t device_read(int device_id, uint8_t *frame_buffer, uint32_t buffer_size)
- * @brief Copy frame from physical memory to the given buffer location
- *
- * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
- *        we assume this value has been tested by the caller
- * @param frame_buffer: buffer to store the incoming frame
- * @param buffer_size: buffer size for coherency check
- *
- * @return return code as specified by the eviewitf_ret_t enumeration.
- */
-eviewitf_ret_t device_read(int device_id, uint8_t *frame_buffer, uint32_t buffer_size) {
-    eviewitf_ret_t ret = EVIEWITF_OK;
-    device_object_t *device;
+    /* The device cannot be closed, and its file descriptor reused, during the read */
+    device_lock(ctx, device_id, 0);
 
-    if (frame_buffer == NULL) {
-        ret = EVIEWITF_INVALID_PARAM;
-    } else if (file_descriptors[device_id] == -1) {
+    if (ctx->file_descriptors[device_id] == -1) {
         ret = EVIEWITF_NOT_OPENED;
     }
 
@@ -307,21 +640,42 @@ eviewitf_ret_t device_read(int device_id, uint8_t *frame_buffer, uint32_t buffer
         if (device->operations.read == NULL) {
             ret = EVIEWITF_FAIL;
         } else {
-            /* Then read */
-            if (device->operations.read(file_descriptors[device_id], frame_buffer, buffer_size) !=
-                (ssize_t)buffer_size) {
+            if (device->operations.read(ctx->file_descriptors[device_id], iov, iovcnt, offset) != size) {
                 ret = EVIEWITF_FAIL;
             }
         }
     }
 
+    device_unlock(ctx, device_id);
     return ret;
 }
 
 /**
- * @fn device_write(int device_id, uint8_t *frame_buffer, uint32_t buffer_size)
+ * @fn eviewitf_ret_t device_read(eviewitf_ctx_t *ctx, int device_id, uint8_t *frame_buffer, uint32_t buffer_size,
+ *                                off_t offset)
+ * @brief Copy frame from physical memory to the given buffer location
+ *
+ * @param ctx: context the device is opened through
+ * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
+ *        we assume this value has been tested by the caller
+ * @param frame_buffer: buffer to store the incoming frame
+ * @param buffer_size: buffer size for coherency check
+ * @param offset: offset in the frame to read from
+ *
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t device_read(eviewitf_ctx_t *ctx, int device_id, uint8_t *frame_buffer, uint32_t buffer_size,
+                           off_t offset) {
+    iovec_t iov = {.iov_base = frame_buffer, .iov_len = buffer_size};
+
+    return device_readv(ctx, device_id, &iov, 1, offset);
+}
+
+/**
+ * @fn device_write(eviewitf_ctx_t *ctx, int device_id, uint8_t *frame_buffer, uint32_t buffer_size)
  * @brief Write a frame to a blender
 
+ * @param ctx: context the device is opened through
  * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
  *        we assume this value has been tested by the caller
  * @param frame_buffer: device frame buffer
@@ -329,15 +683,17 @@ eviewitf_ret_t device_read(int device_id, uint8_t *frame_buffer, uint32_t buffer
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t device_write(int device_id, uint8_t *frame_buffer, uint32_t buffer_size) {
+eviewitf_ret_t device_write(eviewitf_ctx_t *ctx, int device_id, uint8_t *frame_buffer, uint32_t buffer_size) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     device_object_t *device;
 
     if (frame_buffer == NULL) {
-        ret = EVIEWITF_INVALID_PARAM;
+        return EVIEWITF_INVALID_PARAM;
     }
 
-    else if (file_descriptors[device_id] == -1) {
+    device_lock(ctx, device_id, 0);
+
+    if (ctx->file_descriptors[device_id] == -1) {
         ret = EVIEWITF_NOT_OPENED;
     }
 
@@ -346,64 +702,93 @@ eviewitf_ret_t device_write(int device_id, uint8_t *frame_buffer, uint32_t buffe
         if (device->operations.write == NULL) {
             ret = EVIEWITF_FAIL;
         } else {
-            if (device->operations.write(file_descriptors[device_id], frame_buffer, buffer_size) !=
+            if (device->operations.write(ctx->file_descriptors[device_id], frame_buffer, buffer_size) !=
                 (ssize_t)buffer_size) {
                 ret = EVIEWITF_FAIL;
             }
         }
     }
 
+    device_unlock(ctx, device_id);
     return ret;
 }
 
 /**
- * @fn eviewitf_ret_t device_poll(int *device_id, int nb_devices, int ms_timeout, short *event_return)
- * @brief Poll on multiple cameras to check a new frame is available
+ * @fn eviewitf_ret_t device_map(eviewitf_ctx_t *ctx, int device_id, uint8_t **frame_buffer, uint32_t buffer_size)
+ * @brief Map the frame buffer of a device in the process memory
  *
- * @param device_id: table of device ids to poll between 0 and EVIEWITF_MAX_DEVICES
- *        we assume those values has been tested by the caller
- * @param nb_devices: number of devices on which the polling applies
- * @param ms_timeout: number of millisecond the function should block waiting for a frame, negative value means infinite
- * @param event_return: detected events for each device, 0 if no frame, 1 if a frame is available
-
- * @return return code as specified by the eviewitf_ret_t enumeration.
+ * @param ctx: context the device is opened through
+ * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
+ *        we assume this value has been tested by the caller
+ * @param frame_buffer: mapped frame buffer, to be unmapped with munmap
+ * @param buffer_size: size of the frame buffer
+ *
+ * @return EVIEWITF_FAIL if the device cannot be mapped, otherwise return code as specified by the eviewitf_ret_t
+ * enumeration.
  */
-eviewitf_ret_t device_poll(int *device_id, int nb_devices, int ms_timeout, short *event_return) {
-    pollfd_t pfd[nb_devices];
-    int r_poll;
+eviewitf_ret_t device_map(eviewitf_ctx_t *ctx, int device_id, uint8_t **frame_buffer, uint32_t buffer_size) {
     eviewitf_ret_t ret = EVIEWITF_OK;
-    int i;
+    device_object_t *device;
 
-    if (event_return == NULL) {
+    if (frame_buffer == NULL) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    for (i = 0; i < nb_devices; i++) {
-        if (ret >= EVIEWITF_OK) {
-            if (file_descriptors[device_id[i]] == -1) {
-                ret = EVIEWITF_NOT_OPENED;
-            }
-            pfd[i].fd = file_descriptors[device_id[i]];
-            pfd[i].events = POLLIN;
-        }
-    }
+    device_lock(ctx, device_id, 0);
 
-    if (ret >= EVIEWITF_OK) {
-        r_poll = poll(pfd, nb_devices, ms_timeout);
-        if (r_poll == -1) {
-            ret = EVIEWITF_FAIL;
-        }
+    if (ctx->file_descriptors[device_id] == -1) {
+        ret = EVIEWITF_NOT_OPENED;
     }
 
-    for (i = 0; i < nb_devices; i++) {
-        if (ret >= EVIEWITF_OK) {
-            event_return[i] = pfd[i].revents & POLLIN;
+    else {
+        device = get_device_object(device_id);
+        if (device->operations.map == NULL) {
+            ret = EVIEWITF_FAIL;
+        } else {
+            *frame_buffer = device->operations.map(ctx->file_descriptors[device_id], buffer_size);
+            if (*frame_buffer == NULL) {
+                ret = EVIEWITF_FAIL;
+            }
         }
     }
 
+    device_unlock(ctx, device_id);
     return ret;
 }
 
+/**
+ * @fn int device_get_fd(eviewitf_ctx_t *ctx, int device_id)
+ * @brief Get the file descriptor of an opened device
+ *
+ * @param ctx: context the device is opened through
+ * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
+ *        we assume this value has been tested by the caller
+ *
+ * The device may be closed once the function returns, device_get_generation tells whether the file descriptor is still
+ * the one of the device.
+ *
+ * @return file descriptor of the device, -1 if the device is not opened
+ */
+int device_get_fd(eviewitf_ctx_t *ctx, int device_id) {
+    return __atomic_load_n(&ctx->file_descriptors[device_id], __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @fn uint32_t device_get_generation(eviewitf_ctx_t *ctx, int device_id)
+ * @brief Get the number of times a device has been opened
+ *
+ * Allows to detect a device has been closed and reopened, and thus its file descriptor may have changed.
+ *
+ * @param ctx: context the device is opened through
+ * @param device_id: id of the device between 0 and EVIEWITF_MAX_DEVICES
+ *        we assume this value has been tested by the caller
+ *
+ * @return generation of the device
+ */
+uint32_t device_get_generation(eviewitf_ctx_t *ctx, int device_id) {
+    return __atomic_load_n(&ctx->generations[device_id], __ATOMIC_ACQUIRE);
+}
+
 /**
  * @fn eviewitf_ret_t device_get_attributes(int device_id, eviewitf_device_attributes_t *attributes)
  * @brief Get device attributes such as buffer size
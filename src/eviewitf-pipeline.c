@@ -6,6 +6,7 @@
  * API to communicate with the R7 pipeline from the A53 (Linux).
  *
  */
+#include <stdio.h>
 #include <unistd.h>
 
 #include "eviewitf-priv.h"
@@ -63,6 +64,11 @@ eviewitf_ret_t eviewitf_pipeline_configure(uint8_t pipeline_id, uint32_t frame_w
     pipeline_geometry_t geometry = {.height = frame_height, .width = frame_width};
     ret = mfis_ioctl_request(MFIS_DEV_PIPELINE, pipeline_id, IOCSPIPELINECONFIGURE, &geometry);
 
+    /* The frame size of the cameras fed by the pipeline may have changed, the pipeline is configured anyway */
+    if ((ret == EVIEWITF_OK) && eviewitf_is_initialized() && (device_refresh() != EVIEWITF_OK)) {
+        fprintf(stderr, "%s() cannot retrieve the devices attributes again\n", __FUNCTION__);
+    }
+
     return ret;
 }
 
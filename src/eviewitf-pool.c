@@ -0,0 +1,203 @@
+/**
+ * @file eviewitf-pool.c
+ * @brief Communication API between A53 and R7 CPUs for frame buffer pools
+ * @author LACROIX Impulse
+ *
+ * Preallocated and aligned frame buffers, shared through reference counts.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Size of a huge page, a huge pages mapping size must be a multiple of it
+ */
+#define POOL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @struct eviewitf_pool
+ * @brief Frame buffer pool
+ */
+struct eviewitf_pool {
+    pthread_mutex_t mutex;                         /*!< Protects the free buffers stack */
+    uint8_t *base;                                 /*!< Mapping holding all the buffers */
+    size_t mapping_size;                           /*!< Size of the mapping */
+    size_t stride;                                 /*!< Distance between two buffers */
+    int nb_buffers;                                /*!< Number of buffers */
+    int nb_free;                                   /*!< Number of free buffers */
+    int free_buffers[EVIEWITF_POOL_MAX_BUFFERS];   /*!< Stack of free buffers indexes */
+    uint32_t refcounts[EVIEWITF_POOL_MAX_BUFFERS]; /*!< References on each buffer */
+};
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static int pool_get_index(eviewitf_pool_t *pool, uint8_t *buffer)
+ * @brief Get the index of a buffer of a pool
+ *
+ * @param pool: pool
+ * @param buffer: buffer
+ * @return index of the buffer, -1 if the buffer is not one of the pool
+ */
+static int pool_get_index(eviewitf_pool_t *pool, uint8_t *buffer) {
+    size_t offset;
+
+    if ((buffer < pool->base) || (buffer >= pool->base + pool->stride * pool->nb_buffers)) {
+        return -1;
+    }
+
+    offset = buffer - pool->base;
+    if ((offset % pool->stride) != 0) {
+        return -1;
+    }
+
+    return offset / pool->stride;
+}
+
+eviewitf_ret_t eviewitf_pool_create(eviewitf_pool_t **pool, uint32_t buffer_size, int nb_buffers, uint32_t flags) {
+    eviewitf_pool_t *new_pool;
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    uint8_t *base = MAP_FAILED;
+    size_t mapping_size;
+    size_t stride;
+
+    if ((pool == NULL) || (buffer_size == 0) || (nb_buffers <= 0) || (nb_buffers > EVIEWITF_POOL_MAX_BUFFERS) ||
+        (flags & ~EVIEWITF_POOL_HUGE_PAGES)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    /* Page aligned buffers are also cache line aligned */
+    stride = (buffer_size + page_size - 1) & ~(page_size - 1);
+
+    /* Buffers are populated at creation so that no page fault occurs while capturing */
+    if (flags & EVIEWITF_POOL_HUGE_PAGES) {
+        mapping_size = (stride * nb_buffers + POOL_HUGE_PAGE_SIZE - 1) & ~((size_t)POOL_HUGE_PAGE_SIZE - 1);
+        base = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    }
+    if (base == MAP_FAILED) {
+        mapping_size = stride * nb_buffers;
+        base = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (base == MAP_FAILED) {
+            return EVIEWITF_FAIL;
+        }
+    }
+
+    new_pool = calloc(1, sizeof(eviewitf_pool_t));
+    if (new_pool == NULL) {
+        munmap(base, mapping_size);
+        return EVIEWITF_FAIL;
+    }
+
+    pthread_mutex_init(&new_pool->mutex, NULL);
+    new_pool->base = base;
+    new_pool->mapping_size = mapping_size;
+    new_pool->stride = stride;
+    new_pool->nb_buffers = nb_buffers;
+    new_pool->nb_free = nb_buffers;
+    for (int i = 0; i < nb_buffers; i++) {
+        new_pool->free_buffers[i] = nb_buffers - 1 - i;
+    }
+
+    *pool = new_pool;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_pool_destroy(eviewitf_pool_t *pool) {
+    if (pool == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->nb_free != pool->nb_buffers) {
+        pthread_mutex_unlock(&pool->mutex);
+        return EVIEWITF_BLOCKED;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    munmap(pool->base, pool->mapping_size);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_pool_acquire(eviewitf_pool_t *pool, uint8_t **buffer) {
+    int index;
+
+    if ((pool == NULL) || (buffer == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->nb_free == 0) {
+        pthread_mutex_unlock(&pool->mutex);
+        return EVIEWITF_BLOCKED;
+    }
+    index = pool->free_buffers[--pool->nb_free];
+    __atomic_store_n(&pool->refcounts[index], 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&pool->mutex);
+
+    *buffer = pool->base + pool->stride * index;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_pool_ref(eviewitf_pool_t *pool, uint8_t *buffer) {
+    uint32_t refcount;
+    int index;
+
+    if ((pool == NULL) || ((index = pool_get_index(pool, buffer)) < 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    /* A free buffer cannot be referenced again */
+    refcount = __atomic_load_n(&pool->refcounts[index], __ATOMIC_RELAXED);
+    do {
+        if (refcount == 0) {
+            return EVIEWITF_INVALID_PARAM;
+        }
+    } while (!__atomic_compare_exchange_n(&pool->refcounts[index], &refcount, refcount + 1, 1, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED));
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_pool_release(eviewitf_pool_t *pool, uint8_t *buffer) {
+    uint32_t refcount;
+    int index;
+
+    if ((pool == NULL) || ((index = pool_get_index(pool, buffer)) < 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    refcount = __atomic_load_n(&pool->refcounts[index], __ATOMIC_RELAXED);
+    do {
+        if (refcount == 0) {
+            return EVIEWITF_INVALID_PARAM;
+        }
+    } while (!__atomic_compare_exchange_n(&pool->refcounts[index], &refcount, refcount - 1, 1, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+
+    /* Last reference dropped, the buffer is free again */
+    if (refcount == 1) {
+        pthread_mutex_lock(&pool->mutex);
+        pool->free_buffers[pool->nb_free++] = index;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    return EVIEWITF_OK;
+}
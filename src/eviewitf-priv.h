@@ -8,6 +8,9 @@
 #define EVIEWITF_PRIV_H
 
 #include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <pthread.h>
 
 #include "eviewitf.h"
 
@@ -41,14 +44,18 @@
 #define FRAME_MAGIC_NUMBER 0xD1CECA5F
 
 /**
- * @brief Device camera name
+ * @brief Device camera name, may be overridden at build time to use stub devices
  */
+#ifndef DEVICE_CAMERA_NAME
 #define DEVICE_CAMERA_NAME "/dev/mfis_cam%d"
+#endif
 
 /**
- * @brief Device blender name
+ * @brief Device blender name, may be overridden at build time to use stub devices
  */
+#ifndef DEVICE_BLENDER_NAME
 #define DEVICE_BLENDER_NAME "/dev/mfis_O%d"
+#endif
 
 /**
  * @brief Device camera name maximum length
@@ -132,6 +139,12 @@ typedef struct sockaddr_un sockaddr_un_t;
  */
 typedef struct pollfd pollfd_t;
 
+/**
+ * @typedef iovec_t
+ * @brief iovec structure typedef*
+ */
+typedef struct iovec iovec_t;
+
 /**
  * @typedef dirent_t
  * @brief dirent structure typedef*
@@ -171,9 +184,11 @@ typedef struct device_operations {
     eviewitf_ret_t (*close)(int file_descriptor); /*!< Operation to be performed on close request */
     eviewitf_ret_t (*write)(int file_descriptor, uint8_t *frame_buffer,
                             uint32_t buffer_size); /*!< Called when a frame is written to a device */
-    eviewitf_ret_t (*read)(int file_descriptor, uint8_t *frame_buffer,
-                           uint32_t buffer_size); /*!< Called when a frame is read from a device */
+    eviewitf_ret_t (*read)(int file_descriptor, const iovec_t *iov, int iovcnt,
+                           off_t offset); /*!< Called when a frame is read from a device, at the given offset */
     eviewitf_ret_t (*display)(int device_id);     /*!< Called when the device is selected for display */
+    uint8_t *(*map)(int file_descriptor,
+                    uint32_t buffer_size); /*!< Map the device frame buffer, NULL if the device cannot be mapped */
     eviewitf_ret_t (*get_attributes)(int device_id,
                                      eviewitf_device_attributes_t *attributes); /*!< Get device attributes */
 
@@ -191,35 +206,79 @@ typedef struct device_object {
     device_operations_t operations; /*!< Device operations */
 } device_object_t;
 
+/**
+ * @struct eviewitf_ctx
+ * @brief Library context, owning the handles of the devices opened through it
+ */
+struct eviewitf_ctx {
+    int file_descriptors[EVIEWITF_MAX_DEVICES];   /*!< File descriptors, -1 if the device is not opened */
+    uint32_t generations[EVIEWITF_MAX_DEVICES];   /*!< Number of times each device has been opened */
+    pthread_rwlock_t locks[EVIEWITF_MAX_DEVICES]; /*!< Held for writing on open and close, for reading on I/O */
+};
+
 /******************************************************************************************
  * Private Functions Prototypes
  ******************************************************************************************/
 eviewitf_ret_t eviewitf_app_reset_camera(int cam_id);
-eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, char *record_path);
-eviewitf_ret_t eviewitf_app_streamer_play(int cam_id, int fps, char *frames_dir);
+eviewitf_ret_t eviewitf_app_record_cam(int cam_id, int delay, int legacy, char *record_path);
+eviewitf_ret_t eviewitf_app_streamer_play(int cam_id, int fps, int catch_up, char *frames_dir);
 eviewitf_ret_t eviewitf_app_set_blending_from_file(int blender_id, char *frame);
 eviewitf_ret_t eviewitf_app_print_monitoring_info(void);
 
 /* Common */
 eviewitf_ret_t eviewitf_is_initialized();
+void init_trace(const char *step, uint64_t start_ns);
 
 /* Devices */
-eviewitf_ret_t device_objects_init();
+eviewitf_ret_t device_objects_init(uint32_t flags);
+eviewitf_ret_t device_refresh(void);
+uint32_t device_get_attributes_generation(void);
 device_object_t *get_device_object(int device_id);
 eviewitf_ret_t device_get_attributes(int device_id, eviewitf_device_attributes_t *attributes);
-eviewitf_ret_t device_open(int device_id);
-eviewitf_ret_t device_close(int device_id);
-eviewitf_ret_t device_seek(int device_id, off_t offset, int whence);
-eviewitf_ret_t device_read(int device_id, uint8_t *frame_buffer, uint32_t buffer_size);
-eviewitf_ret_t device_write(int device_id, uint8_t *frame_buffer, uint32_t buffer_size);
-eviewitf_ret_t device_poll(int *device_id, int nb_devices, int ms_timeout, short *event_return);
+eviewitf_ctx_t *device_default_ctx(void);
+void device_ctx_init(eviewitf_ctx_t *ctx);
+void device_ctx_release(eviewitf_ctx_t *ctx);
+eviewitf_ret_t device_open(eviewitf_ctx_t *ctx, int device_id);
+eviewitf_ret_t device_close(eviewitf_ctx_t *ctx, int device_id);
+eviewitf_ret_t device_read(eviewitf_ctx_t *ctx, int device_id, uint8_t *frame_buffer, uint32_t buffer_size,
+                           off_t offset);
+eviewitf_ret_t device_readv(eviewitf_ctx_t *ctx, int device_id, const iovec_t *iov, int iovcnt, off_t offset);
+eviewitf_ret_t device_write(eviewitf_ctx_t *ctx, int device_id, uint8_t *frame_buffer, uint32_t buffer_size);
+eviewitf_ret_t device_map(eviewitf_ctx_t *ctx, int device_id, uint8_t **frame_buffer, uint32_t buffer_size);
+int device_get_fd(eviewitf_ctx_t *ctx, int device_id);
+uint32_t device_get_generation(eviewitf_ctx_t *ctx, int device_id);
+
+/* Batch */
+eviewitf_ret_t batch_submit_blocked(eviewitf_batch_t *batch);
+
+/* Asynchronous requests */
+void async_deinit(void);
+
+/* Camera frames */
+void camera_deinit(void);
+
+/* Background capture */
+void capture_deinit(void);
+
+/* Statistics */
+uint64_t stats_now_ns(void);
+void stats_record(uint8_t devtype, uint8_t cmd, eviewitf_ret_t result, uint64_t start_ns);
+void stats_camera_wake(int cam_id);
+void stats_camera_frame(int cam_id, const eviewitf_frame_metadata_info_t *metadata, uint64_t period_ns);
+
+/* R7 clock */
+void clock_sample(uint64_t timestamp, uint64_t monotonic_ns);
+
+/* Recording files */
+void recording_advise_frame(eviewitf_recording_t *recording, uint32_t index);
 
 /* Blender */
 eviewitf_ret_t blender_open(int device_id);
 
 /* Camera */
 eviewitf_ret_t camera_open(int device_id);
-eviewitf_ret_t camera_read(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_size);
+eviewitf_ret_t camera_read(int file_descriptor, const iovec_t *iov, int iovcnt, off_t offset);
+uint8_t *camera_map(int file_descriptor, uint32_t buffer_size);
 eviewitf_ret_t camera_display(int device_id);
 
 /* Streamer */
@@ -259,16 +318,17 @@ eviewitf_ret_t camera_seek_open(int device_id);
 eviewitf_ret_t camera_seek_close(int file_descriptor);
 
 /**
- * @fn int camera_seek_read(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_size)
+ * @fn int camera_seek_read(int file_descriptor, const iovec_t *iov, int iovcnt, off_t offset)
  * @brief Read from a seek camera
  *
  * @param file_descriptor: file descriptor on an opened device
- * @param frame_buffer: buffer containing the frame
- * @param buffer_size: size of the frame
+ * @param iov: buffers to fill in, in order
+ * @param iovcnt: number of buffers
+ * @param offset: offset in the frame to read from
  *
  * @return the number of read bytes or -1
  */
-eviewitf_ret_t camera_seek_read(int file_descriptor, uint8_t *frame_buffer, uint32_t buffer_size);
+eviewitf_ret_t camera_seek_read(int file_descriptor, const iovec_t *iov, int iovcnt, off_t offset);
 
 /**
  * @fn eviewitf_ret_t camera_seek_display(int cam_id)
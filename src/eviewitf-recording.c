@@ -0,0 +1,484 @@
+/**
+ * @file eviewitf-recording.c
+ * @brief Recording files
+ * @author LACROIX Impulse
+ *
+ * Single file container of the frames of a camera: a header holding the device attributes, the frames appended one
+ * after the other, each preceded by a record of its index entry, then the index of the frames, written when the
+ * recording is closed. The index of a recording that has not been closed is rebuilt from the records.
+ *
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Marks a recording file, "EVRC" in the file
+ */
+#define RECORDING_MAGIC 0x43525645
+
+/**
+ * @brief Marks a frame record, "EVRF" in the file
+ */
+#define RECORDING_RECORD_MAGIC 0x46525645
+
+/**
+ * @brief Version of the file layout
+ */
+#define RECORDING_VERSION 2
+
+/**
+ * @brief Number of index entries first allocated, doubled whenever the index is full
+ */
+#define RECORDING_INDEX_CHUNK 1024
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef recording_header_t
+ * @brief Recording file header
+ *
+ * @struct recording_header
+ * @brief Recording file header, at the beginning of the file
+ */
+typedef struct recording_header {
+    uint32_t magic;        /*!< RECORDING_MAGIC */
+    uint32_t version;      /*!< RECORDING_VERSION */
+    uint32_t buffer_size;  /*!< Buffer size of the recorded device */
+    uint32_t width;        /*!< Frame width of the recorded device (in pixels) */
+    uint32_t height;       /*!< Frame height of the recorded device (in pixels) */
+    uint32_t dt;           /*!< Data type of the recorded device */
+    uint32_t nb_frames;    /*!< Number of frames */
+    uint32_t reserved;     /*!< Reserved, 0 */
+    uint64_t index_offset; /*!< Offset of the index in the file, 0 until the recording is closed */
+} recording_header_t;
+
+/**
+ * @typedef recording_record_t
+ * @brief Frame record
+ *
+ * @struct recording_record
+ * @brief Frame record, right before the frame in the file
+ */
+typedef struct recording_record {
+    uint32_t magic;                       /*!< RECORDING_RECORD_MAGIC */
+    uint32_t reserved;                    /*!< Reserved, 0 */
+    eviewitf_recording_frame_info_t info; /*!< Index entry of the frame, its offset being right after the record */
+} recording_record_t;
+
+/**
+ * @struct eviewitf_recording
+ * @brief Recording file
+ */
+struct eviewitf_recording {
+    int fd;                                 /*!< File descriptor */
+    uint8_t writing;                        /*!< Created for writing */
+    recording_header_t header;              /*!< File header */
+    eviewitf_recording_frame_info_t *index; /*!< Index of the frames */
+    uint32_t index_capacity;                /*!< Number of entries allocated for the index */
+    uint64_t data_end;                      /*!< End of the frames in the file */
+};
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static eviewitf_ret_t recording_pwrite(int fd, const void *data, size_t size, uint64_t offset)
+ * @brief Write a whole block of data at a given offset
+ *
+ * @param fd: file descriptor
+ * @param data: data to write
+ * @param size: size of the data
+ * @param offset: offset in the file
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t recording_pwrite(int fd, const void *data, size_t size, uint64_t offset) {
+    const uint8_t *cursor = data;
+    ssize_t written;
+
+    while (size != 0) {
+        written = pwrite(fd, cursor, size, offset);
+        if (written <= 0) {
+            return EVIEWITF_FAIL;
+        }
+        cursor += written;
+        size -= written;
+        offset += written;
+    }
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static eviewitf_ret_t recording_pread(int fd, void *data, size_t size, uint64_t offset)
+ * @brief Read a whole block of data at a given offset
+ *
+ * @param fd: file descriptor
+ * @param data: buffer to fill
+ * @param size: size of the data
+ * @param offset: offset in the file
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t recording_pread(int fd, void *data, size_t size, uint64_t offset) {
+    uint8_t *cursor = data;
+    ssize_t nb_read;
+
+    while (size != 0) {
+        nb_read = pread(fd, cursor, size, offset);
+        if (nb_read <= 0) {
+            return EVIEWITF_FAIL;
+        }
+        cursor += nb_read;
+        size -= nb_read;
+        offset += nb_read;
+    }
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static int recording_free(eviewitf_recording_t *recording)
+ * @brief Close the file of a recording and free it
+ *
+ * @param recording: recording
+ * @return 0 on success, -1 if the file could not be closed
+ */
+static int recording_free(eviewitf_recording_t *recording) {
+    int ret = close(recording->fd);
+
+    free(recording->index);
+    free(recording);
+
+    return ret;
+}
+
+/**
+ * @fn static eviewitf_ret_t recording_index_reserve(eviewitf_recording_t *recording)
+ * @brief Make room for one more entry in the index of a recording
+ *
+ * @param recording: recording
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t recording_index_reserve(eviewitf_recording_t *recording) {
+    eviewitf_recording_frame_info_t *index;
+    uint32_t capacity;
+
+    if (recording->header.nb_frames == recording->index_capacity) {
+        capacity = (recording->index_capacity == 0) ? RECORDING_INDEX_CHUNK : recording->index_capacity * 2;
+        index = realloc(recording->index, capacity * sizeof(eviewitf_recording_frame_info_t));
+        if (index == NULL) {
+            return EVIEWITF_FAIL;
+        }
+        recording->index = index;
+        recording->index_capacity = capacity;
+    }
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static eviewitf_ret_t recording_write_record(eviewitf_recording_t *recording, const recording_record_t *record,
+ *                                                 const uint8_t *frame)
+ * @brief Append a frame and its record at the end of the frames, with a single system call unless it is interrupted
+ *
+ * @param recording: recording created through eviewitf_recording_create
+ * @param record: record of the frame
+ * @param frame: frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t recording_write_record(eviewitf_recording_t *recording, const recording_record_t *record,
+                                             const uint8_t *frame) {
+    struct iovec iov[2] = {{(void *)record, sizeof(recording_record_t)}, {(void *)frame, record->info.size}};
+    uint64_t offset = recording->data_end;
+    ssize_t written;
+
+    written = pwritev(recording->fd, iov, 2, offset);
+    if (written < 0) {
+        return EVIEWITF_FAIL;
+    }
+
+    /* Complete a partial write */
+    if ((size_t)written < sizeof(recording_record_t)) {
+        if (recording_pwrite(recording->fd, (const uint8_t *)record + written, sizeof(recording_record_t) - written,
+                             offset + written) != EVIEWITF_OK) {
+            return EVIEWITF_FAIL;
+        }
+        written = sizeof(recording_record_t);
+    }
+    written -= sizeof(recording_record_t);
+
+    return recording_pwrite(recording->fd, frame + written, record->info.size - written,
+                            offset + sizeof(recording_record_t) + written);
+}
+
+/**
+ * @fn static eviewitf_ret_t recording_scan(eviewitf_recording_t *recording)
+ * @brief Rebuild the index of a recording that has not been closed from its frame records
+ *
+ * The frames are read up to the first incomplete one, the end of an interrupted recording.
+ *
+ * @param recording: recording being opened
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t recording_scan(eviewitf_recording_t *recording) {
+    recording_record_t record;
+    struct stat st;
+    uint64_t offset = sizeof(recording_header_t);
+
+    if (fstat(recording->fd, &st) < 0) {
+        return EVIEWITF_FAIL;
+    }
+
+    recording->header.nb_frames = 0;
+    while ((offset + sizeof(recording_record_t) <= (uint64_t)st.st_size) &&
+           (recording_pread(recording->fd, &record, sizeof(recording_record_t), offset) == EVIEWITF_OK)) {
+        if ((record.magic != RECORDING_RECORD_MAGIC) || (record.info.offset != offset + sizeof(recording_record_t)) ||
+            (record.info.size > (uint64_t)st.st_size - record.info.offset)) {
+            break;
+        }
+        if (recording_index_reserve(recording) != EVIEWITF_OK) {
+            return EVIEWITF_FAIL;
+        }
+        recording->index[recording->header.nb_frames] = record.info;
+        recording->header.nb_frames++;
+        offset = record.info.offset + record.info.size;
+    }
+    recording->data_end = offset;
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn void recording_advise_frame(eviewitf_recording_t *recording, uint32_t index)
+ * @brief Ask the kernel to start reading a frame in the page cache
+ *
+ * @param recording: recording opened through eviewitf_recording_open
+ * @param index: frame number, ignored beyond the end of the recording
+ */
+void recording_advise_frame(eviewitf_recording_t *recording, uint32_t index) {
+    eviewitf_recording_frame_info_t *info;
+
+    if (!recording->writing && (index < recording->header.nb_frames)) {
+        info = &recording->index[index];
+        posix_fadvise(recording->fd, info->offset, info->size, POSIX_FADV_WILLNEED);
+    }
+}
+
+eviewitf_ret_t eviewitf_recording_create(eviewitf_recording_t **recording, const char *path,
+                                         const eviewitf_device_attributes_t *attributes) {
+    eviewitf_recording_t *new_recording;
+
+    if ((recording == NULL) || (path == NULL) || (attributes == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    new_recording = calloc(1, sizeof(eviewitf_recording_t));
+    if (new_recording == NULL) {
+        return EVIEWITF_FAIL;
+    }
+
+    new_recording->fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0666);
+    if (new_recording->fd == -1) {
+        free(new_recording);
+        return EVIEWITF_FAIL;
+    }
+
+    new_recording->writing = 1;
+    new_recording->header.magic = RECORDING_MAGIC;
+    new_recording->header.version = RECORDING_VERSION;
+    new_recording->header.buffer_size = attributes->buffer_size;
+    new_recording->header.width = attributes->width;
+    new_recording->header.height = attributes->height;
+    new_recording->header.dt = attributes->dt;
+    new_recording->data_end = sizeof(recording_header_t);
+
+    /* Without an index offset, the file is not valid until it is closed */
+    if (recording_pwrite(new_recording->fd, &new_recording->header, sizeof(recording_header_t), 0) != EVIEWITF_OK) {
+        recording_free(new_recording);
+        return EVIEWITF_FAIL;
+    }
+
+    *recording = new_recording;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_recording_write_frame(eviewitf_recording_t *recording, const uint8_t *frame, uint32_t size,
+                                              const eviewitf_frame_metadata_info_t *metadata) {
+    recording_record_t record = {0};
+
+    if ((recording == NULL) || !recording->writing || (frame == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    if (recording_index_reserve(recording) != EVIEWITF_OK) {
+        return EVIEWITF_FAIL;
+    }
+
+    record.magic = RECORDING_RECORD_MAGIC;
+    record.info.offset = recording->data_end + sizeof(recording_record_t);
+    record.info.size = size;
+    if (metadata != NULL) {
+        record.info.timestamp = ((uint64_t)metadata->frame_timestamp_msb << 32) | metadata->frame_timestamp_lsb;
+        record.info.frame_sync = metadata->frame_sync;
+    }
+
+    /* The record makes the frame part of the recording even if it is never closed */
+    if (recording_write_record(recording, &record, frame) != EVIEWITF_OK) {
+        return EVIEWITF_FAIL;
+    }
+
+    recording->index[recording->header.nb_frames] = record.info;
+    recording->data_end = record.info.offset + size;
+    recording->header.nb_frames++;
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_recording_open(eviewitf_recording_t **recording, const char *path) {
+    eviewitf_recording_t *new_recording;
+    recording_header_t *header;
+    eviewitf_recording_frame_info_t *info;
+
+    if ((recording == NULL) || (path == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    new_recording = calloc(1, sizeof(eviewitf_recording_t));
+    if (new_recording == NULL) {
+        return EVIEWITF_FAIL;
+    }
+
+    new_recording->fd = open(path, O_RDONLY);
+    if (new_recording->fd == -1) {
+        free(new_recording);
+        return EVIEWITF_FAIL;
+    }
+
+    header = &new_recording->header;
+    if ((recording_pread(new_recording->fd, header, sizeof(recording_header_t), 0) != EVIEWITF_OK) ||
+        (header->magic != RECORDING_MAGIC) || (header->version != RECORDING_VERSION)) {
+        recording_free(new_recording);
+        return EVIEWITF_FAIL;
+    }
+
+    /* The recording has been interrupted before its index was written */
+    if (header->index_offset == 0) {
+        if (recording_scan(new_recording) != EVIEWITF_OK) {
+            recording_free(new_recording);
+            return EVIEWITF_FAIL;
+        }
+        *recording = new_recording;
+        return EVIEWITF_OK;
+    }
+
+    new_recording->index_capacity = header->nb_frames;
+    new_recording->data_end = header->index_offset;
+    if (header->nb_frames != 0) {
+        new_recording->index = malloc(header->nb_frames * sizeof(eviewitf_recording_frame_info_t));
+        if ((new_recording->index == NULL) ||
+            (recording_pread(new_recording->fd, new_recording->index,
+                             header->nb_frames * sizeof(eviewitf_recording_frame_info_t),
+                             header->index_offset) != EVIEWITF_OK)) {
+            recording_free(new_recording);
+            return EVIEWITF_FAIL;
+        }
+    }
+
+    /* The frames must lie between the header and the index */
+    for (uint32_t i = 0; i < header->nb_frames; i++) {
+        info = &new_recording->index[i];
+        if ((info->offset < sizeof(recording_header_t)) || (info->offset > header->index_offset) ||
+            (info->size > header->index_offset - info->offset)) {
+            recording_free(new_recording);
+            return EVIEWITF_FAIL;
+        }
+    }
+
+    *recording = new_recording;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_recording_close(eviewitf_recording_t *recording) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    if (recording == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    /* The header is written last, so that the index is only used once it is complete */
+    if (recording->writing) {
+        recording->header.index_offset = recording->data_end;
+        ret = recording_pwrite(recording->fd, recording->index,
+                               recording->header.nb_frames * sizeof(eviewitf_recording_frame_info_t),
+                               recording->data_end);
+        if (ret == EVIEWITF_OK) {
+            ret = recording_pwrite(recording->fd, &recording->header, sizeof(recording_header_t), 0);
+        }
+    }
+
+    if (recording_free(recording) != 0) {
+        ret = EVIEWITF_FAIL;
+    }
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_recording_get_attributes(eviewitf_recording_t *recording,
+                                                 eviewitf_device_attributes_t *attributes) {
+    if ((recording == NULL) || (attributes == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    attributes->buffer_size = recording->header.buffer_size;
+    attributes->width = recording->header.width;
+    attributes->height = recording->header.height;
+    attributes->dt = recording->header.dt;
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_recording_get_nb_frames(eviewitf_recording_t *recording, uint32_t *nb_frames) {
+    if ((recording == NULL) || (nb_frames == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    *nb_frames = recording->header.nb_frames;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_recording_get_frame_info(eviewitf_recording_t *recording, uint32_t index,
+                                                 eviewitf_recording_frame_info_t *info) {
+    if ((recording == NULL) || (info == NULL) || (index >= recording->header.nb_frames)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    *info = recording->index[index];
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_recording_read_frame(eviewitf_recording_t *recording, uint32_t index, uint8_t *buffer,
+                                             uint32_t size) {
+    eviewitf_recording_frame_info_t *info;
+
+    if ((recording == NULL) || recording->writing || (buffer == NULL) || (index >= recording->header.nb_frames)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    info = &recording->index[index];
+    if (size > info->size) {
+        size = info->size;
+    }
+
+    return recording_pread(recording->fd, buffer, size, info->offset);
+}
@@ -7,8 +7,10 @@
  *
  */
 
+#include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -24,10 +26,86 @@
 #define SSD_SIZE_DIR_NAME_PATTERN 7
 #define SSD_SIZE_MOUNT_POINT      9
 #define ONE_SEC_NS                1000000000
+#define SSD_PREFETCH_FRAMES       8
+
+/**
+ * @typedef ssd_play_stats_t
+ * @brief Playback statistics
+ *
+ * @struct ssd_play_stats
+ * @brief Playback statistics, the jitter being the delay of a write after its deadline
+ */
+typedef struct ssd_play_stats {
+    uint32_t nb_played;     /*!< Number of frames written */
+    uint32_t nb_late;       /*!< Number of frames whose period was over when they could be written */
+    uint32_t nb_skipped;    /*!< Number of frames skipped to stay on time */
+    uint32_t nb_underruns;  /*!< Number of times the playback had to wait for a frame to be read */
+    uint64_t jitter_sum_ns; /*!< Sum of the jitter of the written frames (ns) */
+    uint64_t jitter_max_ns; /*!< Max jitter of the written frames (ns) */
+} ssd_play_stats_t;
+
+/**
+ * @typedef ssd_prefetch_t
+ * @brief Prefetch pipeline
+ *
+ * @struct ssd_prefetch
+ * @brief Ring of the frames read ahead of the playback by the prefetch thread
+ */
+typedef struct ssd_prefetch {
+    pthread_t thread;                     /*!< Prefetch thread */
+    pthread_mutex_t mutex;                /*!< Protects the ring and the state */
+    pthread_cond_t cond;                  /*!< Signaled when a frame is pushed, popped or released */
+    char *frames_directory;               /*!< Path to the recording */
+    eviewitf_recording_t *recording;      /*!< Recording file, NULL for the legacy layout */
+    uint32_t buffer_size;                 /*!< Size of a frame */
+    eviewitf_pool_t *pool;                /*!< Frame buffers */
+    uint8_t *frames[SSD_PREFETCH_FRAMES]; /*!< Frames read ahead */
+    int head;                             /*!< Oldest frame of the ring */
+    int nb_frames;                        /*!< Number of frames in the ring */
+    int next_id;                          /*!< Next frame to read */
+    int end;                              /*!< 1 at the end of the recording, -1 on read error */
+    uint8_t stop;                         /*!< The playback is over */
+    uint32_t nb_underruns;                /*!< Number of times the playback found the ring empty */
+} ssd_prefetch_t;
 
 static const char *SSD_MOUNT_POINT = "/mnt/ssd/";
 static const char *SSD_DIR_NAME_PATTERN = "frames_";
 
+/**
+ * @fn static eviewitf_ret_t ssd_buffer_alloc(uint32_t size, eviewitf_pool_t **pool, uint8_t **buffer)
+ * @brief Allocate a page aligned frame buffer
+ *
+ * @param size: size of the buffer
+ * @param pool: pool holding the buffer
+ * @param buffer: allocated buffer
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t ssd_buffer_alloc(uint32_t size, eviewitf_pool_t **pool, uint8_t **buffer) {
+    eviewitf_ret_t ret;
+
+    ret = eviewitf_pool_create(pool, size, 1, 0);
+    if (ret == EVIEWITF_OK) {
+        ret = eviewitf_pool_acquire(*pool, buffer);
+        if (ret != EVIEWITF_OK) {
+            eviewitf_pool_destroy(*pool);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @fn static void ssd_buffer_free(eviewitf_pool_t *pool, uint8_t *buffer)
+ * @brief Free a frame buffer allocated by ssd_buffer_alloc
+ *
+ * @param pool: pool holding the buffer
+ * @param buffer: buffer
+ */
+static void ssd_buffer_free(eviewitf_pool_t *pool, uint8_t *buffer) {
+    eviewitf_pool_release(pool, buffer);
+    eviewitf_pool_destroy(pool);
+}
+
 eviewitf_ret_t eviewitf_ssd_get_output_directory(char **storage_directory) {
     DIR *dir;
     dirent_t *dirp;
@@ -73,16 +151,47 @@ eviewitf_ret_t eviewitf_ssd_get_output_directory(char **storage_directory) {
     return EVIEWITF_OK;
 }
 
-int eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directory, uint32_t size) {
+/**
+ * @fn static eviewitf_ret_t ssd_write_frame(char *frames_directory, int frame_id, uint8_t *buffer, uint32_t size)
+ * @brief Write a frame of a recording in its own file, as in the legacy layout
+ *
+ * @param frames_directory: path to the recording
+ * @param frame_id: frame number
+ * @param buffer: frame
+ * @param size: size of the frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t ssd_write_frame(char *frames_directory, int frame_id, uint8_t *buffer, uint32_t size) {
+    char filename_ssd[SSD_MAX_FILENAME_SIZE];
+    int file_ssd;
+    ssize_t test_rw;
+
+    snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%d", frames_directory, frame_id);
+    file_ssd = open(filename_ssd, O_CREAT | O_RDWR, 0666);
+    if ((-1) == file_ssd) {
+        return EVIEWITF_FAIL;
+    }
+    test_rw = write(file_ssd, buffer, size);
+    close(file_ssd);
+
+    return (test_rw == size) ? EVIEWITF_OK : EVIEWITF_FAIL;
+}
+
+eviewitf_ret_t eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directory, uint32_t size,
+                                          ssd_layout_t layout) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
     int frame_id = 0;
-    int file_ssd = 0;
     char filename_ssd[SSD_MAX_FILENAME_SIZE];
     timespec_t res_start;
     timespec_t res_run;
     timespec_t difft = {0};
     stat_t st;
-    char *buff_f;
+    eviewitf_pool_t *pool;
+    uint8_t *buff_f;
     short revents;
+    eviewitf_device_attributes_t attributes;
+    eviewitf_frame_metadata_info_t metadata;
+    eviewitf_recording_t *recording = NULL;
 
     // Create frame directory if not existing (and it should not exist)
     if (stat(frames_directory, &st) == -1) {
@@ -97,12 +206,24 @@ int eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directo
         printf("Error opening device\n");
         return EVIEWITF_FAIL;
     }
-    buff_f = malloc(size);
-    if (buff_f == NULL) {
+    if (ssd_buffer_alloc(size, &pool, &buff_f) != EVIEWITF_OK) {
         printf("Error Unable to allocate buffer\n");
         eviewitf_camera_close(camera_id);
         return EVIEWITF_FAIL;
     }
+    if (layout == SSD_LAYOUT_RECORDING) {
+        snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%s", frames_directory, EVIEWITF_RECORDING_FILENAME);
+        ret = eviewitf_camera_get_attributes(camera_id, &attributes);
+        if (ret == EVIEWITF_OK) {
+            ret = eviewitf_recording_create(&recording, filename_ssd, &attributes);
+        }
+        if (ret != EVIEWITF_OK) {
+            printf("Error creating the recording file\n");
+            ssd_buffer_free(pool, buff_f);
+            eviewitf_camera_close(camera_id);
+            return EVIEWITF_FAIL;
+        }
+    }
     while (difft.tv_sec < duration) {
         if (eviewitf_camera_poll(&camera_id, 1, 2000, &revents) != EVIEWITF_OK) {
             printf("Error polling device\n");
@@ -110,22 +231,25 @@ int eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directo
         }
 
         if (revents) {
-            snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%d", frames_directory, frame_id);
-            file_ssd = open(filename_ssd, O_CREAT | O_RDWR, 0666);
-            eviewitf_camera_get_frame(camera_id, (uint8_t *)buff_f, size);
-            if (write(file_ssd, buff_f, size) != size) {
+            if (recording != NULL) {
+                /* The timestamp and frame_sync of the frame go to the index */
+                ret = eviewitf_camera_get_frame_with_metadata(camera_id, buff_f, size, &metadata);
+                if (ret == EVIEWITF_OK) {
+                    ret = eviewitf_recording_write_frame(recording, buff_f, size, &metadata);
+                }
+            } else {
+                eviewitf_camera_get_frame(camera_id, buff_f, size);
+                ret = ssd_write_frame(frames_directory, frame_id, buff_f, size);
+            }
+            if (ret != EVIEWITF_OK) {
                 printf("Got an issue writing frame on disk\n");
-                free(buff_f);
-                eviewitf_camera_close(camera_id);
-                return EVIEWITF_FAIL;
+                break;
             }
-            close(file_ssd);
 
             if (clock_gettime(CLOCK_MONOTONIC, &res_run) != 0) {
                 printf("Got an issue with system clock aborting \n");
-                free(buff_f);
-                eviewitf_camera_close(camera_id);
-                return EVIEWITF_FAIL;
+                ret = EVIEWITF_FAIL;
+                break;
             }
 
             if ((res_run.tv_nsec - res_start.tv_nsec) < 0) {
@@ -142,27 +266,323 @@ int eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directo
         }
     }
 
-    free(buff_f);
-    printf("Time elapsed %lds:%03ld ms, catched %d frames \n", difft.tv_sec, difft.tv_nsec / 100000, frame_id);
+    /* The index is written at the end of the recording file, sparing the records scan on playback */
+    if ((recording != NULL) && (eviewitf_recording_close(recording) != EVIEWITF_OK)) {
+        printf("Got an issue writing the recording index on disk\n");
+        ret = EVIEWITF_FAIL;
+    }
+    ssd_buffer_free(pool, buff_f);
+    if (ret == EVIEWITF_OK) {
+        printf("Time elapsed %lds:%03ld ms, catched %d frames \n", difft.tv_sec, difft.tv_nsec / 100000, frame_id);
+    }
     if (eviewitf_camera_close(camera_id) != EVIEWITF_OK) {
         printf("Error closing device\n");
         return EVIEWITF_FAIL;
     }
+    return ret;
+}
+
+/**
+ * @fn static void ssd_sleep_until(uint64_t deadline_ns)
+ * @brief Sleep until an absolute CLOCK_MONOTONIC time
+ *
+ * @param deadline_ns: time to wake up at (ns)
+ */
+static void ssd_sleep_until(uint64_t deadline_ns) {
+    timespec_t deadline = {.tv_sec = deadline_ns / ONE_SEC_NS, .tv_nsec = deadline_ns % ONE_SEC_NS};
+
+    /* Absolute deadline, an interrupted sleep is simply restarted */
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+}
+
+/**
+ * @fn static int ssd_read_frame(char *frames_directory, int frame_id, uint8_t *buffer, uint32_t size)
+ * @brief Read a frame of a recording
+ *
+ * @param frames_directory: path to the recording
+ * @param frame_id: frame number
+ * @param buffer: buffer to fill
+ * @param size: size of the buffer
+ * @return 1 if the frame has been read, 0 at the end of the recording, -1 on error
+ */
+static int ssd_read_frame(char *frames_directory, int frame_id, uint8_t *buffer, uint32_t size) {
+    char filename_ssd[SSD_MAX_FILENAME_SIZE];
+    int file_ssd;
+    int test_rw;
+
+    /* Open the file (an open fail means "end of the recording") */
+    snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%d", frames_directory, frame_id);
+    file_ssd = open(filename_ssd, O_RDONLY);
+    if ((-1) == file_ssd) {
+        return 0;
+    }
+
+    /* Read the frame from the file  */
+    test_rw = read(file_ssd, buffer, size);
+    close(file_ssd);
+
+    return ((-1) == test_rw) ? -1 : 1;
+}
+
+/**
+ * @fn static int ssd_read_recording_frame(eviewitf_recording_t *recording, int frame_id, uint8_t *buffer,
+ *                                        uint32_t size)
+ * @brief Read a frame of a recording file
+ *
+ * @param recording: recording file
+ * @param frame_id: frame number
+ * @param buffer: buffer to fill
+ * @param size: size of the buffer
+ * @return 1 if the frame has been read, 0 at the end of the recording, -1 on error
+ */
+static int ssd_read_recording_frame(eviewitf_recording_t *recording, int frame_id, uint8_t *buffer, uint32_t size) {
+    uint32_t nb_frames;
+
+    eviewitf_recording_get_nb_frames(recording, &nb_frames);
+    if ((uint32_t)frame_id >= nb_frames) {
+        return 0;
+    }
+
+    return (eviewitf_recording_read_frame(recording, frame_id, buffer, size) == EVIEWITF_OK) ? 1 : -1;
+}
+
+/**
+ * @fn static void ssd_advise_frame(const char *frames_directory, int frame_id)
+ * @brief Ask the kernel to start reading a frame of a recording in the page cache
+ *
+ * @param frames_directory: path to the recording
+ * @param frame_id: frame number
+ */
+static void ssd_advise_frame(const char *frames_directory, int frame_id) {
+    char filename_ssd[SSD_MAX_FILENAME_SIZE];
+    int file_ssd;
+
+    snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%d", frames_directory, frame_id);
+    file_ssd = open(filename_ssd, O_RDONLY);
+    if ((-1) != file_ssd) {
+        /* The read-ahead goes on once the file is closed */
+        posix_fadvise(file_ssd, 0, 0, POSIX_FADV_WILLNEED);
+        close(file_ssd);
+    }
+}
+
+/**
+ * @fn static void *ssd_prefetch_reader(void *arg)
+ * @brief Prefetch thread, reading the frames of a recording ahead of the playback
+ *
+ * @param arg: prefetch pipeline
+ * @return NULL
+ */
+static void *ssd_prefetch_reader(void *arg) {
+    ssd_prefetch_t *prefetch = arg;
+    eviewitf_ret_t ret;
+    uint8_t *buffer;
+    int frame_id;
+    int test_rw;
+
+    for (;;) {
+        /* Wait for room in the ring and for a buffer, the pool holds one more buffer than the ring, the one being
+         * written by the playback, given back through ssd_prefetch_release */
+        pthread_mutex_lock(&prefetch->mutex);
+        ret = EVIEWITF_BLOCKED;
+        while ((ret == EVIEWITF_BLOCKED) && !prefetch->stop) {
+            if (prefetch->nb_frames < SSD_PREFETCH_FRAMES) {
+                ret = eviewitf_pool_acquire(prefetch->pool, &buffer);
+            }
+            if (ret == EVIEWITF_BLOCKED) {
+                pthread_cond_wait(&prefetch->cond, &prefetch->mutex);
+            }
+        }
+        if (ret != EVIEWITF_OK) {
+            /* Stopped, or no buffer can be taken: the playback ends as on a read error */
+            if (!prefetch->stop) {
+                prefetch->end = -1;
+                pthread_cond_broadcast(&prefetch->cond);
+            }
+            pthread_mutex_unlock(&prefetch->mutex);
+            break;
+        }
+        frame_id = prefetch->next_id;
+        pthread_mutex_unlock(&prefetch->mutex);
+
+        /* The frames beyond the ring are left to the kernel read-ahead */
+        if (prefetch->recording != NULL) {
+            recording_advise_frame(prefetch->recording, frame_id + SSD_PREFETCH_FRAMES);
+        } else {
+            ssd_advise_frame(prefetch->frames_directory, frame_id + SSD_PREFETCH_FRAMES);
+        }
+
+        if (prefetch->recording != NULL) {
+            test_rw = ssd_read_recording_frame(prefetch->recording, frame_id, buffer, prefetch->buffer_size);
+        } else {
+            test_rw = ssd_read_frame(prefetch->frames_directory, frame_id, buffer, prefetch->buffer_size);
+        }
+
+        pthread_mutex_lock(&prefetch->mutex);
+        if (test_rw <= 0) {
+            eviewitf_pool_release(prefetch->pool, buffer);
+            prefetch->end = (test_rw < 0) ? -1 : 1;
+            pthread_cond_broadcast(&prefetch->cond);
+            pthread_mutex_unlock(&prefetch->mutex);
+            break;
+        }
+        prefetch->frames[(prefetch->head + prefetch->nb_frames) % SSD_PREFETCH_FRAMES] = buffer;
+        prefetch->nb_frames++;
+        prefetch->next_id++;
+        pthread_cond_broadcast(&prefetch->cond);
+        pthread_mutex_unlock(&prefetch->mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn static eviewitf_ret_t ssd_prefetch_start(ssd_prefetch_t *prefetch, char *frames_directory,
+ *                                              eviewitf_recording_t *recording, uint32_t size)
+ * @brief Start reading a recording ahead of the playback
+ *
+ * @param prefetch: prefetch pipeline
+ * @param frames_directory: path to the recording
+ * @param recording: recording file, NULL for the legacy layout
+ * @param size: size of a frame
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t ssd_prefetch_start(ssd_prefetch_t *prefetch, char *frames_directory,
+                                         eviewitf_recording_t *recording, uint32_t size) {
+    int err;
+
+    memset(prefetch, 0, sizeof(ssd_prefetch_t));
+    prefetch->frames_directory = frames_directory;
+    prefetch->recording = recording;
+    prefetch->buffer_size = size;
+    if (eviewitf_pool_create(&prefetch->pool, size, SSD_PREFETCH_FRAMES + 1, 0) != EVIEWITF_OK) {
+        return EVIEWITF_FAIL;
+    }
+    pthread_mutex_init(&prefetch->mutex, NULL);
+    pthread_cond_init(&prefetch->cond, NULL);
+
+    err = pthread_create(&prefetch->thread, NULL, ssd_prefetch_reader, prefetch);
+    if (err != 0) {
+        printf("[Error] Cannot create the prefetch thread: %s\n", strerror(err));
+        pthread_cond_destroy(&prefetch->cond);
+        pthread_mutex_destroy(&prefetch->mutex);
+        eviewitf_pool_destroy(prefetch->pool);
+        return EVIEWITF_FAIL;
+    }
+
+    /* Let the ring fill up before the first deadline */
+    pthread_mutex_lock(&prefetch->mutex);
+    while ((prefetch->nb_frames < SSD_PREFETCH_FRAMES) && (prefetch->end == 0)) {
+        pthread_cond_wait(&prefetch->cond, &prefetch->mutex);
+    }
+    pthread_mutex_unlock(&prefetch->mutex);
+
     return EVIEWITF_OK;
 }
 
-eviewitf_ret_t eviewitf_ssd_streamer_play(int streamer_id, uint32_t buffer_size, int fps, char *frames_directory) {
+/**
+ * @fn static int ssd_prefetch_pop(ssd_prefetch_t *prefetch, uint8_t **buffer)
+ * @brief Take the next frame of the recording, waiting for it if it has not been read yet
+ *
+ * @param prefetch: prefetch pipeline
+ * @param buffer: frame, to be given back through ssd_prefetch_release
+ * @return 1 if a frame has been taken, 0 at the end of the recording, -1 on read error
+ */
+static int ssd_prefetch_pop(ssd_prefetch_t *prefetch, uint8_t **buffer) {
+    int ret = 1;
+
+    pthread_mutex_lock(&prefetch->mutex);
+    if ((prefetch->nb_frames == 0) && (prefetch->end == 0)) {
+        /* The playback caught up with the reads */
+        prefetch->nb_underruns++;
+        do {
+            pthread_cond_wait(&prefetch->cond, &prefetch->mutex);
+        } while ((prefetch->nb_frames == 0) && (prefetch->end == 0));
+    }
+    if (prefetch->nb_frames != 0) {
+        *buffer = prefetch->frames[prefetch->head];
+        prefetch->head = (prefetch->head + 1) % SSD_PREFETCH_FRAMES;
+        prefetch->nb_frames--;
+        pthread_cond_broadcast(&prefetch->cond);
+    } else {
+        ret = (prefetch->end < 0) ? -1 : 0;
+    }
+    pthread_mutex_unlock(&prefetch->mutex);
+
+    return ret;
+}
+
+/**
+ * @fn static void ssd_prefetch_release(ssd_prefetch_t *prefetch, uint8_t *buffer)
+ * @brief Give back a frame taken through ssd_prefetch_pop
+ *
+ * @param prefetch: prefetch pipeline
+ * @param buffer: frame
+ */
+static void ssd_prefetch_release(ssd_prefetch_t *prefetch, uint8_t *buffer) {
+    pthread_mutex_lock(&prefetch->mutex);
+    eviewitf_pool_release(prefetch->pool, buffer);
+    pthread_cond_broadcast(&prefetch->cond);
+    pthread_mutex_unlock(&prefetch->mutex);
+}
+
+/**
+ * @fn static void ssd_prefetch_stop(ssd_prefetch_t *prefetch)
+ * @brief Stop reading a recording and free the frames read ahead
+ *
+ * @param prefetch: prefetch pipeline
+ */
+static void ssd_prefetch_stop(ssd_prefetch_t *prefetch) {
+    pthread_mutex_lock(&prefetch->mutex);
+    prefetch->stop = 1;
+    pthread_cond_broadcast(&prefetch->cond);
+    pthread_mutex_unlock(&prefetch->mutex);
+    pthread_join(prefetch->thread, NULL);
+
+    while (prefetch->nb_frames != 0) {
+        eviewitf_pool_release(prefetch->pool, prefetch->frames[prefetch->head]);
+        prefetch->head = (prefetch->head + 1) % SSD_PREFETCH_FRAMES;
+        prefetch->nb_frames--;
+    }
+    pthread_cond_destroy(&prefetch->cond);
+    pthread_mutex_destroy(&prefetch->mutex);
+    eviewitf_pool_destroy(prefetch->pool);
+}
+
+/**
+ * @fn static void ssd_play_stats_print(ssd_play_stats_t *stats, uint64_t period_ns)
+ * @brief Print the statistics of a playback
+ *
+ * @param stats: playback statistics
+ * @param period_ns: frame period (ns)
+ */
+static void ssd_play_stats_print(ssd_play_stats_t *stats, uint64_t period_ns) {
+    uint64_t mean_ns = (stats->nb_played != 0) ? stats->jitter_sum_ns / stats->nb_played : 0;
+
+    printf("Played %u frames at %llu us period, %u late, %u skipped, %u underruns\n", stats->nb_played,
+           (unsigned long long)(period_ns / 1000), stats->nb_late, stats->nb_skipped, stats->nb_underruns);
+    printf("Jitter mean %llu us, max %llu us\n", (unsigned long long)(mean_ns / 1000),
+           (unsigned long long)(stats->jitter_max_ns / 1000));
+}
+
+eviewitf_ret_t eviewitf_ssd_streamer_play(int streamer_id, uint32_t buffer_size, int fps, ssd_late_policy_t policy,
+                                          char *frames_directory) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
     int frame_id = 0;
-    int file_ssd = 1;
-    char filename_ssd[SSD_MAX_FILENAME_SIZE];
-    long int duration_ns;
-    timespec_t res_start;
-    timespec_t res_run;
-    timespec_t difft = {0};
-    char pre_read = 1;
-    int test_rw = 0;
+    uint64_t period_ns;
+    uint64_t start_ns;
+    uint64_t deadline_ns;
+    uint64_t now_ns;
+    uint64_t jitter_ns;
+    ssd_play_stats_t stats = {0};
+    ssd_prefetch_t prefetch;
+    int test_rw;
     uint8_t *buff_f;
     DIR *dir;
+    char filename_ssd[SSD_MAX_FILENAME_SIZE];
+    eviewitf_recording_t *recording = NULL;
+    eviewitf_device_attributes_t attributes;
 
     /* Test the fps value */
     if (fps < FPS_MIN_VALUE) {
@@ -186,112 +606,112 @@ eviewitf_ret_t eviewitf_ssd_streamer_play(int streamer_id, uint32_t buffer_size,
         printf("The recording directory cannot be found\n");
         return EVIEWITF_FAIL;
     }
+    closedir(dir);
+
+    /* Without a recording file, the directory holds one file per frame */
+    snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%s", frames_directory, EVIEWITF_RECORDING_FILENAME);
+    if (access(filename_ssd, F_OK) == 0) {
+        if (eviewitf_recording_open(&recording, filename_ssd) != EVIEWITF_OK) {
+            printf("The recording file cannot be read\n");
+            return EVIEWITF_FAIL;
+        }
+
+        /* The frames are written whole to the streamer */
+        eviewitf_recording_get_attributes(recording, &attributes);
+        if (attributes.buffer_size != buffer_size) {
+            printf("The recording buffer size (%u) does not match the streamer one (%u)\n", attributes.buffer_size,
+                   buffer_size);
+            eviewitf_recording_close(recording);
+            return EVIEWITF_FAIL;
+        }
+    }
 
     printf("Playing the recording...\n");
 
     /* The duration between two frames directly depends on the desired FPS */
-    duration_ns = ONE_SEC_NS / fps;
-
-    /* First time value */
-    if (clock_gettime(CLOCK_MONOTONIC, &res_start) != 0) {
-        printf("Got an issue with system clock aborting \n");
-        return EVIEWITF_FAIL;
-    }
+    period_ns = ONE_SEC_NS / fps;
 
     if (eviewitf_streamer_open(streamer_id) != EVIEWITF_OK) {
         printf("Error opening device\n");
+        if (recording != NULL) {
+            eviewitf_recording_close(recording);
+        }
         return EVIEWITF_FAIL;
     }
 
-    buff_f = malloc(buffer_size);
-    if (buff_f == NULL) {
+    /* The frames are read ahead by another thread, this one only waits for the deadlines and writes them */
+    if (ssd_prefetch_start(&prefetch, frames_directory, recording, buffer_size) != EVIEWITF_OK) {
         printf("Error Unable to allocate buffer\n");
+        if (recording != NULL) {
+            eviewitf_recording_close(recording);
+        }
         eviewitf_streamer_close(streamer_id);
         return EVIEWITF_FAIL;
     }
 
-    /* Read the frames in the directory */
-    while ((-1) != file_ssd) {
-        /* Get current time */
-        if (clock_gettime(CLOCK_MONOTONIC, &res_run) != 0) {
-            printf("Got an issue with system clock aborting \n");
-            free(buff_f);
-            eviewitf_streamer_close(streamer_id);
-            return EVIEWITF_FAIL;
-        }
-
-        /* Pre-read the frame during the waiting step */
-        if (1 == pre_read) {
-            /* Open the file (an open fail means "end of the loop") */
-            snprintf(filename_ssd, SSD_MAX_FILENAME_SIZE, "%s/%d", frames_directory, frame_id);
-            file_ssd = open(filename_ssd, O_RDONLY);
-
-            if ((-1) != file_ssd) {
-                /* Read the frame from the file  */
-                test_rw = read(file_ssd, buff_f, buffer_size);
-                if ((-1) == test_rw) {
-                    printf("[Error] Read frame from the file\n");
-                    close(file_ssd);
-                    free(buff_f);
-                    eviewitf_streamer_close(streamer_id);
-                    return EVIEWITF_FAIL;
-                }
-
-                /* Close the file */
-                close(file_ssd);
+    /* Frame n is due at start_ns + n * period_ns, whatever happened to the previous ones */
+    start_ns = stats_now_ns();
+    for (;;) {
+        test_rw = ssd_prefetch_pop(&prefetch, &buff_f);
+        if (test_rw <= 0) {
+            if (test_rw < 0) {
+                printf("[Error] Read frame from the file\n");
+                ret = EVIEWITF_FAIL;
             }
-
-            pre_read = 0;
+            break;
         }
 
-        if ((-1) != file_ssd) {
-            /* Take the second incrementation into account */
-            if ((res_run.tv_nsec - res_start.tv_nsec) < 0) {
-                difft.tv_nsec = ONE_SEC_NS + res_run.tv_nsec - res_start.tv_nsec;
-            } else {
-                difft.tv_nsec = res_run.tv_nsec - res_start.tv_nsec;
+        deadline_ns = start_ns + (uint64_t)frame_id * period_ns;
+        frame_id++;
+        ssd_sleep_until(deadline_ns);
+        now_ns = stats_now_ns();
+        jitter_ns = (now_ns > deadline_ns) ? now_ns - deadline_ns : 0;
+
+        /* A frame whose period is over is skipped, the next ones are until back on time */
+        if (jitter_ns >= period_ns) {
+            stats.nb_late++;
+            if (policy == SSD_LATE_SKIP) {
+                stats.nb_skipped++;
+                ssd_prefetch_release(&prefetch, buff_f);
+                continue;
             }
+        }
 
-            /* Check if the frame should be updated */
-            if (difft.tv_nsec >= duration_ns) {
-                /* Update the starting time for the duration */
-                if (clock_gettime(CLOCK_MONOTONIC, &res_start) != 0) {
-                    printf("Got an issue with system clock aborting \n");
-                    free(buff_f);
-                    eviewitf_streamer_close(streamer_id);
-                    return EVIEWITF_FAIL;
-                }
-
-                /* Write the frame in the virtual camera */
-                if (EVIEWITF_OK != eviewitf_streamer_write_frame(streamer_id, buff_f, buffer_size)) {
-                    printf("[Error] Set a frame in the virtual camera\n");
-                    free(buff_f);
-                    eviewitf_streamer_close(streamer_id);
-                    return EVIEWITF_FAIL;
-                }
-
-                /* Enable the pre-read */
-                pre_read = 1;
+        /* Write the frame in the virtual camera */
+        test_rw = eviewitf_streamer_write_frame(streamer_id, buff_f, buffer_size);
+        ssd_prefetch_release(&prefetch, buff_f);
+        if (EVIEWITF_OK != test_rw) {
+            printf("[Error] Set a frame in the virtual camera\n");
+            ret = EVIEWITF_FAIL;
+            break;
+        }
 
-                /* Update the frame to be read */
-                frame_id++;
-            }
+        stats.nb_played++;
+        stats.jitter_sum_ns += jitter_ns;
+        if (jitter_ns > stats.jitter_max_ns) {
+            stats.jitter_max_ns = jitter_ns;
         }
     }
 
-    free(buff_f);
+    ssd_prefetch_stop(&prefetch);
+    if (recording != NULL) {
+        eviewitf_recording_close(recording);
+    }
+    stats.nb_underruns = prefetch.nb_underruns;
+    ssd_play_stats_print(&stats, period_ns);
     if (eviewitf_streamer_close(streamer_id) != EVIEWITF_OK) {
         printf("Error closing device\n");
         return EVIEWITF_FAIL;
     }
 
-    return EVIEWITF_OK;
+    return ret;
 }
 
 eviewitf_ret_t eviewitf_ssd_set_blending(int blender_id, uint32_t buffer_size, char *frame) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     int file_ssd;
     int test_rw = 0;
+    eviewitf_pool_t *pool;
     uint8_t *buff_f;
 
     file_ssd = open(frame, O_RDONLY);
@@ -300,8 +720,7 @@ eviewitf_ret_t eviewitf_ssd_set_blending(int blender_id, uint32_t buffer_size, c
         return EVIEWITF_FAIL;
     }
 
-    buff_f = malloc(buffer_size);
-    if (buff_f == NULL) {
+    if (ssd_buffer_alloc(buffer_size, &pool, &buff_f) != EVIEWITF_OK) {
         printf("[Error] Unable to allocate buffer\n");
         close(file_ssd);
         return EVIEWITF_FAIL;
@@ -311,7 +730,7 @@ eviewitf_ret_t eviewitf_ssd_set_blending(int blender_id, uint32_t buffer_size, c
     if ((-1) == test_rw) {
         printf("[Error] Read frame from the file\n");
         close(file_ssd);
-        free(buff_f);
+        ssd_buffer_free(pool, buff_f);
         return EVIEWITF_FAIL;
     }
 
@@ -324,7 +743,7 @@ eviewitf_ret_t eviewitf_ssd_set_blending(int blender_id, uint32_t buffer_size, c
     }
 
     close(file_ssd);
-    free(buff_f);
+    ssd_buffer_free(pool, buff_f);
 
     return ret;
 }
@@ -17,6 +17,24 @@
  */
 typedef struct timespec timespec_t;
 
+/**
+ * @enum ssd_layout
+ * @brief How the frames of a recording are stored
+ */
+typedef enum ssd_layout {
+    SSD_LAYOUT_RECORDING, /*!< A single EVIEWITF_RECORDING_FILENAME recording file holding the frames and their index */
+    SSD_LAYOUT_LEGACY,    /*!< One file per frame, named after the frame number */
+} ssd_layout_t;
+
+/**
+ * @enum ssd_late_policy
+ * @brief What the playback does with the frames whose display time has already passed
+ */
+typedef enum ssd_late_policy {
+    SSD_LATE_SKIP,     /*!< Skip the frames of the missed periods to stay on time */
+    SSD_LATE_CATCH_UP, /*!< Play every frame, as fast as possible until back on time */
+} ssd_late_policy_t;
+
 /**
  * @fn eviewitf_ret_t eviewitf_ssd_get_output_directory(char **storage_directory)
  * @brief Get SSD output directory
@@ -26,28 +44,38 @@ typedef struct timespec timespec_t;
 eviewitf_ret_t eviewitf_ssd_get_output_directory(char **storage_directory);
 
 /**
- * @fn eviewitf_ret_t eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directory, uint32_t size)
- * @brief Get SSD output directory
+ * @fn eviewitf_ret_t eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directory, uint32_t size,
+ *                                              ssd_layout_t layout)
+ * @brief Record a camera stream on the SSD
  * @param camera_id camera identifier
  * @param duration record duration
  * @param frames_directory frames directory path
  * @param size buffer size to allocate
+ * @param layout how the frames are stored in frames_directory
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directory, uint32_t size);
+eviewitf_ret_t eviewitf_ssd_record_stream(int camera_id, int duration, char *frames_directory, uint32_t size,
+                                          ssd_layout_t layout);
 
 /**
- * @fn eviewitf_ret_t eviewitf_ssd_streamer_play(int streamer_id, uint32_t buffer_size, int fps, char *frames_directory)
+ * @fn eviewitf_ret_t eviewitf_ssd_streamer_play(int streamer_id, uint32_t buffer_size, int fps,
+ *                                              ssd_late_policy_t policy, char *frames_directory)
  * @brief Play a recording on a streamer
 
  * @param streamer_id: id of the streamer
  * @param buffer_size: size of the streamer buffer
  * @param fps: fps to apply on the recording
+ * @param policy: what to do with the frames played late
  * @param frames_directory: path to the recording
  *
  * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The recording file of frames_directory is played if there is one, the files of the legacy layout otherwise.
+ * Frame n is written at start + n / fps on CLOCK_MONOTONIC, the thread sleeping until then, so that the pacing does not
+ * drift. The jitter statistics are printed at the end of the playback.
  */
-eviewitf_ret_t eviewitf_ssd_streamer_play(int camera_id, uint32_t buffer_size, int fps, char *frames_directory);
+eviewitf_ret_t eviewitf_ssd_streamer_play(int camera_id, uint32_t buffer_size, int fps, ssd_late_policy_t policy,
+                                          char *frames_directory);
 
 /**
  * @fn eviewitf_ret_t eviewitf_ssd_set_blending(int blender_id, uint32_t buffer_size, char *frame)
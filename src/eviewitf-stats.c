@@ -0,0 +1,427 @@
+/**
+ * @file eviewitf-stats.c
+ * @brief Communication API between A53 and R7 CPUs for requests statistics
+ * @author LACROIX Impulse
+ *
+ * Counters and latency histograms of the requests sent to the R7 CPU.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Shared memory holding the statistics of all the processes
+ */
+#define STATS_SHM_NAME "/eviewitf-stats"
+
+/**
+ * @brief Magic number identifying the statistics layout
+ */
+#define STATS_MAGIC_NUMBER 0x57A75001
+
+/**
+ * @brief Version of the statistics layout, to be increased on any change of stats_table_t
+ */
+#define STATS_VERSION 1
+
+/**
+ * @brief Access rights of the shared memory, restricted to the owner and its group
+ */
+#define STATS_SHM_MODE 0660
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef stats_table_t
+ * @brief Statistics of all the commands
+ *
+ * @struct stats_table
+ * @brief Statistics of all the commands, updated with atomic operations only
+ */
+typedef struct stats_table {
+    uint32_t magic;   /*!< STATS_MAGIC_NUMBER once the table is initialized */
+    uint32_t version; /*!< STATS_VERSION */
+    uint32_t size;    /*!< Size of the table */
+
+    /** Statistics, per device type and command */
+    eviewitf_stats_entry_t entries[EVIEWITF_STATS_DEVTYPE_MAX][EVIEWITF_STATS_MAX_COMMANDS];
+
+    /** Frames latencies, per camera */
+    eviewitf_stats_latency_t latency[EVIEWITF_MAX_CAMERA];
+
+    /** Frames sequence counters, per camera */
+    eviewitf_stats_frames_t frames[EVIEWITF_MAX_CAMERA];
+} stats_table_t;
+
+/******************************************************************************************
+ * Private enumerations
+ ******************************************************************************************/
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+/**
+ * @brief Statistics used if the shared memory is not available
+ */
+static stats_table_t stats_local_table;
+
+/**
+ * @brief Statistics table in use
+ */
+static stats_table_t *stats_table = &stats_local_table;
+
+/**
+ * @brief Statistics table initialization control
+ */
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Time of the last poll wake-up reporting a new frame, per camera, 0 once the frame is read
+ */
+static uint64_t stats_wake_ns[EVIEWITF_MAX_CAMERA];
+
+/**
+ * @brief R7 timestamp of the last frame read by this process, per camera, 0 if none
+ */
+static uint64_t stats_last_timestamps[EVIEWITF_MAX_CAMERA];
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static void stats_init(void)
+ * @brief Map the statistics shared by all the processes, or keep the local ones if they cannot be mapped
+ */
+static void stats_init(void) {
+    stats_table_t *table;
+    struct stat st;
+    uint32_t magic;
+    int fd;
+
+    fd = shm_open(STATS_SHM_NAME, O_RDWR | O_CREAT | O_CLOEXEC, STATS_SHM_MODE);
+    if (fd < 0) {
+        return;
+    }
+
+    /* A table of another size cannot be of this version */
+    if ((fstat(fd, &st) < 0) || ((st.st_size != 0) && (st.st_size != sizeof(stats_table_t))) ||
+        ((st.st_size == 0) && (ftruncate(fd, sizeof(stats_table_t)) < 0))) {
+        close(fd);
+        return;
+    }
+
+    table = mmap(NULL, sizeof(stats_table_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (table == MAP_FAILED) {
+        return;
+    }
+
+    /* A new table is zero filled, any process mapping it before the magic number is set initializes it the same way */
+    magic = __atomic_load_n(&table->magic, __ATOMIC_ACQUIRE);
+    if (magic == 0) {
+        __atomic_store_n(&table->version, STATS_VERSION, __ATOMIC_RELAXED);
+        __atomic_store_n(&table->size, sizeof(stats_table_t), __ATOMIC_RELAXED);
+        __atomic_store_n(&table->magic, STATS_MAGIC_NUMBER, __ATOMIC_RELEASE);
+    } else if ((magic != STATS_MAGIC_NUMBER) || (__atomic_load_n(&table->version, __ATOMIC_RELAXED) != STATS_VERSION) ||
+               (__atomic_load_n(&table->size, __ATOMIC_RELAXED) != sizeof(stats_table_t))) {
+        /* A table created by another version of the library is left untouched, the local one is used */
+        munmap(table, sizeof(stats_table_t));
+        return;
+    }
+    stats_table = table;
+}
+
+/**
+ * @fn static stats_table_t *stats_get_table(void)
+ * @brief Get the statistics table, mapping it on first use
+ *
+ * @return pointer on the statistics table
+ */
+static stats_table_t *stats_get_table(void) {
+    pthread_once(&stats_once, stats_init);
+    return stats_table;
+}
+
+/**
+ * @fn uint64_t stats_now_ns(void)
+ * @brief Get the current time used to measure the requests duration
+ *
+ * @return monotonic time in ns
+ */
+uint64_t stats_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @fn static int stats_bucket(uint64_t duration_ns)
+ * @brief Get the histogram bucket of a duration
+ *
+ * @param duration_ns: duration in ns
+ * @return log2 bucket of the duration in us
+ */
+static int stats_bucket(uint64_t duration_ns) {
+    uint64_t duration_us = duration_ns / 1000;
+    int bucket = 0;
+
+    while ((duration_us != 0) && (bucket < EVIEWITF_STATS_HISTOGRAM_BUCKETS - 1)) {
+        duration_us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @fn static void stats_update_max(uint64_t *max_ns, uint64_t duration_ns)
+ * @brief Raise a maximum duration
+ *
+ * @param max_ns: maximum duration
+ * @param duration_ns: new duration
+ */
+static void stats_update_max(uint64_t *max_ns, uint64_t duration_ns) {
+    uint64_t current_ns = __atomic_load_n(max_ns, __ATOMIC_RELAXED);
+
+    while ((duration_ns > current_ns) &&
+           !__atomic_compare_exchange_n(max_ns, &current_ns, duration_ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @fn static void stats_record_latency(eviewitf_stats_latency_entry_t *entry, uint64_t latency_ns)
+ * @brief Account for the latency of a frame
+ *
+ * @param entry: latency distribution
+ * @param latency_ns: latency of the frame
+ */
+static void stats_record_latency(eviewitf_stats_latency_entry_t *entry, uint64_t latency_ns) {
+    __atomic_fetch_add(&entry->nb_frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entry->total_ns, latency_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entry->histogram[stats_bucket(latency_ns)], 1, __ATOMIC_RELAXED);
+    stats_update_max(&entry->max_ns, latency_ns);
+}
+
+/**
+ * @fn void stats_record(uint8_t devtype, uint8_t cmd, eviewitf_ret_t result, uint64_t start_ns)
+ * @brief Account for a completed request
+ *
+ * @param devtype: device type as specified by the eviewitf_stats_devtype_t enumeration
+ * @param cmd: command number
+ * @param result: result of the request
+ * @param start_ns: time the request was started, as returned by stats_now_ns
+ */
+void stats_record(uint8_t devtype, uint8_t cmd, eviewitf_ret_t result, uint64_t start_ns) {
+    eviewitf_stats_entry_t *entry;
+    uint64_t duration_ns = stats_now_ns() - start_ns;
+
+    if (devtype >= EVIEWITF_STATS_DEVTYPE_MAX) {
+        return;
+    }
+    entry = &stats_get_table()->entries[devtype][cmd];
+
+    __atomic_fetch_add(&entry->nb_requests, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entry->total_ns, duration_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&entry->histogram[stats_bucket(duration_ns)], 1, __ATOMIC_RELAXED);
+    if (result == EVIEWITF_BLOCKED) {
+        __atomic_fetch_add(&entry->nb_blocked, 1, __ATOMIC_RELAXED);
+    } else if (result == EVIEWITF_INVALID_PARAM) {
+        __atomic_fetch_add(&entry->nb_invalid, 1, __ATOMIC_RELAXED);
+    } else if (result != EVIEWITF_OK) {
+        __atomic_fetch_add(&entry->nb_failed, 1, __ATOMIC_RELAXED);
+    }
+    stats_update_max(&entry->max_ns, duration_ns);
+}
+
+/**
+ * @fn void stats_camera_wake(int cam_id)
+ * @brief Account for a poll wake-up reporting a new frame of a camera
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ */
+void stats_camera_wake(int cam_id) {
+    uint64_t expected = 0;
+
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return;
+    }
+
+    /* Only the first wake-up before the frame is read counts */
+    __atomic_compare_exchange_n(&stats_wake_ns[cam_id], &expected, stats_now_ns(), 0, __ATOMIC_RELAXED,
+                                __ATOMIC_RELAXED);
+}
+
+/**
+ * @fn static void stats_record_sequence(int cam_id, uint64_t timestamp, uint64_t period_ns)
+ * @brief Compare the timestamp of a frame to the previous one read from the same camera
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param timestamp: R7 timestamp of the frame
+ * @param period_ns: frame period, 0 if unknown
+ */
+static void stats_record_sequence(int cam_id, uint64_t timestamp, uint64_t period_ns) {
+    eviewitf_stats_frames_t *frames = &stats_get_table()->frames[cam_id];
+    uint64_t last = __atomic_exchange_n(&stats_last_timestamps[cam_id], timestamp, __ATOMIC_RELAXED);
+    uint64_t timestamp_ns;
+    uint64_t last_ns;
+    uint64_t delta_ns;
+    uint64_t expected_ns;
+    uint64_t nb_periods;
+    uint64_t jitter_ns;
+
+    __atomic_fetch_add(&frames->nb_frames, 1, __ATOMIC_RELAXED);
+    if (last == 0) {
+        return;
+    }
+
+    /* The same frame read again, or an older one */
+    if ((int64_t)(timestamp - last) <= 0) {
+        __atomic_fetch_add(&frames->nb_duplicated, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if ((period_ns == 0) || (eviewitf_timestamp_to_monotonic(timestamp, &timestamp_ns) != EVIEWITF_OK) ||
+        (eviewitf_timestamp_to_monotonic(last, &last_ns) != EVIEWITF_OK) || (timestamp_ns <= last_ns)) {
+        return;
+    }
+
+    /* Consecutive frames are one period apart, one more per missed frame, the remainder is jitter */
+    delta_ns = timestamp_ns - last_ns;
+    nb_periods = (delta_ns + period_ns / 2) / period_ns;
+    if (nb_periods > 1) {
+        __atomic_fetch_add(&frames->nb_dropped, nb_periods - 1, __ATOMIC_RELAXED);
+    }
+    expected_ns = nb_periods * period_ns;
+    jitter_ns = (delta_ns > expected_ns) ? delta_ns - expected_ns : expected_ns - delta_ns;
+    __atomic_fetch_add(&frames->jitter_ns, jitter_ns, __ATOMIC_RELAXED);
+    stats_update_max(&frames->max_jitter_ns, jitter_ns);
+}
+
+/**
+ * @fn void stats_camera_frame(int cam_id, const eviewitf_frame_metadata_info_t *metadata, uint64_t period_ns)
+ * @brief Account for the end of a frame read
+ *
+ * @param cam_id: id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ * @param metadata: metadata of the frame, zeroed if the frame has none
+ * @param period_ns: frame period of the camera, 0 if unknown
+ */
+void stats_camera_frame(int cam_id, const eviewitf_frame_metadata_info_t *metadata, uint64_t period_ns) {
+    eviewitf_stats_latency_t *latency;
+    uint64_t now_ns = stats_now_ns();
+    uint64_t timestamp;
+    uint64_t timestamp_ns;
+    uint64_t wake_ns;
+
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return;
+    }
+    latency = &stats_get_table()->latency[cam_id];
+
+    wake_ns = __atomic_exchange_n(&stats_wake_ns[cam_id], 0, __ATOMIC_RELAXED);
+    if ((wake_ns != 0) && (now_ns >= wake_ns)) {
+        stats_record_latency(&latency->wake_to_data, now_ns - wake_ns);
+    }
+
+    /* The converted timestamp includes the lowest transfer delay, faster frames are accounted as without delay */
+    timestamp = ((uint64_t)metadata->frame_timestamp_msb << 32) | metadata->frame_timestamp_lsb;
+    if (timestamp == 0) {
+        return;
+    }
+    clock_sample(timestamp, now_ns);
+    if (eviewitf_timestamp_to_monotonic(timestamp, &timestamp_ns) == EVIEWITF_OK) {
+        stats_record_latency(&latency->sensor_to_user, (now_ns > timestamp_ns) ? now_ns - timestamp_ns : 0);
+    }
+    stats_record_sequence(cam_id, timestamp, period_ns);
+}
+
+eviewitf_ret_t eviewitf_stats_get(eviewitf_stats_devtype_t devtype, uint8_t cmd, eviewitf_stats_entry_t *entry) {
+    eviewitf_stats_entry_t *src;
+    uint64_t *from;
+    uint64_t *to;
+
+    if ((devtype < 0) || (devtype >= EVIEWITF_STATS_DEVTYPE_MAX) || (entry == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    src = &stats_get_table()->entries[devtype][cmd];
+    from = (uint64_t *)src;
+    to = (uint64_t *)entry;
+    for (size_t i = 0; i < sizeof(eviewitf_stats_entry_t) / sizeof(uint64_t); i++) {
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+    }
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_stats_get_latency(int cam_id, eviewitf_stats_latency_t *latency) {
+    uint64_t *from;
+    uint64_t *to;
+
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (latency == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    from = (uint64_t *)&stats_get_table()->latency[cam_id];
+    to = (uint64_t *)latency;
+    for (size_t i = 0; i < sizeof(eviewitf_stats_latency_t) / sizeof(uint64_t); i++) {
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+    }
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_stats_get_frames(int cam_id, eviewitf_stats_frames_t *frames) {
+    uint64_t *from;
+    uint64_t *to;
+
+    if ((cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA) || (frames == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    from = (uint64_t *)&stats_get_table()->frames[cam_id];
+    to = (uint64_t *)frames;
+    for (size_t i = 0; i < sizeof(eviewitf_stats_frames_t) / sizeof(uint64_t); i++) {
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+    }
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_stats_reset(void) {
+    uint64_t *values = (uint64_t *)stats_get_table()->entries;
+
+    for (size_t i = 0; i < sizeof(stats_table->entries) / sizeof(uint64_t); i++) {
+        __atomic_store_n(&values[i], 0, __ATOMIC_RELAXED);
+    }
+
+    for (int cam_id = 0; cam_id < EVIEWITF_MAX_CAMERA; cam_id++) {
+        values = (uint64_t *)&stats_table->latency[cam_id];
+        for (size_t i = 0; i < sizeof(eviewitf_stats_latency_t) / sizeof(uint64_t); i++) {
+            __atomic_store_n(&values[i], 0, __ATOMIC_RELAXED);
+        }
+        values = (uint64_t *)&stats_table->frames[cam_id];
+        for (size_t i = 0; i < sizeof(eviewitf_stats_frames_t) / sizeof(uint64_t); i++) {
+            __atomic_store_n(&values[i], 0, __ATOMIC_RELAXED);
+        }
+        /* The next frame read starts a new sequence */
+        __atomic_store_n(&stats_last_timestamps[cam_id], 0, __ATOMIC_RELAXED);
+    }
+
+    return EVIEWITF_OK;
+}
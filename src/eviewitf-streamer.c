@@ -63,13 +63,17 @@ int streamer_open(int device_id) {
  * process at the same time.
  */
 eviewitf_ret_t eviewitf_streamer_open(int streamer_id) {
-    /* Test streamer id */
-    if ((streamer_id < 0) || (streamer_id >= EVIEWITF_MAX_STREAMER)) {
+    return eviewitf_ctx_streamer_open(device_default_ctx(), streamer_id);
+}
+
+eviewitf_ret_t eviewitf_ctx_streamer_open(eviewitf_ctx_t *ctx, int streamer_id) {
+    /* Test context and streamer id */
+    if ((ctx == NULL) || (streamer_id < 0) || (streamer_id >= EVIEWITF_MAX_STREAMER)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
     /* Open device */
-    return device_open(streamer_id + EVIEWITF_OFFSET_STREAMER);
+    return device_open(ctx, streamer_id + EVIEWITF_OFFSET_STREAMER);
 }
 
 /**
@@ -83,12 +87,16 @@ eviewitf_ret_t eviewitf_streamer_open(int streamer_id) {
  * A streamer should be closed before to stop the process that opened it.
  */
 eviewitf_ret_t eviewitf_streamer_close(int streamer_id) {
-    /* Test streamer id */
-    if ((streamer_id < 0) || (streamer_id >= EVIEWITF_MAX_STREAMER)) {
+    return eviewitf_ctx_streamer_close(device_default_ctx(), streamer_id);
+}
+
+eviewitf_ret_t eviewitf_ctx_streamer_close(eviewitf_ctx_t *ctx, int streamer_id) {
+    /* Test context and streamer id */
+    if ((ctx == NULL) || (streamer_id < 0) || (streamer_id >= EVIEWITF_MAX_STREAMER)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    return device_close(streamer_id + EVIEWITF_OFFSET_STREAMER);
+    return device_close(ctx, streamer_id + EVIEWITF_OFFSET_STREAMER);
 }
 
 /**
@@ -127,10 +135,15 @@ eviewitf_ret_t eviewitf_streamer_get_attributes(int streamer_id, eviewitf_device
  * through a call to eviewitf_streamer_get_attributes.
  */
 eviewitf_ret_t eviewitf_streamer_write_frame(int streamer_id, uint8_t *frame_buffer, uint32_t buffer_size) {
-    /* Test streamer id */
-    if ((streamer_id < 0) || (streamer_id >= EVIEWITF_MAX_STREAMER)) {
+    return eviewitf_ctx_streamer_write_frame(device_default_ctx(), streamer_id, frame_buffer, buffer_size);
+}
+
+eviewitf_ret_t eviewitf_ctx_streamer_write_frame(eviewitf_ctx_t *ctx, int streamer_id, uint8_t *frame_buffer,
+                                                 uint32_t buffer_size) {
+    /* Test context and streamer id */
+    if ((ctx == NULL) || (streamer_id < 0) || (streamer_id >= EVIEWITF_MAX_STREAMER)) {
         return EVIEWITF_INVALID_PARAM;
     }
 
-    return device_write(streamer_id + EVIEWITF_OFFSET_STREAMER, frame_buffer, buffer_size);
+    return device_write(ctx, streamer_id + EVIEWITF_OFFSET_STREAMER, frame_buffer, buffer_size);
 }
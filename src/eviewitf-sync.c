@@ -0,0 +1,333 @@
+/**
+ * @file eviewitf-sync.c
+ * @brief Communication API between A53 and R7 CPUs for synchronized frame sets
+ * @author LACROIX Impulse
+ *
+ * Matching of the frames captured from several cameras.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @struct eviewitf_sync_group
+ * @brief Synchronization group
+ */
+struct eviewitf_sync_group {
+    int nb_cam;                          /*!< Number of cameras */
+    int cam_id[EVIEWITF_MAX_CAMERA];     /*!< Cameras */
+    eviewitf_sync_mode_t mode;           /*!< How the frames are matched */
+    uint64_t tolerance;                  /*!< Max timestamp difference between frames of a set */
+    int64_t ns_set_timeout;              /*!< Delay to wait for the missing frames of a set */
+    eviewitf_sync_stats_t stats;         /*!< Synchronization counters */
+    int nb_pending[EVIEWITF_MAX_CAMERA]; /*!< Number of frames waiting to be matched, per camera */
+    uint32_t attributes_generation;      /*!< Attributes generation of the frames waiting to be matched */
+
+    /** Frames waiting to be matched, oldest first, per camera */
+    eviewitf_capture_frame_t pending[EVIEWITF_MAX_CAMERA][EVIEWITF_SYNC_MAX_PENDING];
+};
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static int64_t sync_key_diff(eviewitf_sync_group_t *group, eviewitf_capture_frame_t *a,
+ *                                  eviewitf_capture_frame_t *b)
+ * @brief Compare the matching keys of two frames
+ *
+ * @param group: group
+ * @param a: first frame
+ * @param b: second frame
+ * @return difference between the key of a and the key of b
+ */
+static int64_t sync_key_diff(eviewitf_sync_group_t *group, eviewitf_capture_frame_t *a, eviewitf_capture_frame_t *b) {
+    uint64_t ts_a;
+    uint64_t ts_b;
+
+    if (group->mode == EVIEWITF_SYNC_BY_FRAME_SYNC) {
+        /* frame_sync may wrap around */
+        return (int32_t)(a->metadata.frame_sync - b->metadata.frame_sync);
+    }
+
+    ts_a = ((uint64_t)a->metadata.frame_timestamp_msb << 32) | a->metadata.frame_timestamp_lsb;
+    ts_b = ((uint64_t)b->metadata.frame_timestamp_msb << 32) | b->metadata.frame_timestamp_lsb;
+    return (int64_t)(ts_a - ts_b);
+}
+
+/**
+ * @fn static void sync_pop(eviewitf_sync_group_t *group, int index, eviewitf_capture_frame_t *frame)
+ * @brief Remove the oldest frame waiting to be matched of a camera
+ *
+ * @param group: group
+ * @param index: camera index in the group
+ * @param frame: removed frame, released if NULL
+ */
+static void sync_pop(eviewitf_sync_group_t *group, int index, eviewitf_capture_frame_t *frame) {
+    if (frame != NULL) {
+        *frame = group->pending[index][0];
+    } else {
+        eviewitf_capture_release_frame(group->cam_id[index], &group->pending[index][0]);
+    }
+
+    group->nb_pending[index]--;
+    memmove(&group->pending[index][0], &group->pending[index][1],
+            group->nb_pending[index] * sizeof(eviewitf_capture_frame_t));
+}
+
+/**
+ * @fn static void sync_flush(eviewitf_sync_group_t *group)
+ * @brief Drop the frames waiting to be matched
+ *
+ * @param group: group
+ */
+static void sync_flush(eviewitf_sync_group_t *group) {
+    for (int i = 0; i < group->nb_cam; i++) {
+        while (group->nb_pending[i] != 0) {
+            sync_pop(group, i, NULL);
+        }
+    }
+}
+
+/**
+ * @fn static void sync_collect(eviewitf_sync_group_t *group)
+ * @brief Take the frames already captured by the cameras of a group, without waiting
+ *
+ * @param group: group
+ */
+static void sync_collect(eviewitf_sync_group_t *group) {
+    for (int i = 0; i < group->nb_cam; i++) {
+        while ((group->nb_pending[i] < EVIEWITF_SYNC_MAX_PENDING) &&
+               (eviewitf_capture_get_frame(group->cam_id[i], 0, &group->pending[i][group->nb_pending[i]]) ==
+                EVIEWITF_OK)) {
+            group->nb_pending[i]++;
+        }
+    }
+}
+
+/**
+ * @fn static uint8_t sync_match(eviewitf_sync_group_t *group, eviewitf_sync_set_t *set, uint64_t now_ns)
+ * @brief Try to build a set from the frames waiting to be matched
+ *
+ * The oldest frame of each camera is compared to the most recent of them. The frames that cannot match it, nor
+ * anything captured later, are dropped as late. The remaining frames form a set once every camera has one, or once the
+ * set timeout has elapsed.
+ *
+ * @param group: group
+ * @param set: set to fill
+ * @param now_ns: current monotonic time in ns
+ * @return 1 if a set has been built, 0 otherwise
+ */
+static uint8_t sync_match(eviewitf_sync_group_t *group, eviewitf_sync_set_t *set, uint64_t now_ns) {
+    uint64_t tolerance = (group->mode == EVIEWITF_SYNC_BY_FRAME_SYNC) ? 0 : group->tolerance;
+    eviewitf_capture_frame_t *ref;
+    uint64_t oldest_ns;
+    uint8_t dropped;
+    uint8_t complete;
+
+    do {
+        ref = NULL;
+        complete = 1;
+        oldest_ns = UINT64_MAX;
+        for (int i = 0; i < group->nb_cam; i++) {
+            if (group->nb_pending[i] == 0) {
+                complete = 0;
+                continue;
+            }
+            if ((ref == NULL) || (sync_key_diff(group, &group->pending[i][0], ref) > 0)) {
+                ref = &group->pending[i][0];
+            }
+            if (group->pending[i][0].capture_ns < oldest_ns) {
+                oldest_ns = group->pending[i][0].capture_ns;
+            }
+        }
+        if (ref == NULL) {
+            return 0;
+        }
+
+        dropped = 0;
+        for (int i = 0; i < group->nb_cam; i++) {
+            if ((group->nb_pending[i] != 0) &&
+                ((uint64_t)sync_key_diff(group, ref, &group->pending[i][0]) > tolerance)) {
+                sync_pop(group, i, NULL);
+                group->stats.nb_late++;
+                dropped = 1;
+            }
+        }
+    } while (dropped);
+
+    /* Signed, a frame may have been captured after now_ns was taken */
+    if (!complete && ((int64_t)(now_ns - oldest_ns) < group->ns_set_timeout)) {
+        return 0;
+    }
+
+    set->complete = complete;
+    set->nb_frames = 0;
+    for (int i = 0; i < group->nb_cam; i++) {
+        set->present[i] = (group->nb_pending[i] != 0);
+        if (set->present[i]) {
+            sync_pop(group, i, &set->frames[i]);
+            set->nb_frames++;
+        }
+    }
+    if (complete) {
+        group->stats.nb_complete++;
+    } else {
+        group->stats.nb_partial++;
+    }
+
+    return 1;
+}
+
+eviewitf_ret_t eviewitf_sync_create(eviewitf_sync_group_t **group, const int *cam_id, int nb_cam,
+                                    eviewitf_sync_mode_t mode, uint64_t tolerance, int64_t ns_set_timeout) {
+    eviewitf_sync_group_t *new_group;
+
+    if ((group == NULL) || (cam_id == NULL) || (nb_cam <= 0) || (nb_cam > EVIEWITF_MAX_CAMERA) ||
+        ((mode != EVIEWITF_SYNC_BY_FRAME_SYNC) && (mode != EVIEWITF_SYNC_BY_TIMESTAMP)) || (ns_set_timeout < 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+    for (int i = 0; i < nb_cam; i++) {
+        if ((cam_id[i] < 0) || (cam_id[i] >= EVIEWITF_MAX_CAMERA)) {
+            return EVIEWITF_INVALID_PARAM;
+        }
+        for (int j = 0; j < i; j++) {
+            if (cam_id[j] == cam_id[i]) {
+                return EVIEWITF_INVALID_PARAM;
+            }
+        }
+    }
+
+    new_group = calloc(1, sizeof(eviewitf_sync_group_t));
+    if (new_group == NULL) {
+        return EVIEWITF_FAIL;
+    }
+
+    new_group->nb_cam = nb_cam;
+    memcpy(new_group->cam_id, cam_id, nb_cam * sizeof(int));
+    new_group->mode = mode;
+    new_group->tolerance = tolerance;
+    new_group->ns_set_timeout = ns_set_timeout;
+    new_group->attributes_generation = device_get_attributes_generation();
+
+    *group = new_group;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_sync_destroy(eviewitf_sync_group_t *group) {
+    if (group == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    sync_flush(group);
+    free(group);
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_sync_get_set(eviewitf_sync_group_t *group, int64_t ns_timeout, eviewitf_sync_set_t *set) {
+    uint64_t deadline_ns;
+    uint64_t now_ns;
+    uint64_t oldest_ns;
+    int64_t set_wait_ns;
+    int64_t wait_ns;
+    struct timespec delay;
+    uint32_t generation;
+    eviewitf_ret_t ret;
+    int missing;
+
+    if ((group == NULL) || (set == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    deadline_ns = stats_now_ns() + ns_timeout;
+    for (;;) {
+        /* Frames captured before the cameras were reconfigured are not matched with the following ones */
+        generation = device_get_attributes_generation();
+        if (generation != group->attributes_generation) {
+            sync_flush(group);
+            group->attributes_generation = generation;
+        }
+
+        /* Taken after the frames are collected, so that none of them is more recent */
+        sync_collect(group);
+        now_ns = stats_now_ns();
+        if (sync_match(group, set, now_ns)) {
+            return EVIEWITF_OK;
+        }
+
+        /* Wait for a frame of a camera missing from the set */
+        missing = 0;
+        oldest_ns = UINT64_MAX;
+        for (int i = group->nb_cam - 1; i >= 0; i--) {
+            if (group->nb_pending[i] == 0) {
+                missing = i;
+            } else if (group->pending[i][0].capture_ns < oldest_ns) {
+                oldest_ns = group->pending[i][0].capture_ns;
+            }
+        }
+        if ((ns_timeout >= 0) && (now_ns >= deadline_ns)) {
+            return EVIEWITF_BLOCKED;
+        }
+        wait_ns = (ns_timeout >= 0) ? (int64_t)(deadline_ns - now_ns) : -1;
+
+        /* Not after the set timeout of the frames already waiting, the set is then delivered partial */
+        if (oldest_ns != UINT64_MAX) {
+            set_wait_ns = oldest_ns + group->ns_set_timeout - now_ns;
+            if ((wait_ns < 0) || (set_wait_ns < wait_ns)) {
+                wait_ns = set_wait_ns;
+            }
+        }
+
+        ret = eviewitf_capture_get_frame(group->cam_id[missing], wait_ns,
+                                         &group->pending[missing][group->nb_pending[missing]]);
+        if (ret == EVIEWITF_OK) {
+            group->nb_pending[missing]++;
+        } else if ((ret == EVIEWITF_TOO_MANY_HELD) && (oldest_ns != UINT64_MAX)) {
+            /* The missing frame cannot be taken, the set is delivered partial once its set timeout has elapsed */
+            if (wait_ns > 0) {
+                delay.tv_sec = wait_ns / 1000000000;
+                delay.tv_nsec = wait_ns % 1000000000;
+                clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, NULL);
+            }
+        } else if (ret != EVIEWITF_BLOCKED) {
+            return ret;
+        }
+    }
+}
+
+eviewitf_ret_t eviewitf_sync_release_set(eviewitf_sync_group_t *group, eviewitf_sync_set_t *set) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    if ((group == NULL) || (set == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    for (int i = 0; i < group->nb_cam; i++) {
+        if (set->present[i]) {
+            if (eviewitf_capture_release_frame(group->cam_id[i], &set->frames[i]) != EVIEWITF_OK) {
+                ret = EVIEWITF_FAIL;
+            }
+            set->present[i] = 0;
+        }
+    }
+    set->nb_frames = 0;
+
+    return ret;
+}
+
+eviewitf_ret_t eviewitf_sync_get_stats(eviewitf_sync_group_t *group, eviewitf_sync_stats_t *stats) {
+    if ((group == NULL) || (stats == NULL)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    *stats = group->stats;
+    return EVIEWITF_OK;
+}
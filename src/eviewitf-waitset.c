@@ -0,0 +1,292 @@
+/**
+ * @file eviewitf-waitset.c
+ * @brief Communication API between A53 and R7 CPUs for wait sets
+ * @author LACROIX Impulse
+ *
+ * API to wait for events on several devices and file descriptors, based on epoll.
+ *
+ */
+
+/* Needed for ppoll */
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "eviewitf-priv.h"
+
+/******************************************************************************************
+ * Private definitions
+ ******************************************************************************************/
+/**
+ * @brief Number of ns in a ms
+ */
+#define WAITSET_NS_PER_MS 1000000LL
+
+/**
+ * @brief Number of ns in a s
+ */
+#define WAITSET_NS_PER_S 1000000000LL
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef waitset_entry_t
+ * @brief Wait set entry
+ *
+ * @struct waitset_entry
+ * @brief Device or file descriptor registered in a wait set
+ */
+typedef struct waitset_entry {
+    uint8_t used;                     /*!< Entry is in use */
+    eviewitf_waitset_source_t source; /*!< Source of the events */
+    int id;                           /*!< Camera id or file descriptor */
+    int fd;                           /*!< File descriptor registered in epoll */
+    void *user_ctx;                   /*!< User context */
+} waitset_entry_t;
+
+/**
+ * @struct eviewitf_waitset
+ * @brief Wait set
+ */
+struct eviewitf_waitset {
+    int epoll_fd;                                          /*!< epoll file descriptor */
+    uint32_t flags;                                        /*!< Wait set flags */
+    waitset_entry_t entries[EVIEWITF_WAITSET_MAX_ENTRIES]; /*!< Registered entries */
+};
+
+/******************************************************************************************
+ * Functions
+ ******************************************************************************************/
+
+/**
+ * @fn static waitset_entry_t *waitset_find(eviewitf_waitset_t *waitset, eviewitf_waitset_source_t source, int id)
+ * @brief Find a registered entry
+ *
+ * @param waitset: wait set
+ * @param source: source of the entry
+ * @param id: camera id or file descriptor
+ * @return pointer on the entry or NULL
+ */
+static waitset_entry_t *waitset_find(eviewitf_waitset_t *waitset, eviewitf_waitset_source_t source, int id) {
+    for (int i = 0; i < EVIEWITF_WAITSET_MAX_ENTRIES; i++) {
+        if (waitset->entries[i].used && (waitset->entries[i].source == source) && (waitset->entries[i].id == id)) {
+            return &waitset->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @fn static eviewitf_ret_t waitset_add(eviewitf_waitset_t *waitset, eviewitf_waitset_source_t source, int id, int fd,
+ *                                      uint32_t events, void *user_ctx)
+ * @brief Register an entry
+ *
+ * @param waitset: wait set
+ * @param source: source of the entry
+ * @param id: camera id or file descriptor
+ * @param fd: file descriptor to register in epoll
+ * @param events: poll events to wait for
+ * @param user_ctx: user context
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t waitset_add(eviewitf_waitset_t *waitset, eviewitf_waitset_source_t source, int id, int fd,
+                                  uint32_t events, void *user_ctx) {
+    struct epoll_event event;
+    waitset_entry_t *entry = NULL;
+
+    if (waitset_find(waitset, source, id) != NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    for (int i = 0; i < EVIEWITF_WAITSET_MAX_ENTRIES; i++) {
+        if (!waitset->entries[i].used) {
+            entry = &waitset->entries[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        return EVIEWITF_FAIL;
+    }
+
+    /* poll and epoll event flags have the same values */
+    event.events = events;
+    if (waitset->flags & EVIEWITF_WAITSET_EDGE_TRIGGERED) {
+        event.events |= EPOLLET;
+    }
+    event.data.ptr = entry;
+    if (epoll_ctl(waitset->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return EVIEWITF_FAIL;
+    }
+
+    entry->source = source;
+    entry->id = id;
+    entry->fd = fd;
+    entry->user_ctx = user_ctx;
+    entry->used = 1;
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn static eviewitf_ret_t waitset_remove(eviewitf_waitset_t *waitset, eviewitf_waitset_source_t source, int id)
+ * @brief Remove an entry
+ *
+ * @param waitset: wait set
+ * @param source: source of the entry
+ * @param id: camera id or file descriptor
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t waitset_remove(eviewitf_waitset_t *waitset, eviewitf_waitset_source_t source, int id) {
+    waitset_entry_t *entry = waitset_find(waitset, source, id);
+
+    if (entry == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    /* The file descriptor may already be closed, and thus already removed from epoll */
+    epoll_ctl(waitset->epoll_fd, EPOLL_CTL_DEL, entry->fd, NULL);
+    entry->used = 0;
+
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_waitset_create(eviewitf_waitset_t **waitset, uint32_t flags) {
+    eviewitf_waitset_t *new_waitset;
+
+    if ((waitset == NULL) || (flags & ~EVIEWITF_WAITSET_EDGE_TRIGGERED)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    new_waitset = calloc(1, sizeof(eviewitf_waitset_t));
+    if (new_waitset == NULL) {
+        return EVIEWITF_FAIL;
+    }
+
+    new_waitset->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (new_waitset->epoll_fd < 0) {
+        free(new_waitset);
+        return EVIEWITF_FAIL;
+    }
+    new_waitset->flags = flags;
+
+    *waitset = new_waitset;
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_waitset_destroy(eviewitf_waitset_t *waitset) {
+    if (waitset == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    close(waitset->epoll_fd);
+    free(waitset);
+    return EVIEWITF_OK;
+}
+
+eviewitf_ret_t eviewitf_waitset_add_camera(eviewitf_waitset_t *waitset, int cam_id) {
+    int fd;
+
+    /* Test camera id */
+    if ((waitset == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    fd = device_get_fd(device_default_ctx(), cam_id + EVIEWITF_OFFSET_CAMERA);
+    if (fd == -1) {
+        return EVIEWITF_NOT_OPENED;
+    }
+
+    return waitset_add(waitset, EVIEWITF_WAITSET_SOURCE_CAMERA, cam_id, fd, POLLIN, NULL);
+}
+
+eviewitf_ret_t eviewitf_waitset_remove_camera(eviewitf_waitset_t *waitset, int cam_id) {
+    /* Test camera id */
+    if ((waitset == NULL) || (cam_id < 0) || (cam_id >= EVIEWITF_MAX_CAMERA)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    return waitset_remove(waitset, EVIEWITF_WAITSET_SOURCE_CAMERA, cam_id);
+}
+
+eviewitf_ret_t eviewitf_waitset_add_fd(eviewitf_waitset_t *waitset, int fd, uint32_t events, void *user_ctx) {
+    if ((waitset == NULL) || (fd < 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    return waitset_add(waitset, EVIEWITF_WAITSET_SOURCE_FD, fd, fd, events, user_ctx);
+}
+
+eviewitf_ret_t eviewitf_waitset_remove_fd(eviewitf_waitset_t *waitset, int fd) {
+    if (waitset == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    return waitset_remove(waitset, EVIEWITF_WAITSET_SOURCE_FD, fd);
+}
+
+eviewitf_ret_t eviewitf_waitset_wait(eviewitf_waitset_t *waitset, int64_t ns_timeout, eviewitf_waitset_event_t *events,
+                                     int max_events, int *nb_events) {
+    struct epoll_event epoll_events[EVIEWITF_WAITSET_MAX_ENTRIES];
+    pollfd_t pfd;
+    struct timespec timeout;
+    waitset_entry_t *entry;
+    int ms_timeout;
+    int ready;
+
+    if ((waitset == NULL) || (events == NULL) || (nb_events == NULL) || (max_events <= 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+    if (max_events > EVIEWITF_WAITSET_MAX_ENTRIES) {
+        max_events = EVIEWITF_WAITSET_MAX_ENTRIES;
+    }
+    *nb_events = 0;
+
+    if ((ns_timeout < 0) || ((ns_timeout % WAITSET_NS_PER_MS) == 0)) {
+        /* Timeout can be handled by epoll directly, longer ones are clamped rather than wrapped to infinite */
+        if (ns_timeout < 0) {
+            ms_timeout = -1;
+        } else if (ns_timeout / WAITSET_NS_PER_MS > INT_MAX) {
+            ms_timeout = INT_MAX;
+        } else {
+            ms_timeout = (int)(ns_timeout / WAITSET_NS_PER_MS);
+        }
+    } else {
+        /* Wait on the epoll file descriptor itself with a ns timeout, then collect the events without waiting */
+        pfd.fd = waitset->epoll_fd;
+        pfd.events = POLLIN;
+        timeout.tv_sec = ns_timeout / WAITSET_NS_PER_S;
+        timeout.tv_nsec = ns_timeout % WAITSET_NS_PER_S;
+        ready = ppoll(&pfd, 1, &timeout, NULL);
+        if (ready <= 0) {
+            return ((ready == 0) || (errno == EINTR)) ? EVIEWITF_OK : EVIEWITF_FAIL;
+        }
+        ms_timeout = 0;
+    }
+
+    ready = epoll_wait(waitset->epoll_fd, epoll_events, max_events, ms_timeout);
+    if (ready < 0) {
+        return (errno == EINTR) ? EVIEWITF_OK : EVIEWITF_FAIL;
+    }
+
+    for (int i = 0; i < ready; i++) {
+        entry = epoll_events[i].data.ptr;
+        events[i].source = entry->source;
+        events[i].id = entry->id;
+        events[i].events = epoll_events[i].events;
+        events[i].user_ctx = entry->user_ctx;
+        if ((entry->source == EVIEWITF_WAITSET_SOURCE_CAMERA) && (epoll_events[i].events & POLLIN)) {
+            stats_camera_wake(entry->id);
+        }
+    }
+    *nb_events = ready;
+
+    return EVIEWITF_OK;
+}
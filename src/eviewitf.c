@@ -37,6 +37,11 @@
  */
 static uint8_t eviewitf_global_init = 0;
 
+/**
+ * @brief Flags given to the initialization
+ */
+static uint32_t eviewitf_init_flags = 0;
+
 /**
  * @brief eView version
  */
@@ -64,6 +69,19 @@ static pthread_mutex_t eviewitf_deinit_mutex = PTHREAD_MUTEX_INITIALIZER;
  */
 eviewitf_ret_t eviewitf_is_initialized() { return eviewitf_global_init; }
 
+/**
+ * @fn void init_trace(const char *step, uint64_t start_ns)
+ * @brief Report the duration of an initialization step, if requested through EVIEWITF_INIT_TRACE
+ *
+ * @param step: name of the step
+ * @param start_ns: time the step started, from stats_now_ns
+ */
+void init_trace(const char *step, uint64_t start_ns) {
+    if (eviewitf_init_flags & EVIEWITF_INIT_TRACE) {
+        fprintf(stderr, "eviewitf: %s in %llu us\n", step, (unsigned long long)(stats_now_ns() - start_ns) / 1000);
+    }
+}
+
 /**
  * @fn eviewitf_init
  * @brief Initialize the eViewItf API
@@ -75,9 +93,20 @@ eviewitf_ret_t eviewitf_is_initialized() { return eviewitf_global_init; }
  * This function must be called before any other function of this API.
  * Otherwise, the other functions will return the error code EVIEWITF_NOT_INITIALIZED (eviewitf_return_state).
  */
-eviewitf_ret_t eviewitf_init(void) {
+eviewitf_ret_t eviewitf_init(void) { return eviewitf_init_ex(0); }
+
+/**
+ * @fn eviewitf_init_ex
+ * @brief Initialize the eViewItf API with options
+ * @ingroup eview
+ *
+ * @param[in] flags combination of EVIEWITF_INIT_* flags
+ * @return Return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_init_ex(uint32_t flags) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     int32_t request[EVIEWITF_MFIS_MSG_SIZE] = {0};
+    uint64_t start_ns;
 
     /* Critical section */
     pthread_mutex_lock(&eviewitf_init_mutex);
@@ -86,21 +115,27 @@ eviewitf_ret_t eviewitf_init(void) {
     if (eviewitf_global_init != 0) {
         ret = EVIEWITF_ALREADY_INITIALIZED;
     } else {
+        eviewitf_init_flags = flags;
+
+        start_ns = stats_now_ns();
         mfis_init();
+        init_trace("communication opened", start_ns);
 
         /* Prepare TX buffer */
         request[0] = EVIEWITF_MFIS_FCT_INIT;
 
         /* Send request to R7 and check returned answer state*/
+        start_ns = stats_now_ns();
         ret = mfis_send_request(request);
         if ((ret < EVIEWITF_OK) || (request[0] != EVIEWITF_MFIS_FCT_INIT) ||
             (request[1] != EVIEWITF_MFIS_FCT_RETURN_OK)) {
             ret = EVIEWITF_FAIL;
         }
+        init_trace("eView initialized", start_ns);
 
-        /* Devices initialization */
+        /* Devices initialization, deferred to their first use if lazy */
         if (ret == EVIEWITF_OK) {
-            ret = device_objects_init();
+            ret = device_objects_init(flags);
         }
 
         if (ret == EVIEWITF_OK) {
@@ -113,6 +148,38 @@ eviewitf_ret_t eviewitf_init(void) {
     return ret;
 }
 
+/**
+ * @fn eviewitf_refresh_attributes
+ * @brief Retrieve again the devices attributes from eView
+ * @ingroup eview
+ *
+ * @param[out] generation attributes generation once refreshed, may be NULL
+ * @return Return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_refresh_attributes(uint32_t *generation) {
+    eviewitf_ret_t ret;
+
+    if (eviewitf_global_init == 0) {
+        return EVIEWITF_NOT_INITIALIZED;
+    }
+
+    ret = device_refresh();
+    if (generation != NULL) {
+        *generation = device_get_attributes_generation();
+    }
+
+    return ret;
+}
+
+/**
+ * @fn eviewitf_get_attributes_generation
+ * @brief Get the number of times the attributes of a device have changed
+ * @ingroup eview
+ *
+ * @return attributes generation
+ */
+uint32_t eviewitf_get_attributes_generation(void) { return device_get_attributes_generation(); }
+
 /**
  * @fn eviewitf_deinit
  * @brief De-initialize the eViewItf API
@@ -133,6 +200,12 @@ eviewitf_ret_t eviewitf_deinit(void) {
     if (eviewitf_global_init == 0) {
         ret = EVIEWITF_NOT_INITIALIZED;
     } else {
+        /* Join the threads issuing requests before closing the communication: the capture threads first, they can
+         * submit asynchronous requests, then the asynchronous worker once the pending requests are submitted */
+        capture_deinit();
+        async_deinit();
+        camera_deinit();
+
         /* Prepare TX buffer */
         request[0] = EVIEWITF_MFIS_FCT_DEINIT;
 
@@ -156,6 +229,61 @@ eviewitf_ret_t eviewitf_deinit(void) {
     return ret;
 }
 
+/**
+ * @fn eviewitf_ctx_create
+ * @brief Create a library context
+ * @ingroup eview
+ *
+ * @param[out] ctx created context
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ *
+ * The context is allocated by the calling thread, the one expected to use it.
+ */
+eviewitf_ret_t eviewitf_ctx_create(eviewitf_ctx_t **ctx) {
+    eviewitf_ctx_t *new_ctx;
+
+    if (ctx == NULL) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    new_ctx = malloc(sizeof(eviewitf_ctx_t));
+    if (new_ctx == NULL) {
+        return EVIEWITF_FAIL;
+    }
+    device_ctx_init(new_ctx);
+
+    *ctx = new_ctx;
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn eviewitf_ctx_destroy
+ * @brief Destroy a library context, closing the devices still opened in it
+ * @ingroup eview
+ *
+ * @param[in] ctx context created through eviewitf_ctx_create
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t eviewitf_ctx_destroy(eviewitf_ctx_t *ctx) {
+    if ((ctx == NULL) || (ctx == device_default_ctx())) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    device_ctx_release(ctx);
+    free(ctx);
+
+    return EVIEWITF_OK;
+}
+
+/**
+ * @fn eviewitf_ctx_get_default
+ * @brief Get the default library context, used by the functions without context
+ * @ingroup eview
+ *
+ * @return default context
+ */
+eviewitf_ctx_t *eviewitf_ctx_get_default(void) { return device_default_ctx(); }
+
 /**
  * @fn eviewitf_ret_t camera_display(int cam_id)
  * @brief Request R7 to select camera device as display input
@@ -13,6 +13,7 @@
 #include "pipeline.h"
 #include "legacy.h"
 #include "video.h"
+#include "stats.h"
 #include <string.h>
 
 /**
@@ -59,6 +60,11 @@ int main(int argc, char **argv) {
         argv++;
         ret = video_parse(argc, argv);
         goto out;
+    } else if (!strcmp("stats", argv[1])) {
+        argc--;
+        argv++;
+        ret = stats_parse(argc, argv);
+        goto out;
     }
 
     ret = legacy_parse(argc, argv);
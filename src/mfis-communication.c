@@ -18,7 +18,7 @@
 #include <sys/mman.h>
 #include <pthread.h>
 
-#include "eviewitf.h"
+#include "eviewitf-priv.h"
 #include "mfis-communication.h"
 #include "mfis-ioctl.h"
 
@@ -26,29 +26,191 @@
  * Private definitions
  ******************************************************************************************/
 /**
- * @brief mfis mutex
+ * @brief Number of device types having their own request locks
  */
-pthread_mutex_t mfis_mutex;
+#define MFIS_LOCK_DEVTYPES (MFIS_DEV_VIDEO + 1)
+
+/**
+ * @brief Number of request locks per device type, devices sharing a lock are serialized
+ */
+#define MFIS_LOCK_DEVIDS 16
+
+/******************************************************************************************
+ * Private structures
+ ******************************************************************************************/
+/**
+ * @typedef mfis_channel_t
+ * @brief MFIS control channel
+ *
+ * @struct mfis_channel
+ * @brief MFIS control channel, kept open between requests
+ */
+typedef struct mfis_channel {
+    pthread_rwlock_t lock; /*!< Held for reading while issuing requests, for writing while (re)opening */
+    int fd;                /*!< File descriptor on the MFIS ioctl device, -1 when closed */
+    uint8_t closed;        /*!< Closed by mfis_deinit, not reopened until mfis_init */
+} mfis_channel_t;
+
+/******************************************************************************************
+ * Private variables
+ ******************************************************************************************/
+/**
+ * @brief mfis mutex for function requests (init, display, blending...)
+ *
+ * The mutexes are never destroyed, so that threads still issuing requests during or after mfis_deinit can use them.
+ */
+static pthread_mutex_t mfis_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief mfis mutexes for I/O requests, per device type and device identifier
+ */
+static pthread_mutex_t mfis_dev_mutex[MFIS_LOCK_DEVTYPES][MFIS_LOCK_DEVIDS] = {
+    [0 ... MFIS_LOCK_DEVTYPES - 1] = {[0 ... MFIS_LOCK_DEVIDS - 1] = PTHREAD_MUTEX_INITIALIZER}};
+
+/**
+ * @brief mfis control channel
+ */
+static mfis_channel_t mfis_channel = {.lock = PTHREAD_RWLOCK_INITIALIZER, .fd = -1, .closed = 0};
 
 /******************************************************************************************
  * Functions
  ******************************************************************************************/
 
+/**
+ * @fn static pthread_mutex_t *mfis_dev_lock(uint8_t devtype, uint8_t devid)
+ * @brief Get the lock serializing the I/O requests of a device
+ *
+ * @param devtype: device type
+ * @param devid: device identifier
+ * @return pointer on the device lock
+ */
+static pthread_mutex_t *mfis_dev_lock(uint8_t devtype, uint8_t devid) {
+    return &mfis_dev_mutex[devtype % MFIS_LOCK_DEVTYPES][devid % MFIS_LOCK_DEVIDS];
+}
+
+/**
+ * @fn static void mfis_channel_reopen(int stale_fd)
+ * @brief Open the MFIS control channel, closing it first if it is still the stale one
+ *
+ * Several threads can detect the same stale channel, only the first one reopens it. Once closed by mfis_deinit, the
+ * channel is not reopened until mfis_init.
+ *
+ * @param stale_fd: file descriptor found unusable, -1 if the channel was found closed
+ */
+static void mfis_channel_reopen(int stale_fd) {
+    pthread_rwlock_wrlock(&mfis_channel.lock);
+    if ((stale_fd >= 0) && (mfis_channel.fd == stale_fd)) {
+        close(mfis_channel.fd);
+        mfis_channel.fd = -1;
+    }
+    if ((mfis_channel.fd < 0) && !mfis_channel.closed) {
+        mfis_channel.fd = open(MFIS_IOCTL_DEVICE_NAME, O_RDWR | O_CLOEXEC);
+        if (mfis_channel.fd < 0) {
+            fprintf(stderr, "%s() error cannot open ioctl file : %s\n", __FUNCTION__, strerror(errno));
+        }
+    }
+    pthread_rwlock_unlock(&mfis_channel.lock);
+}
+
+/**
+ * @fn static void mfis_channel_close(void)
+ * @brief Close the MFIS control channel, until mfis_init
+ */
+static void mfis_channel_close(void) {
+    pthread_rwlock_wrlock(&mfis_channel.lock);
+    if (mfis_channel.fd >= 0) {
+        close(mfis_channel.fd);
+        mfis_channel.fd = -1;
+    }
+    mfis_channel.closed = 1;
+    pthread_rwlock_unlock(&mfis_channel.lock);
+}
+
+/**
+ * @fn static int mfis_channel_try_ioctl(unsigned long request, void *arg, int *fd)
+ * @brief Issue an ioctl on the current MFIS control channel
+ *
+ * The channel read lock is held during the ioctl so that it cannot be closed meanwhile, requests of several threads
+ * are issued concurrently. Each request carries its whole message and previous versions opened a file descriptor per
+ * request, so the driver keeps no state per file descriptor: it already serves the concurrent requests of several
+ * processes the same way.
+ *
+ * @param request: ioctl request
+ * @param arg: ioctl argument
+ * @param[out] fd: file descriptor the ioctl was issued on, -1 if the channel is closed
+ * @return ioctl return value, negative on error
+ */
+static int mfis_channel_try_ioctl(unsigned long request, void *arg, int *fd) {
+    int ret = -1;
+
+    pthread_rwlock_rdlock(&mfis_channel.lock);
+    *fd = mfis_channel.fd;
+    if (*fd >= 0) {
+        ret = ioctl(*fd, request, arg);
+    } else {
+        errno = EBADF;
+    }
+    pthread_rwlock_unlock(&mfis_channel.lock);
+
+    return ret;
+}
+
+/**
+ * @fn static int mfis_channel_ioctl(unsigned long request, void *arg)
+ * @brief Issue an ioctl on the MFIS control channel
+ *
+ * The channel is opened on first use. If the ioctl fails because the channel itself is no longer usable (driver
+ * unbound or reloaded), the channel is reopened and the ioctl is issued once more: in those cases the request never
+ * reached the R7, so it is safe to send it again. Other errors are returned as is.
+ *
+ * @param request: ioctl request
+ * @param arg: ioctl argument
+ * @return ioctl return value, negative on error
+ */
+static int mfis_channel_ioctl(unsigned long request, void *arg) {
+    int ret;
+    int fd;
+
+    ret = mfis_channel_try_ioctl(request, arg, &fd);
+    if ((ret < 0) && ((errno == EBADF) || (errno == ENODEV) || (errno == ENXIO))) {
+        /* Reconnect and retry once */
+        mfis_channel_reopen(fd);
+        ret = mfis_channel_try_ioctl(request, arg, &fd);
+    }
+
+    return ret;
+}
+
 /**
  * @fn int mfis_init()
  * @brief Intialize mfis.
  *
+ * The control channel is opened here and kept opened until mfis_deinit. A failure to open it is not fatal, the
+ * opening is attempted again on the next request.
+ *
  * @return state of the function. Return 0 if okay
  */
-int mfis_init() { return pthread_mutex_init(&mfis_mutex, NULL); }
+int mfis_init() {
+    pthread_rwlock_wrlock(&mfis_channel.lock);
+    mfis_channel.closed = 0;
+    pthread_rwlock_unlock(&mfis_channel.lock);
+
+    mfis_channel_reopen(-1);
+    return 0;
+}
 
 /**
  * @fn int mfis_deinit()
  * @brief Deintialize mfis.
  *
+ * The requests issued afterwards fail, the control channel is not reopened for them.
+ *
  * @return state of the function. Return 0 if okay
  */
-int mfis_deinit() { return pthread_mutex_destroy(&mfis_mutex); }
+int mfis_deinit() {
+    mfis_channel_close();
+    return 0;
+}
 
 /**
  * @fn int mfis_send_request(int32_t* request)
@@ -58,25 +220,28 @@ int mfis_deinit() { return pthread_mutex_destroy(&mfis_mutex); }
  * @return state of the function. Return 0 if okay
  */
 int mfis_send_request(int32_t* request) {
-    int fd, ret;
+    int ret;
+    uint8_t funcid = (uint8_t)request[0];
+    eviewitf_ret_t result = EVIEWITF_OK;
+    uint64_t start_ns;
 
     pthread_mutex_lock(&mfis_mutex);
-    /* Open MFIS IOCTL */
-    fd = open("/dev/mfis_ioctl", O_RDWR);
-    if (fd < 0) {
-        fprintf(stderr, "%s() error cannot open ioctl file : %s\n", __FUNCTION__, strerror(errno));
-        ret = fd;
-        goto out_ret;
-    }
 
     /* Send message over MFIS */
-    ret = ioctl(fd, EVIEWITF_MFIS_FCT, (int32_t*)request);
+    start_ns = stats_now_ns();
+    ret = mfis_channel_ioctl(EVIEWITF_MFIS_FCT, (int32_t*)request);
     if (ret < 0) {
         fprintf(stderr, "%s() ioctl write error : %s\n", __FUNCTION__, strerror(errno));
+        result = EVIEWITF_FAIL;
+    } else if (request[1] == EVIEWITF_MFIS_FCT_RETURN_BLOCKED) {
+        result = EVIEWITF_BLOCKED;
+    } else if (request[1] == EVIEWITF_MFIS_FCT_INV_PARAM) {
+        result = EVIEWITF_INVALID_PARAM;
+    } else if ((request[0] != funcid) || (request[1] != EVIEWITF_MFIS_FCT_RETURN_OK)) {
+        result = EVIEWITF_FAIL;
     }
+    stats_record(EVIEWITF_STATS_DEVTYPE_FUNCTION, funcid, result, start_ns);
 
-    close(fd);
-out_ret:
     pthread_mutex_unlock(&mfis_mutex);
     return ret;
 }
@@ -90,30 +255,17 @@ out_ret:
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
 eviewitf_ret_t mfis_get_cam_attributes(eviewitf_mfis_camera_attributes_t* cameras_attributes) {
-    int fd;
-    eviewitf_ret_t ret;
+    eviewitf_ret_t ret = EVIEWITF_OK;
     pthread_mutex_lock(&mfis_mutex);
 
-    /* Open the mfis device */
-    fd = open("/dev/mfis_ioctl", O_RDWR);
-    if (fd < 0) {
-        fprintf(stderr, "%s() error cannot open ioctl file : %s\n", __FUNCTION__, strerror(errno));
-        pthread_mutex_unlock(&mfis_mutex);
-        return EVIEWITF_FAIL;
-    }
-
     /* Call to the ioctl */
-    ret = ioctl(fd, EVIEWITF_MFIS_CAMERA_ATTRIBUTES, cameras_attributes);
-    if (ret < 0) {
+    if (mfis_channel_ioctl(EVIEWITF_MFIS_CAMERA_ATTRIBUTES, cameras_attributes) < 0) {
         fprintf(stderr, "%s() ioctl error : %s\n", __FUNCTION__, strerror(errno));
-        pthread_mutex_unlock(&mfis_mutex);
-        return EVIEWITF_FAIL;
+        ret = EVIEWITF_FAIL;
     }
 
-    /* Close the file descriptor and release the mutex */
-    close(fd);
     pthread_mutex_unlock(&mfis_mutex);
-    return EVIEWITF_OK;
+    return ret;
 }
 
 /**
@@ -125,34 +277,22 @@ eviewitf_ret_t mfis_get_cam_attributes(eviewitf_mfis_camera_attributes_t* camera
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
 eviewitf_ret_t mfis_get_blend_attributes(eviewitf_mfis_blending_attributes_t* blendings_attributes) {
-    int fd;
-    eviewitf_ret_t ret;
+    eviewitf_ret_t ret = EVIEWITF_OK;
     pthread_mutex_lock(&mfis_mutex);
 
-    /* Open the mfis device */
-    fd = open("/dev/mfis_ioctl", O_RDWR);
-    if (fd < 0) {
-        fprintf(stderr, "%s() error cannot open ioctl file : %s\n", __FUNCTION__, strerror(errno));
-        pthread_mutex_unlock(&mfis_mutex);
-        return EVIEWITF_FAIL;
-    }
-
     /* Call to the ioctl */
-    ret = ioctl(fd, EVIEWITF_MFIS_BLENDING_ATTRIBUTES, blendings_attributes);
-    if (ret < 0) {
+    if (mfis_channel_ioctl(EVIEWITF_MFIS_BLENDING_ATTRIBUTES, blendings_attributes) < 0) {
         fprintf(stderr, "%s() ioctl error : %s\n", __FUNCTION__, strerror(errno));
-        pthread_mutex_unlock(&mfis_mutex);
-        return EVIEWITF_FAIL;
+        ret = EVIEWITF_FAIL;
     }
 
-    /* Close the file descriptor and release the mutex */
-    close(fd);
     pthread_mutex_unlock(&mfis_mutex);
-    return EVIEWITF_OK;
+    return ret;
 }
 
 /**
- * @brief Delivers an ioctl to the MFIS driver
+ * @fn static eviewitf_ret_t mfis_ioctl_request_locked(uint8_t devtype, uint8_t devid, uint16_t cmd, void* param)
+ * @brief Delivers an ioctl to the MFIS driver, the caller must hold the device lock
  *
  * @param[in]  devtype       Device type
  * @param[in]  devid         Device identifier
@@ -160,11 +300,11 @@ eviewitf_ret_t mfis_get_blend_attributes(eviewitf_mfis_blending_attributes_t* bl
  * @param[in]  param         I/O parameter
  * @return return code as specified by the eviewitf_ret_t enumeration.
  */
-eviewitf_ret_t mfis_ioctl_request(uint8_t devtype, uint8_t devid, uint16_t cmd, void* param) {
-    int fd;
+static eviewitf_ret_t mfis_ioctl_request_locked(uint8_t devtype, uint8_t devid, uint16_t cmd, void* param) {
     eviewitf_ret_t ret = EVIEWITF_OK;
     uint32_t msg[EVIEWITF_MFIS_MSG_SIZE];
     mfis_ioctl_t* hdr;
+    uint64_t start_ns;
 
     /* Prepares the message header */
     hdr = (mfis_ioctl_t*)msg;
@@ -178,22 +318,13 @@ eviewitf_ret_t mfis_ioctl_request(uint8_t devtype, uint8_t devid, uint16_t cmd,
     /* Copies the parameter based on the IOC message size */
     if (param && MFIS_IOCSZ(cmd) > 0) memcpy(msg + 2, param, MFIS_IOCSZ(cmd));
 
-    pthread_mutex_lock(&mfis_mutex);
-    /* Open MFIS IOCTL */
-    fd = open("/dev/mfis_ioctl", O_RDWR);
-    if (fd < 0) {
-        fprintf(stderr, "%s() error cannot open ioctl file : %s\n", __FUNCTION__, strerror(errno));
-        ret = EVIEWITF_FAIL;
-        goto out_ret;
-    }
-
     /* Send message over MFIS */
-    ret = ioctl(fd, EVIEWITF_MFIS_FCT, (uint32_t*)msg);
-    close(fd);
+    start_ns = stats_now_ns();
+    ret = mfis_channel_ioctl(EVIEWITF_MFIS_FCT, (uint32_t*)msg);
     if (ret < 0) {
         fprintf(stderr, "%s() ioctl write error : %s\n", __FUNCTION__, strerror(errno));
-        ret = EVIEWITF_FAIL;
-        goto out_ret;
+        stats_record(devtype, MFIS_IOCNR(cmd), EVIEWITF_FAIL, start_ns);
+        return EVIEWITF_FAIL;
     }
 
     /* Copies the parameter based on the IOC message size */
@@ -209,8 +340,58 @@ eviewitf_ret_t mfis_ioctl_request(uint8_t devtype, uint8_t devid, uint16_t cmd,
     } else if (hdr->result == EVIEWITF_MFIS_FCT_RETURN_BLOCKED) {
         ret = EVIEWITF_BLOCKED;
     }
+    stats_record(devtype, MFIS_IOCNR(cmd), ret, start_ns);
+
+    return ret;
+}
+
+/**
+ * @brief Delivers an ioctl to the MFIS driver
+ *
+ * @param[in]  devtype       Device type
+ * @param[in]  devid         Device identifier
+ * @param[in]  cmd           I/O command
+ * @param[in]  param         I/O parameter
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+eviewitf_ret_t mfis_ioctl_request(uint8_t devtype, uint8_t devid, uint16_t cmd, void* param) {
+    eviewitf_ret_t ret;
+
+    pthread_mutex_t *lock = mfis_dev_lock(devtype, devid);
+
+    /* Requests of a device are serialized, requests of different devices are not */
+    pthread_mutex_lock(lock);
+    ret = mfis_ioctl_request_locked(devtype, devid, cmd, param);
+    pthread_mutex_unlock(lock);
+
+    return ret;
+}
+
+/**
+ * @brief Delivers a set of ioctls to the MFIS driver in a single submission
+ *
+ * The MFIS driver only accepts one message per ioctl, so the requests are sent back to back on the control channel.
+ * Each request only holds the lock of its device, requests of other devices can be interleaved with the set.
+ * Every request is sent even if a previous one failed.
+ *
+ * @param[inout] requests    Table of requests, the result field of each request is filled in
+ * @param[in]    nb_requests Number of requests in the table
+ * @return EVIEWITF_OK if all the requests succeeded, otherwise the result of the first failed request.
+ */
+eviewitf_ret_t mfis_ioctl_batch_request(mfis_ioctl_desc_t* requests, int nb_requests) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+
+    if ((requests == NULL) || (nb_requests < 0)) {
+        return EVIEWITF_INVALID_PARAM;
+    }
+
+    for (int i = 0; i < nb_requests; i++) {
+        requests[i].result =
+            mfis_ioctl_request(requests[i].devtype, requests[i].devid, requests[i].cmd, requests[i].param);
+        if ((ret == EVIEWITF_OK) && (requests[i].result != EVIEWITF_OK)) {
+            ret = requests[i].result;
+        }
+    }
 
-out_ret:
-    pthread_mutex_unlock(&mfis_mutex);
     return ret;
 }
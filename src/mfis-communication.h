@@ -13,10 +13,30 @@
 /******************************************************************************************
  * Typedef definitions
  ******************************************************************************************/
+/**
+ * @typedef mfis_ioctl_desc_t
+ * @brief MFIS ioctl request descriptor
+ *
+ * @struct mfis_ioctl_desc
+ * @brief MFIS ioctl request descriptor, used to submit several requests at once
+ */
+typedef struct mfis_ioctl_desc {
+    uint8_t devtype; /*!< Device type */
+    uint8_t devid;   /*!< Device identifier */
+    uint16_t cmd;    /*!< I/O command */
+    void *param;     /*!< I/O parameter */
+    int result;      /*!< Result of the request, as specified by the eviewitf_ret_t enumeration */
+} mfis_ioctl_desc_t;
 
 /******************************************************************************************
  * Public Definitions
  ******************************************************************************************/
+/**
+ * @brief MFIS ioctl device name, may be overridden at build time to use a stub device
+ */
+#ifndef MFIS_IOCTL_DEVICE_NAME
+#define MFIS_IOCTL_DEVICE_NAME "/dev/mfis_ioctl"
+#endif
 
 /******************************************************************************************
  * Public Functions Prototypes
@@ -27,5 +47,6 @@ int mfis_send_request(int32_t *request);
 int mfis_get_cam_attributes(eviewitf_mfis_camera_attributes_t *cameras_attributes);
 int mfis_get_blend_attributes(eviewitf_mfis_blending_attributes_t *blendings_attributes);
 int mfis_ioctl_request(uint8_t devtype, uint8_t devid, uint16_t cmd, void *param);
+int mfis_ioctl_batch_request(mfis_ioctl_desc_t *requests, int nb_requests);
 
 #endif /* MFIS_COMMUNICATION_H */
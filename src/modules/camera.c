@@ -7,6 +7,7 @@
  *
  */
 #include "camera.h"
+#include "stats.h"
 
 #include <argp.h>
 #include <stdlib.h>
@@ -46,8 +47,15 @@ typedef struct camera_arguments {
     int y_offset;         /*!< Y offset*/
     int cmd_pattern;      /*!< Pattern command activated */
     uint8_t pattern;      /*!< Selected pattern  */
+    int latency;          /*!< Latency indicator */
+    int latency_frames;   /*!< Number of frames to measure the latency on */
 } camera_arguments_t;
 
+/**
+ * @brief Delay to wait for a frame while measuring the latency (ms)
+ */
+#define CAMERA_LATENCY_TIMEOUT_MS 1000
+
 /* Possible patterns */
 /**
  * @typedef camera_pattern_mode_t
@@ -75,7 +83,7 @@ static char camera_doc[] =
  * @brief Arguments description
  */
 static char camera_args_doc[] =
-    "module:          [camera(default)|pipeline|video]\n"
+    "module:          [camera(default)|pipeline|video|stats]\n"
     "record:          -c[0-7] -r[???] (-p[PATH])\n"
     "play recordings: -s[0-7] -f[2-60] -p[PATH]\n"
     "write register:  -c[0-7] -Wa[0x????] -v[0x??]\n"
@@ -91,7 +99,8 @@ static char camera_args_doc[] =
     "set pattern:     -c[0-7] -t[pattern]\n"
     "get pattern:     -c[0-7] -T\n"
     "set frame rate:  -c[0-7] -f[2-60]\n"
-    "get frame rate:  -c[0-7] -F";
+    "get frame rate:  -c[0-7] -F\n"
+    "get latency:     -c[0-7] -l([FRAMES])";
 
 /* Program options */
 /**
@@ -117,6 +126,7 @@ static argp_option_t camera_options[] = {
     {"offset", 'J', 0, 0, "Get camera frame offset", 0},
     {"pattern", 't', "PATTERN", 0, "Set camera test pattern", 0},
     {"pattern", 'T', 0, 0, "Get camera test pattern", 0},
+    {"latency", 'l', "FRAMES", OPTION_ARG_OPTIONAL, "Get camera latency and drops, after reading FRAMES frames", 0},
     {0},
 };
 
@@ -236,6 +246,15 @@ static error_t camera_parse_opt(int key, char *arg, argp_state_t *state) {
                 argp_usage(state);
             }
             break;
+        case 'l':
+            arguments->latency = 1;
+            if (arg != NULL) {
+                arguments->latency_frames = atoi(arg);
+                if (arguments->latency_frames <= 0) {
+                    argp_usage(state);
+                }
+            }
+            break;
         case 'm':
             arguments->monitoring_info = 1;
             break;
@@ -292,6 +311,48 @@ static error_t camera_parse_opt(int key, char *arg, argp_state_t *state) {
     return 0;
 }
 
+/**
+ * @fn static eviewitf_ret_t camera_measure_latency(int cam_id, int nb_frames)
+ * @brief Read frames from a camera as soon as they are available, to measure their latency
+ * @param cam_id id of the camera
+ * @param nb_frames number of frames to read
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+static eviewitf_ret_t camera_measure_latency(int cam_id, int nb_frames) {
+    eviewitf_frame_metadata_info_t metadata;
+    eviewitf_device_attributes_t attributes;
+    eviewitf_ret_t ret;
+    uint8_t *buffer;
+    short event;
+
+    ret = eviewitf_camera_open(cam_id);
+    if (ret != EVIEWITF_OK) {
+        return ret;
+    }
+
+    ret = eviewitf_camera_get_attributes(cam_id, &attributes);
+    buffer = (ret == EVIEWITF_OK) ? malloc(attributes.buffer_size) : NULL;
+    if (buffer == NULL) {
+        ret = EVIEWITF_FAIL;
+    }
+
+    for (int i = 0; (i < nb_frames) && (ret == EVIEWITF_OK); i++) {
+        ret = eviewitf_camera_poll(&cam_id, 1, CAMERA_LATENCY_TIMEOUT_MS, &event);
+        if ((ret == EVIEWITF_OK) && !event) {
+            fprintf(stdout, "No frame received from camera id %d\n", cam_id);
+            ret = EVIEWITF_BLOCKED;
+        }
+        if (ret == EVIEWITF_OK) {
+            ret = eviewitf_camera_get_frame_with_metadata(cam_id, buffer, attributes.buffer_size, &metadata);
+        }
+    }
+
+    free(buffer);
+    eviewitf_camera_close(cam_id);
+
+    return ret;
+}
+
 /**
  * @brief argp parser
  */
@@ -321,6 +382,8 @@ eviewitf_ret_t camera_parse(int argc, char **argv) {
     arguments.x_offset = -1;
     arguments.y_offset = -1;
     arguments.cmd_pattern = -1;
+    arguments.latency = 0;
+    arguments.latency_frames = 0;
 
     /* Parse arguments; every option seen by parse_opt will
           be reflected in arguments. */
@@ -520,5 +583,18 @@ eviewitf_ret_t camera_parse(int argc, char **argv) {
             fprintf(stdout, "Fail to get test pattern on camera id %d\n", arguments.camera_id);
         }
     }
+
+    /* Get camera latency */
+    if ((arguments.camera_id >= 0) && arguments.latency) {
+        if (arguments.latency_frames > 0) {
+            eviewitf_init_ex(EVIEWITF_INIT_LAZY);
+            ret = camera_measure_latency(arguments.camera_id, arguments.latency_frames);
+            eviewitf_deinit();
+            if (ret < EVIEWITF_OK) {
+                fprintf(stdout, "Fail to read frames from camera id %d\n", arguments.camera_id);
+            }
+        }
+        stats_print_latency(arguments.camera_id);
+    }
     return ret;
 }
@@ -30,6 +30,7 @@ typedef struct legacy_arguments {
     int display;            /*!< Display indicator */
     int record;             /*!< Record indicator */
     int record_duration;    /*!< Record duration */
+    int legacy_layout;      /*!< Record one file per frame */
     int reg;                /*!< Register */
     uint32_t reg_address;   /*!< Register address */
     int val;                /*!< Value */
@@ -39,6 +40,7 @@ typedef struct legacy_arguments {
     int reboot;             /*!< Reboot indicator */
     int fps_value;          /*!< FPS value */
     int play;               /*!< Play indicator */
+    int catch_up;           /*!< Play the late frames instead of skipping them */
     char *path_frames_dir;  /*!< Frames directory path */
     int blending;           /*!< Blending indicator */
     char *path_blend_frame; /*!< Blend frame path */
@@ -87,8 +89,8 @@ static char legacy_args_doc[] =
     "module:          [camera(default)|pipeline]\n"
     "change display:  -d -c[0-7]\n"
     "change display:  -d -s[0-7]\n"
-    "record:          -c[0-7] -r[???] (-p[PATH])\n"
-    "play recordings: -s[0-7] -f[2-60] -p[PATH]\n"
+    "record:          -c[0-7] -r[???] (-p[PATH]) (-l)\n"
+    "play recordings: -s[0-7] -f[2-60] -p[PATH] (-k)\n"
     "write register:  -c[0-7] -Wa[0x????] -v[0x??]\n"
     "read register:   -c[0-7] -Ra[0x????]\n"
     "reboot a camera: -x -c[0-7]\n"
@@ -117,6 +119,7 @@ static argp_option_t legacy_options[] = {
     {"streamer", 's', "ID", 0, "Select streamer on which command occurs", 0},
     {"display", 'd', 0, 0, "Select camera as display", 0},
     {"record", 'r', "DURATION", 0, "Record camera ID stream on SSD for DURATION (s)", 0},
+    {"legacy-layout", 'l', 0, 0, "Record one file per frame instead of a single recording file", 0},
     {"address", 'a', "ADDRESS", 0, "Register ADDRESS on which read or write", 0},
     {"value", 'v', "VALUE", 0, "VALUE to write in the register", 0},
     {"read", 'R', 0, 0, "Read register", 0},
@@ -125,6 +128,7 @@ static argp_option_t legacy_options[] = {
     {"fps", 'f', "FPS", 0, "Set frame rate", 0},
     {"fps", 'F', 0, 0, "Get frame rate", 0},
     {"play", 'p', "PATH", 0, "Play a stream in <PATH> as a virtual camera", 0},
+    {"catch-up", 'k', 0, 0, "Play the late frames of a stream instead of skipping them", 0},
     {"blending", 'b', "PATH", 0, "Set the blending frame <PATH> over the display", 0},
     {"no-blending", 'n', 0, 0, "Stop the blending", 0},
     {"heartbeat", 'H', "STATE", 0, "Set R7 heartbeat state", 0},
@@ -278,6 +282,12 @@ static error_t legacy_parse_opt(int key, char *arg, argp_state_t *state) {
                 argp_usage(state);
             }
             break;
+        case 'k':
+            arguments->catch_up = 1;
+            break;
+        case 'l':
+            arguments->legacy_layout = 1;
+            break;
         case 'm':
             arguments->monitoring_info = 1;
             break;
@@ -372,6 +382,7 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
     arguments.streamer_id = -1;
     arguments.display = 0;
     arguments.record_duration = -1;
+    arguments.legacy_layout = 0;
     arguments.reg = 0;
     arguments.reg_address = 0;
     arguments.val = 0;
@@ -380,6 +391,7 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
     arguments.write = 0;
     arguments.reboot = 0;
     arguments.play = 0;
+    arguments.catch_up = 0;
     arguments.fps_value = -1;
     arguments.path_frames_dir = NULL;
     arguments.blender_id = -1;
@@ -402,7 +414,7 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
 
     /* Select camera for display */
     if ((arguments.camera_id >= 0) && arguments.display) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_display_select_camera(arguments.camera_id);
         if (ret >= 0) {
             fprintf(stdout, "Camera %d selected for display\n", arguments.camera_id);
@@ -413,7 +425,7 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
     }
     /* Select streamer for display */
     if ((arguments.streamer_id >= 0) && arguments.display) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_display_select_streamer(arguments.streamer_id);
         if (ret >= 0) {
             fprintf(stdout, "Streamer %d selected for display\n", arguments.streamer_id);
@@ -424,8 +436,9 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
     }
     /* Select camera for record */
     if ((arguments.camera_id >= 0) && (arguments.record_duration > 0)) {
-        eviewitf_init();
-        ret = eviewitf_app_record_cam(arguments.camera_id, arguments.record_duration, arguments.path_frames_dir);
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
+        ret = eviewitf_app_record_cam(arguments.camera_id, arguments.record_duration, arguments.legacy_layout,
+                                      arguments.path_frames_dir);
         if (ret >= 0) {
             fprintf(stdout, "Recorded %d s from camera %d\n", arguments.record_duration, arguments.camera_id);
         } else {
@@ -473,11 +486,13 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
 
     /* Playback on streamer */
     if ((arguments.streamer_id >= 0) && arguments.play) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         if (arguments.fps_value > 0) {
-            ret = eviewitf_app_streamer_play(arguments.streamer_id, arguments.fps_value, arguments.path_frames_dir);
+            ret = eviewitf_app_streamer_play(arguments.streamer_id, arguments.fps_value, arguments.catch_up,
+                                             arguments.path_frames_dir);
         } else {
-            ret = eviewitf_app_streamer_play(arguments.streamer_id, FPS_DEFAULT_VALUE, arguments.path_frames_dir);
+            ret = eviewitf_app_streamer_play(arguments.streamer_id, FPS_DEFAULT_VALUE, arguments.catch_up,
+                                             arguments.path_frames_dir);
         }
         if (ret >= EVIEWITF_OK) {
             fprintf(stdout, "Recording played on camera %d\n", arguments.streamer_id);
@@ -491,7 +506,7 @@ eviewitf_ret_t legacy_parse(int argc, char **argv) {
 
     /* Set a blending frame */
     if (arguments.blender_id >= 0) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_display_select_blender(arguments.blender_id);
         if (ret >= EVIEWITF_OK) {
             ret = eviewitf_app_set_blending_from_file(arguments.blender_id, arguments.path_blend_frame);
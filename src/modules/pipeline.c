@@ -155,7 +155,7 @@ eviewitf_ret_t pipeline_parse(int argc, char **argv) {
 
     /* Starts the pipeline */
     if (arguments.pipeline_id != -1 && arguments.start) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_pipeline_start((uint8_t)arguments.pipeline_id);
         if (ret >= 0) {
             fprintf(stdout, "Pipeline %d started\n", arguments.pipeline_id);
@@ -166,7 +166,7 @@ eviewitf_ret_t pipeline_parse(int argc, char **argv) {
     }
     /* Stop the pipeline */
     if (arguments.pipeline_id != -1 && arguments.stop) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_pipeline_stop((uint8_t)arguments.pipeline_id);
         if (ret >= 0) {
             fprintf(stdout, "Pipeline %d stopped\n", arguments.pipeline_id);
@@ -177,7 +177,7 @@ eviewitf_ret_t pipeline_parse(int argc, char **argv) {
     }
     /* Reboot the pipeline R7/A53 */
     if (arguments.pipeline_id != -1 && arguments.reboot) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_pipeline_reboot((uint8_t)arguments.pipeline_id);
         if (ret >= 0) {
             fprintf(stdout, "Pipeline %d rebooted\n", arguments.pipeline_id);
@@ -188,7 +188,7 @@ eviewitf_ret_t pipeline_parse(int argc, char **argv) {
     }
     /* Set led level */
     if (arguments.pipeline_id != -1 && arguments.led) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_pipeline_set_led((uint8_t)arguments.pipeline_id, arguments.led_id, arguments.led_level);
         if (ret >= 0) {
             fprintf(stdout, "Pipeline %d led (%d) set to %d level\n", arguments.pipeline_id, arguments.led_id,
@@ -201,7 +201,7 @@ eviewitf_ret_t pipeline_parse(int argc, char **argv) {
     }
     /* Configure the pipeline */
     if (arguments.pipeline_id != -1 && arguments.configure) {
-        eviewitf_init();
+        eviewitf_init_ex(EVIEWITF_INIT_LAZY);
         ret = eviewitf_pipeline_configure((uint8_t)arguments.pipeline_id, arguments.width, arguments.height);
         if (ret >= 0) {
             fprintf(stdout, "Pipeline %d configured\n", arguments.pipeline_id);
@@ -0,0 +1,259 @@
+/**
+ * @file stats.c
+ * @brief Module stats
+ * @author LACROIX Impulse
+ *
+ * The module Stats handles operations that relate to requests statistics
+ *
+ */
+#include "stats.h"
+
+#include <argp.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "eviewitf.h"
+#include "eviewitf-priv.h"
+#include "eviewitf/eviewitf-stats.h"
+
+/**
+ * @typedef stats_arguments_t
+ * @brief Stats module arguments
+ *
+ * @struct stats_arguments
+ * @brief Stats module arguments
+ */
+typedef struct stats_arguments {
+    int reset;     /*!< Reset the statistics */
+    int histogram; /*!< Print the latency histograms */
+} stats_arguments_t;
+
+/**
+ * @brief Device type names
+ */
+static const char *stats_devtype_names[EVIEWITF_STATS_DEVTYPE_MAX] = {"camera", "pipeline", "serializer", "video",
+                                                                      "function"};
+
+/**
+ * @brief Program documentation
+ */
+static char stats_doc[] =
+    "eviewitf -- Program for communication between A53 and R7 CPUs"
+    "\n";
+
+/**
+ *@brief Arguments description
+ */
+static char stats_args_doc[] =
+    "module:          [camera(default)|pipeline|video|stats]\n"
+    "print:           [-H]\n"
+    "reset:           -r\n";
+
+/**
+ * @brief Program options
+ */
+static argp_option_t stats_options[] = {
+    {"reset", 'r', 0, 0, "Reset the requests statistics", 0},
+    {"histogram", 'H', 0, 0, "Print the latency histograms", 0},
+    {0},
+};
+
+/**
+ * @brief Parse a single option
+ */
+static error_t stats_parse_opt(int key, char *arg, argp_state_t *state) {
+    /* Get the input argument from argp_parse */
+    stats_arguments_t *arguments = state->input;
+
+    (void)arg;
+    switch (key) {
+        case 'r':
+            arguments->reset = 1;
+            break;
+        case 'H':
+            arguments->histogram = 1;
+            break;
+        case ARGP_KEY_ARG:
+            argp_usage(state);
+            break;
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+/**
+ * @brief argp parser
+ */
+static argp_t stats_argp = {stats_options, stats_parse_opt, stats_args_doc, stats_doc, NULL, NULL, NULL};
+
+/**
+ * @fn static uint64_t stats_percentile_us(const uint64_t *histogram, uint64_t nb_samples, uint64_t percent)
+ * @brief Get the upper bound of the histogram bucket holding a percentile
+ *
+ * @param histogram: latency histogram
+ * @param nb_samples: number of samples in the histogram
+ * @param percent: percentile
+ * @return percentile upper bound in us
+ */
+static uint64_t stats_percentile_us(const uint64_t *histogram, uint64_t nb_samples, uint64_t percent) {
+    uint64_t rank = (nb_samples * percent + 99) / 100;
+    uint64_t count = 0;
+    int i;
+
+    for (i = 0; i < EVIEWITF_STATS_HISTOGRAM_BUCKETS - 1; i++) {
+        count += histogram[i];
+        if (count >= rank) break;
+    }
+    return (uint64_t)1 << i;
+}
+
+/**
+ * @fn static void stats_print_histogram(const uint64_t *histogram)
+ * @brief Print the non empty buckets of a latency histogram
+ *
+ * @param histogram: latency histogram
+ */
+static void stats_print_histogram(const uint64_t *histogram) {
+    for (int i = 0; i < EVIEWITF_STATS_HISTOGRAM_BUCKETS; i++) {
+        if (histogram[i] == 0) continue;
+        if (i == EVIEWITF_STATS_HISTOGRAM_BUCKETS - 1) {
+            fprintf(stdout, "%16s>= %7" PRIu64 " us: %" PRIu64 "\n", "", (uint64_t)1 << (i - 1), histogram[i]);
+        } else {
+            fprintf(stdout, "%16s< %8" PRIu64 " us: %" PRIu64 "\n", "", (uint64_t)1 << i, histogram[i]);
+        }
+    }
+}
+
+/**
+ * @fn static void stats_print_frames(int cam_id, eviewitf_stats_frames_t *frames)
+ * @brief Print the sequence counters of the frames read from a camera
+ *
+ * @param cam_id: id of the camera
+ * @param frames: sequence counters of the camera
+ */
+static void stats_print_frames(int cam_id, eviewitf_stats_frames_t *frames) {
+    uint64_t nb_intervals = (frames->nb_frames > 1) ? frames->nb_frames - 1 : 1;
+
+    fprintf(stdout, "%-10s %4d %10" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", "camera",
+            cam_id, frames->nb_frames, frames->nb_dropped, frames->nb_duplicated,
+            frames->jitter_ns / nb_intervals / 1000, frames->max_jitter_ns / 1000);
+}
+
+/**
+ * @fn static void stats_print_frames_header(void)
+ * @brief Print the header of the frames sequence counters
+ */
+static void stats_print_frames_header(void) {
+    fprintf(stdout, "%-10s %4s %10s %8s %8s %10s %10s\n", "type", "id", "frames", "dropped", "dupl.", "jitter(us)",
+            "max(us)");
+}
+
+/**
+ * @fn static void stats_print(int histogram)
+ * @brief Print the statistics of the commands having been requested
+ *
+ * @param histogram: also print the latency histograms if not 0
+ */
+static void stats_print(int histogram) {
+    eviewitf_stats_entry_t entry;
+    eviewitf_stats_frames_t frames;
+    int header = 0;
+
+    fprintf(stdout, "%-10s %4s %10s %8s %8s %8s %10s %10s %10s %10s\n", "type", "cmd", "requests", "blocked",
+            "invalid", "failed", "avg(us)", "p50(us)", "p99(us)", "max(us)");
+
+    for (int devtype = 0; devtype < EVIEWITF_STATS_DEVTYPE_MAX; devtype++) {
+        for (int cmd = 0; cmd < EVIEWITF_STATS_MAX_COMMANDS; cmd++) {
+            if ((eviewitf_stats_get(devtype, cmd, &entry) != EVIEWITF_OK) || (entry.nb_requests == 0)) {
+                continue;
+            }
+
+            fprintf(stdout,
+                    "%-10s %4d %10" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10" PRIu64 " %10" PRIu64
+                    " %10" PRIu64 " %10" PRIu64 "\n",
+                    stats_devtype_names[devtype], cmd, entry.nb_requests, entry.nb_blocked, entry.nb_invalid,
+                    entry.nb_failed, entry.total_ns / entry.nb_requests / 1000,
+                    stats_percentile_us(entry.histogram, entry.nb_requests, 50),
+                    stats_percentile_us(entry.histogram, entry.nb_requests, 99), entry.max_ns / 1000);
+
+            if (histogram) {
+                stats_print_histogram(entry.histogram);
+            }
+        }
+    }
+
+    /* Frames read from the cameras */
+    for (int cam_id = 0; cam_id < EVIEWITF_MAX_CAMERA; cam_id++) {
+        if ((eviewitf_stats_get_frames(cam_id, &frames) != EVIEWITF_OK) || (frames.nb_frames == 0)) {
+            continue;
+        }
+        if (!header) {
+            fprintf(stdout, "\n");
+            stats_print_frames_header();
+            header = 1;
+        }
+        stats_print_frames(cam_id, &frames);
+    }
+}
+
+void stats_print_latency(int cam_id) {
+    eviewitf_stats_latency_entry_t *entries[2];
+    const char *names[2] = {"sensor-to-user", "wake-to-data"};
+    eviewitf_stats_latency_t latency;
+    eviewitf_stats_frames_t frames;
+
+    if ((eviewitf_stats_get_latency(cam_id, &latency) != EVIEWITF_OK) ||
+        (eviewitf_stats_get_frames(cam_id, &frames) != EVIEWITF_OK)) {
+        fprintf(stdout, "Fail to get latency of camera id %d\n", cam_id);
+        return;
+    }
+    entries[0] = &latency.sensor_to_user;
+    entries[1] = &latency.wake_to_data;
+
+    fprintf(stdout, "%-16s %10s %10s %10s %10s %10s\n", "latency", "frames", "avg(us)", "p50(us)", "p99(us)",
+            "max(us)");
+    for (int i = 0; i < 2; i++) {
+        if (entries[i]->nb_frames == 0) {
+            fprintf(stdout, "%-16s %10d\n", names[i], 0);
+            continue;
+        }
+        fprintf(stdout, "%-16s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", names[i],
+                entries[i]->nb_frames, entries[i]->total_ns / entries[i]->nb_frames / 1000,
+                stats_percentile_us(entries[i]->histogram, entries[i]->nb_frames, 50),
+                stats_percentile_us(entries[i]->histogram, entries[i]->nb_frames, 99), entries[i]->max_ns / 1000);
+        stats_print_histogram(entries[i]->histogram);
+    }
+
+    fprintf(stdout, "\n");
+    stats_print_frames_header();
+    stats_print_frames(cam_id, &frames);
+}
+
+eviewitf_ret_t stats_parse(int argc, char **argv) {
+    eviewitf_ret_t ret = EVIEWITF_OK;
+    stats_arguments_t arguments;
+
+    /* Default values. */
+    arguments.reset = 0;
+    arguments.histogram = 0;
+
+    /* Parse arguments; every option seen by parse_opt will
+          be reflected in arguments. */
+    argp_parse(&stats_argp, argc, argv, 0, 0, &arguments);
+
+    if (arguments.reset) {
+        ret = eviewitf_stats_reset();
+        if (ret >= EVIEWITF_OK) {
+            fprintf(stdout, "Requests statistics reset\n");
+        } else {
+            fprintf(stdout, "Fail to reset requests statistics\n");
+        }
+    } else {
+        stats_print(arguments.histogram);
+    }
+
+    return ret;
+}
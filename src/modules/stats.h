@@ -0,0 +1,30 @@
+/**
+ * @file stats.h
+ * @brief Module stats
+ * @author LACROIX Impulse
+ *
+ * The module Stats handles operations that relate to requests statistics
+ *
+ */
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdint.h>
+
+/**
+ * @fn eviewitf_ret_t stats_parse(int argc, char **argv)
+ * @brief Parse the parameters and execute the  function
+ * @param[in] argc arguments count
+ * @param[in] argv arguments
+ * @return return code as specified by the eviewitf_ret_t enumeration.
+ */
+int stats_parse(int argc, char **argv);
+
+/**
+ * @fn void stats_print_latency(int cam_id)
+ * @brief Print the latencies and the sequence counters of the frames read from a camera
+ * @param[in] cam_id id of the camera between 0 and EVIEWITF_MAX_CAMERA
+ */
+void stats_print_latency(int cam_id);
+
+#endif /* _STATS_H */
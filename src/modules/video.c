@@ -55,7 +55,7 @@ static char video_doc[] =
  *@brief Arguments description
  */
 static char video_args_doc[] =
-    "module:          [camera(default)|pipeline|video]\n"
+    "module:          [camera(default)|pipeline|video|stats]\n"
     "suspend:         -c[0-7] -s\n"
     "resume:          -c[0-7] -r\n";
 